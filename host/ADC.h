@@ -0,0 +1,34 @@
+// Stand-in for the Teensy ADC library
+//
+// analogRead() on a mux output returns the simulated pot on the address the
+// select pins are on (HostHAL.h), scaled to the resolution set.
+
+#pragma once
+
+#include <Arduino.h>
+
+enum class ADC_CONVERSION_SPEED { VERY_LOW_SPEED, LOW_SPEED, MED_SPEED, HIGH_SPEED, VERY_HIGH_SPEED };
+enum class ADC_SAMPLING_SPEED { VERY_LOW_SPEED, LOW_SPEED, MED_SPEED, HIGH_SPEED, VERY_HIGH_SPEED };
+
+class ADC_Module {
+public:
+  void setAveraging(uint8_t) {}
+  void setResolution(uint8_t bits) {
+    _bits = bits;
+  }
+  void setConversionSpeed(ADC_CONVERSION_SPEED) {}
+  void setSamplingSpeed(ADC_SAMPLING_SPEED) {}
+  int analogRead(uint8_t pin);
+
+private:
+  uint8_t _bits = 10;
+};
+
+class ADC {
+public:
+  ADC_Module *adc0 = &_modules[0];
+  ADC_Module *adc1 = &_modules[1];
+
+private:
+  ADC_Module _modules[2];
+};
@@ -0,0 +1,2 @@
+// Nothing from ADC_util.h is used
+#pragma once
@@ -0,0 +1,351 @@
+// Stand-in for the Teensy core on a Linux host
+//
+// Time is virtual. millis()/micros() only move when the simulation advances
+// the clock (hostAdvanceUs()) or the firmware blocks in delay(), and
+// IntervalTimer callbacks fire at their due times while it moves, so a run
+// is the same every time. Pins are an array of levels with the mux, 74HC165
+// and 74HC595 models behind them (HostHAL.h). Serial prints to stdout,
+// usbMIDI is the USB device MIDI port (usb_midi.h).
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define INPUT_PULLDOWN 3
+#define INPUT_DISABLE 5
+
+#define DEC 10
+#define HEX 16
+
+#define B0001 1
+#define B0010 2
+#define B0100 4
+#define B1000 8
+
+#define A0 14
+#define A1 15
+#define A2 16
+
+#define F(s) s
+#define PROGMEM
+#define FLASHMEM
+#define DMAMEM
+#define FASTRUN
+
+#define F_CPU 600000000
+#define HOST_PINS 64
+
+//Templates rather than the usual macros, <chrono> has min() and max() members
+template<class A, class B>
+auto min(A a, B b) -> decltype(a < b ? a : b) {
+  return a < b ? a : b;
+}
+
+template<class A, class B>
+auto max(A a, B b) -> decltype(a > b ? a : b) {
+  return a > b ? a : b;
+}
+
+template<class T, class L, class H>
+T constrain(T x, L lo, H hi) {
+  return x < lo ? lo : (x > hi ? hi : x);
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+//Virtual clock
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void delayNanoseconds(uint32_t ns);
+void yield();
+
+//Nothing to mask, timer callbacks only run while the clock is advanced
+void __disable_irq();
+void __enable_irq();
+#define noInterrupts() __disable_irq()
+#define interrupts() __enable_irq()
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+#define digitalWriteFast(pin, value) digitalWrite(pin, (value) ? HIGH : LOW)
+#define digitalReadFast(pin) digitalRead(pin)
+
+// Arduino String, a malloc'd buffer like the real one. PatchMgr.h sorts
+// structs holding Strings with qsort(), which only works when a String can be
+// moved byte by byte, so no std::string inside.
+class String {
+public:
+  String(const char *s = "") {
+    set(s ? s : "", s ? strlen(s) : 0);
+  }
+  String(const String &s) {
+    set(s._buf, s._len);
+  }
+  String(char c) {
+    set(&c, 1);
+  }
+  String(int n, unsigned char base = DEC);
+  String(unsigned int n, unsigned char base = DEC);
+  String(long n, unsigned char base = DEC);
+  String(unsigned long n, unsigned char base = DEC);
+  String(float n, unsigned char decimals = 2);
+  String(double n, unsigned char decimals = 2);
+  ~String() {
+    free(_buf);
+  }
+  String &operator=(const String &s) {
+    if (this != &s) {
+      free(_buf);
+      set(s._buf, s._len);
+    }
+    return *this;
+  }
+
+  unsigned int length() const {
+    return _len;
+  }
+  const char *c_str() const {
+    return _buf;
+  }
+  char charAt(unsigned int i) const {
+    return i < _len ? _buf[i] : 0;
+  }
+  char operator[](unsigned int i) const {
+    return charAt(i);
+  }
+  bool equals(const String &s) const {
+    return _len == s._len && memcmp(_buf, s._buf, _len) == 0;
+  }
+  bool operator==(const String &s) const {
+    return equals(s);
+  }
+  bool operator!=(const String &s) const {
+    return !equals(s);
+  }
+  bool operator==(const char *s) const {
+    return strcmp(_buf, s) == 0;
+  }
+  bool operator!=(const char *s) const {
+    return strcmp(_buf, s) != 0;
+  }
+  bool concat(const String &s) {
+    _buf = (char *)realloc(_buf, _len + s._len + 1);
+    memcpy(_buf + _len, s._buf, s._len + 1);
+    _len += s._len;
+    return true;
+  }
+  String &operator+=(const String &s) {
+    concat(s);
+    return *this;
+  }
+  String substring(unsigned int from) const {
+    return substring(from, _len);
+  }
+  String substring(unsigned int from, unsigned int to) const {
+    String s;
+    if (to > _len) to = _len;
+    if (from < to) {
+      free(s._buf);
+      s.set(_buf + from, to - from);
+    }
+    return s;
+  }
+  int indexOf(char c) const {
+    const char *p = strchr(_buf, c);
+    return p ? p - _buf : -1;
+  }
+  void toCharArray(char *buf, unsigned int size) const {
+    if (size == 0) return;
+    strncpy(buf, _buf, size - 1);
+    buf[size - 1] = 0;
+  }
+  long toInt() const {
+    return atol(_buf);
+  }
+  float toFloat() const {
+    return atof(_buf);
+  }
+
+private:
+  void set(const char *s, unsigned int length) {
+    _buf = (char *)malloc(length + 1);
+    memcpy(_buf, s, length);
+    _buf[length] = 0;
+    _len = length;
+  }
+
+  char *_buf;
+  unsigned int _len;
+};
+
+inline String operator+(const String &a, const String &b) {
+  String s = a;
+  s += b;
+  return s;
+}
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t b) = 0;
+  virtual size_t write(const uint8_t *buf, size_t size);
+  virtual int availableForWrite() {
+    return 0;
+  }
+  virtual void flush() {}
+
+  size_t print(const String &s);
+  size_t print(const char *s);
+  size_t print(char c);
+  size_t print(int n, int base = DEC);
+  size_t print(unsigned int n, int base = DEC);
+  size_t print(long n, int base = DEC);
+  size_t print(unsigned long n, int base = DEC);
+  size_t print(double n, int decimals = 2);
+  template<class T>
+  size_t println(const T &v) {
+    return print(v) + println();
+  }
+  template<class T>
+  size_t println(const T &v, int format) {
+    return print(v, format) + println();
+  }
+  size_t println();
+  int printf(const char *format, ...);
+};
+
+class Stream : public Print {
+public:
+  virtual int available() {
+    return 0;
+  }
+  virtual int read() {
+    return -1;
+  }
+  virtual int peek() {
+    return -1;
+  }
+  using Print::write;
+};
+
+//USB serial, the console
+class usb_serial_class : public Stream {
+public:
+  void begin(long) {}
+  operator bool() {
+    return true;
+  }
+  size_t write(uint8_t b) override;
+  size_t write(const uint8_t *buf, size_t size) override;
+  int availableForWrite() override {
+    return 64;
+  }
+};
+
+extern usb_serial_class Serial;
+
+//Serial port of a MIDI DIN output, the transmit buffer drains at 31250 baud
+//on the virtual clock
+class HardwareSerial : public Stream {
+public:
+  HardwareSerial(const char *name)
+    : _name(name) {}
+  void begin(long baud);
+  size_t write(uint8_t b) override;
+  using Print::write;
+  int availableForWrite() override;
+  void addMemoryForWrite(void *, size_t size) {
+    _txSize += size;
+  }
+  void addMemoryForRead(void *, size_t) {}
+  const char *name() const {
+    return _name;
+  }
+
+private:
+  const char *_name;
+  size_t _txSize = 40;     //Teensy 4 Serial1 transmit buffer
+  uint32_t _txEmptyAt = 0;  //micros() the last queued byte is on the wire
+  uint32_t _byteUs = 320;
+};
+
+extern HardwareSerial Serial1, Serial6;
+
+// Periodic callback on the virtual clock. As on the Teensy, update() takes
+// effect after the interval that is running now.
+class IntervalTimer {
+public:
+  ~IntervalTimer() {
+    end();
+  }
+  bool begin(void (*callback)(), unsigned int us);
+  bool begin(void (*callback)(), int us) {
+    return begin(callback, (unsigned int)us);
+  }
+  bool begin(void (*callback)(), double us) {
+    return begin(callback, (unsigned int)us);
+  }
+  void update(unsigned int us) {
+    _nextPeriod = us;
+  }
+  void update(int us) {
+    _nextPeriod = us;
+  }
+  void end();
+  void priority(uint8_t) {}
+
+  void (*_callback)() = nullptr;
+  uint32_t _due = 0;
+  uint32_t _period = 0;
+  uint32_t _nextPeriod = 0;
+};
+
+class elapsedMillis {
+public:
+  elapsedMillis()
+    : _start(millis()) {}
+  operator unsigned long() const {
+    return millis() - _start;
+  }
+  elapsedMillis &operator=(unsigned long ms) {
+    _start = millis() - ms;
+    return *this;
+  }
+
+private:
+  unsigned long _start;
+};
+
+class elapsedMicros {
+public:
+  elapsedMicros()
+    : _start(micros()) {}
+  operator unsigned long() const {
+    return micros() - _start;
+  }
+  elapsedMicros &operator=(unsigned long us) {
+    _start = micros() - us;
+    return *this;
+  }
+
+private:
+  unsigned long _start;
+};
+
+#include "HostHAL.h"
+#include "usb_midi.h"
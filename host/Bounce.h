@@ -0,0 +1,38 @@
+// Stand-in for the Teensy Bounce library, the same lock out debounce on
+// digitalRead() and the virtual clock
+
+#pragma once
+
+#include <Arduino.h>
+
+class Bounce {
+public:
+  Bounce(uint8_t pin, unsigned long interval)
+    : _pin(pin), _interval(interval) {}
+  bool update() {
+    uint8_t state = digitalRead(_pin);
+    _changed = false;
+    if (state != _state && millis() - _lastChange >= _interval) {
+      _state = state;
+      _lastChange = millis();
+      _changed = true;
+    }
+    return _changed;
+  }
+  int read() {
+    return _state;
+  }
+  bool fallingEdge() {
+    return _changed && _state == LOW;
+  }
+  bool risingEdge() {
+    return _changed && _state == HIGH;
+  }
+
+private:
+  uint8_t _pin;
+  unsigned long _interval;
+  unsigned long _lastChange = 0;
+  uint8_t _state = HIGH;
+  bool _changed = false;
+};
@@ -0,0 +1,69 @@
+// Stand-in for the Agileware CircularBuffer, same interface on a deque
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <deque>
+#include <type_traits>
+
+//Sizes come back in the smallest index type that holds S, as the library's do
+template<class T, size_t S,
+         class IT = typename std::conditional<S <= UINT8_MAX, uint8_t,
+                                              typename std::conditional<S <= UINT16_MAX, uint16_t, uint32_t>::type>::type>
+class CircularBuffer {
+public:
+  //Full, the oldest is overwritten and false returned
+  bool push(T value) {
+    _items.push_back(value);
+    if (_items.size() <= S) return true;
+    _items.pop_front();
+    return false;
+  }
+  bool unshift(T value) {
+    _items.push_front(value);
+    if (_items.size() <= S) return true;
+    _items.pop_back();
+    return false;
+  }
+  T shift() {
+    T value = _items.front();
+    _items.pop_front();
+    return value;
+  }
+  T pop() {
+    T value = _items.back();
+    _items.pop_back();
+    return value;
+  }
+  T &first() {
+    return _items.front();
+  }
+  T &last() {
+    return _items.back();
+  }
+  T &operator[](IT i) {
+    return _items[i];
+  }
+  IT size() const {
+    return _items.size();
+  }
+  IT available() const {
+    return S - _items.size();
+  }
+  IT capacity() const {
+    return S;
+  }
+  bool isEmpty() const {
+    return _items.empty();
+  }
+  bool isFull() const {
+    return _items.size() == S;
+  }
+  void clear() {
+    _items.clear();
+  }
+
+private:
+  std::deque<T> _items;
+};
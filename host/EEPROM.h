@@ -0,0 +1,36 @@
+// Stand-in for the Teensy EEPROM library, backed by a file
+//
+// The file is read on first use and rewritten on every change, a byte that
+// was never written reads 0xFF as on an erased part.
+
+#pragma once
+
+#include <Arduino.h>
+
+#define HOST_EEPROM_SIZE 4284  //Teensy 4.1
+
+class EEPROMClass {
+public:
+  uint8_t read(int address);
+  void write(int address, uint8_t value);
+  void update(int address, uint8_t value) {
+    if (read(address) != value) write(address, value);
+  }
+  uint16_t length() {
+    return HOST_EEPROM_SIZE;
+  }
+  template<class T>
+  T &get(int address, T &t) {
+    uint8_t *p = (uint8_t *)&t;
+    for (size_t i = 0; i < sizeof(T); i++) p[i] = read(address + i);
+    return t;
+  }
+  template<class T>
+  const T &put(int address, const T &t) {
+    const uint8_t *p = (const uint8_t *)&t;
+    for (size_t i = 0; i < sizeof(T); i++) update(address + i, p[i]);
+    return t;
+  }
+};
+
+extern EEPROMClass EEPROM;
@@ -0,0 +1,19 @@
+// Stand-in for the Encoder library, the count is set by the simulation
+
+#pragma once
+
+#include <Arduino.h>
+
+class Encoder {
+public:
+  Encoder(uint8_t, uint8_t) {}
+  long read() {
+    return _count;
+  }
+  void write(long count) {
+    _count = count;
+  }
+
+private:
+  long _count = 0;
+};
@@ -0,0 +1,535 @@
+// Host HAL, the virtual clock and the models behind the stand-in libraries
+
+#include <Arduino.h>
+#include <ADC.h>
+#include <EEPROM.h>
+#include <SD.h>
+#include <TeensyThreads.h>
+#include <stdarg.h>
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+usb_serial_class Serial;
+HardwareSerial Serial1("Serial1");
+HardwareSerial Serial6("Serial6");
+EEPROMClass EEPROM;
+SDClass SD;
+Threads threads;
+usb_midi_class usbMIDI;
+
+// Virtual clock and timers
+
+static uint32_t hostNow = 0;  //uS
+static bool hostInTimer = false;
+//Never freed, timers in the firmware's globals end after this file's are gone
+static std::vector<IntervalTimer *> &hostTimers = *new std::vector<IntervalTimer *>;
+
+uint32_t micros() {
+  return hostNow;
+}
+
+uint32_t millis() {
+  return hostNow / 1000;
+}
+
+//Time moves on but nothing fires while a timer callback is running, as an
+//interrupt is not interrupted by one of the same priority
+void hostAdvanceUs(uint32_t us) {
+  uint32_t target = hostNow + us;
+  while (!hostInTimer) {
+    IntervalTimer *next = nullptr;
+    for (IntervalTimer *t : hostTimers) {
+      if ((int32_t)(t->_due - target) > 0) continue;
+      if (!next || (int32_t)(t->_due - next->_due) < 0) next = t;
+    }
+    if (!next) break;
+    hostNow = next->_due;
+    next->_period = next->_nextPeriod;
+    next->_due += next->_period;
+    hostInTimer = true;
+    next->_callback();
+    hostInTimer = false;
+  }
+  if ((int32_t)(target - hostNow) > 0) hostNow = target;
+}
+
+void delay(uint32_t ms) {
+  hostAdvanceUs(ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+  hostAdvanceUs(us);
+}
+
+void delayNanoseconds(uint32_t) {}
+
+void yield() {}
+
+void __disable_irq() {}
+
+void __enable_irq() {}
+
+bool IntervalTimer::begin(void (*callback)(), unsigned int us) {
+  end();
+  _callback = callback;
+  _period = _nextPeriod = us;
+  _due = hostNow + us;
+  hostTimers.push_back(this);
+  return true;
+}
+
+void IntervalTimer::end() {
+  hostTimers.erase(std::remove(hostTimers.begin(), hostTimers.end(), this), hostTimers.end());
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// Pins and the models behind them
+
+static uint8_t hostPinLevel[HOST_PINS];
+
+static bool hostMuxSetup = false;
+static HostMuxPins hostMux;
+static uint16_t hostPots[HOST_MUXES][HOST_MUX_CHANNELS];
+static uint32_t hostAnalogReadCount = 0;
+static uint32_t hostAddressReads[HOST_MUX_CHANNELS];
+static uint32_t hostAddressReadTime[HOST_MUX_CHANNELS];
+
+static bool hostPanelSetup = false;
+static HostPanelPins hostPanel;
+static bool hostButtons[HOST_PANEL_BITS];
+static bool hostButtonsLoaded[HOST_PANEL_BITS];
+static uint8_t hostButtonBit = 0;
+static bool hostLedShift[HOST_PANEL_BITS];
+static bool hostLedLatch[HOST_PANEL_BITS];
+static uint64_t hostLedOnUs[HOST_PANEL_BITS];
+static uint32_t hostLedLatchTime = 0;
+static uint32_t hostLedDutyStart = 0;
+static uint32_t hostLatchCount = 0;
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin >= HOST_PINS) return;
+  if (mode == INPUT_PULLUP) hostPinLevel[pin] = HIGH;
+}
+
+static void hostLedAccount() {
+  uint32_t elapsed = hostNow - hostLedLatchTime;
+  for (int i = 0; i < HOST_PANEL_BITS; i++) {
+    if (hostLedLatch[i]) hostLedOnUs[i] += elapsed;
+  }
+  hostLedLatchTime = hostNow;
+}
+
+//The 595 chain shifts on a rising clock and copies to the outputs on a
+//rising latch. After the 80 bits the first one sent is LED 79.
+static void hostPanelEdge(uint8_t pin, uint8_t from, uint8_t to) {
+  if (pin == hostPanel.ledClk && !from && to) {
+    memmove(hostLedShift + 1, hostLedShift, HOST_PANEL_BITS - 1);
+    hostLedShift[0] = hostPinLevel[hostPanel.ledData];
+  } else if (pin == hostPanel.ledLatch && !from && to) {
+    hostLedAccount();
+    memcpy(hostLedLatch, hostLedShift, sizeof(hostLedLatch));
+    hostLatchCount++;
+  } else if (pin == hostPanel.btnLoad && from && !to) {
+    memcpy(hostButtonsLoaded, hostButtons, sizeof(hostButtonsLoaded));
+    hostButtonBit = 0;
+  } else if (pin == hostPanel.btnClk && !from && to) {
+    hostButtonBit++;
+  }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if (pin >= HOST_PINS) return;
+  uint8_t from = hostPinLevel[pin];
+  hostPinLevel[pin] = value ? HIGH : LOW;
+  if (hostPanelSetup) hostPanelEdge(pin, from, hostPinLevel[pin]);
+}
+
+//The 165 chain is wired so button n ends up as bit n of the frame PanelIO
+//reads, bit 7 of each byte comes out first. Buttons pull their input low.
+int digitalRead(uint8_t pin) {
+  if (pin >= HOST_PINS) return LOW;
+  if (hostPanelSetup && pin == hostPanel.btnData) {
+    if (hostButtonBit >= HOST_PANEL_BITS) return HIGH;
+    uint8_t button = (hostButtonBit & ~7) + 7 - (hostButtonBit & 7);
+    return hostButtonsLoaded[button] ? LOW : HIGH;
+  }
+  return hostPinLevel[pin];
+}
+
+void hostSetupMux(const HostMuxPins &pins) {
+  hostMux = pins;
+  hostMuxSetup = true;
+}
+
+void hostSetPot(uint8_t mux, uint8_t channel, uint16_t value) {
+  hostPots[mux][channel] = value > 1023 ? 1023 : value;
+}
+
+uint32_t hostAnalogReads() {
+  return hostAnalogReadCount;
+}
+
+uint32_t hostMuxReads(uint8_t address) {
+  return address < HOST_MUX_CHANNELS ? hostAddressReads[address] : 0;
+}
+
+uint32_t hostMuxReadTime(uint8_t address) {
+  return address < HOST_MUX_CHANNELS ? hostAddressReadTime[address] : 0;
+}
+
+int ADC_Module::analogRead(uint8_t pin) {
+  hostAnalogReadCount++;
+  if (!hostMuxSetup) return 0;
+  for (int m = 0; m < HOST_MUXES; m++) {
+    if (hostMux.analog[m] != pin) continue;
+    uint8_t address = 0;
+    for (int b = 0; b < 4; b++) address |= hostPinLevel[hostMux.select[b]] << b;
+    if (m == 0) {
+      hostAddressReads[address]++;
+      hostAddressReadTime[address] = micros();
+    }
+    uint16_t value = hostPots[m][address];
+    return _bits >= 10 ? value << (_bits - 10) : value >> (10 - _bits);
+  }
+  return 0;
+}
+
+void hostSetupPanel(const HostPanelPins &pins) {
+  hostPanel = pins;
+  hostPanelSetup = true;
+  hostLedResetDuty();
+}
+
+void hostSetButton(uint8_t button, bool down) {
+  if (button < HOST_PANEL_BITS) hostButtons[button] = down;
+}
+
+bool hostLedLatched(uint8_t led) {
+  return led < HOST_PANEL_BITS && hostLedLatch[led];
+}
+
+void hostLedResetDuty() {
+  memset(hostLedOnUs, 0, sizeof(hostLedOnUs));
+  hostLedLatchTime = hostLedDutyStart = hostNow;
+}
+
+float hostLedDuty(uint8_t led) {
+  hostLedAccount();
+  uint32_t elapsed = hostNow - hostLedDutyStart;
+  return elapsed ? (float)hostLedOnUs[led] / elapsed : 0;
+}
+
+uint32_t hostPanelLatches() {
+  return hostLatchCount;
+}
+
+// Serial, String
+
+size_t Print::write(const uint8_t *buf, size_t size) {
+  size_t n = 0;
+  while (size--) n += write(*buf++);
+  return n;
+}
+
+size_t Print::print(const String &s) {
+  return write((const uint8_t *)s.c_str(), s.length());
+}
+
+size_t Print::print(const char *s) {
+  return write((const uint8_t *)s, strlen(s));
+}
+
+size_t Print::print(char c) {
+  return write((uint8_t)c);
+}
+
+size_t Print::print(int n, int base) {
+  return print(String(n, base));
+}
+
+size_t Print::print(unsigned int n, int base) {
+  return print(String(n, base));
+}
+
+size_t Print::print(long n, int base) {
+  return print(String(n, base));
+}
+
+size_t Print::print(unsigned long n, int base) {
+  return print(String(n, base));
+}
+
+size_t Print::print(double n, int decimals) {
+  return print(String(n, decimals));
+}
+
+size_t Print::println() {
+  return write('\n');
+}
+
+int Print::printf(const char *format, ...) {
+  char buf[512];
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  write((const uint8_t *)buf, strlen(buf));
+  return n;
+}
+
+size_t usb_serial_class::write(uint8_t b) {
+  return fwrite(&b, 1, 1, stdout);
+}
+
+size_t usb_serial_class::write(const uint8_t *buf, size_t size) {
+  return fwrite(buf, 1, size, stdout);
+}
+
+static String hostFormat(unsigned long n, bool negative, unsigned char base) {
+  char buf[72];
+  char *p = buf + sizeof(buf) - 1;
+  *p = 0;
+  if (base < 2) base = DEC;
+  do {
+    uint8_t d = n % base;
+    *--p = d < 10 ? '0' + d : 'A' + d - 10;
+    n /= base;
+  } while (n);
+  if (negative) *--p = '-';
+  return String(p);
+}
+
+String::String(int n, unsigned char base)
+  : String(base == DEC ? hostFormat(n < 0 ? -(long)n : n, n < 0, base) : hostFormat((unsigned int)n, false, base)) {}
+
+String::String(unsigned int n, unsigned char base)
+  : String(hostFormat(n, false, base)) {}
+
+String::String(long n, unsigned char base)
+  : String(base == DEC ? hostFormat(n < 0 ? -n : n, n < 0, base) : hostFormat((unsigned long)n, false, base)) {}
+
+String::String(unsigned long n, unsigned char base)
+  : String(hostFormat(n, false, base)) {}
+
+String::String(float n, unsigned char decimals)
+  : String((double)n, decimals) {}
+
+String::String(double n, unsigned char decimals) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", decimals, n);
+  set(buf, strlen(buf));
+}
+
+// DIN serial ports, bytes queued are on the wire one per 10 bit times
+
+void HardwareSerial::begin(long baud) {
+  _byteUs = 10000000 / baud;
+}
+
+int HardwareSerial::availableForWrite() {
+  if ((int32_t)(_txEmptyAt - hostNow) <= 0) return _txSize;
+  int backlog = (_txEmptyAt - hostNow + _byteUs - 1) / _byteUs;
+  return backlog >= (int)_txSize ? 0 : _txSize - backlog;
+}
+
+//A full buffer blocks until a byte has gone, as on the Teensy
+size_t HardwareSerial::write(uint8_t) {
+  while (availableForWrite() == 0) hostAdvanceUs(_byteUs);
+  if ((int32_t)(_txEmptyAt - hostNow) < 0) _txEmptyAt = hostNow;
+  _txEmptyAt += _byteUs;
+  return 1;
+}
+
+// MIDI log
+
+static FILE *hostMidiLogFile = nullptr;
+static HostMidiWatch hostMidiWatch = nullptr;
+static std::map<std::string, uint32_t> hostMidiCounts;
+
+void hostSetMidiLog(FILE *log) {
+  hostMidiLogFile = log;
+}
+
+void hostSetMidiWatch(HostMidiWatch watch) {
+  hostMidiWatch = watch;
+}
+
+void hostMidiLog(const char *port, const uint8_t *bytes, unsigned length) {
+  hostMidiCounts[port]++;
+  if (hostMidiWatch) hostMidiWatch(port, bytes, length);
+  if (!hostMidiLogFile) return;
+  fprintf(hostMidiLogFile, "%10u %s", hostNow, port);
+  for (unsigned i = 0; i < length; i++) fprintf(hostMidiLogFile, " %02X", bytes[i]);
+  fputc('\n', hostMidiLogFile);
+}
+
+uint32_t hostMidiMessages(const char *port) {
+  auto i = hostMidiCounts.find(port);
+  return i == hostMidiCounts.end() ? 0 : i->second;
+}
+
+// EEPROM file
+
+static std::string hostEepromPath = "eeprom.bin";
+static std::vector<uint8_t> hostEeprom;
+
+void hostSetEepromFile(const char *path) {
+  hostEepromPath = path;
+  hostEeprom.clear();
+}
+
+static void hostEepromLoad() {
+  if (!hostEeprom.empty()) return;
+  hostEeprom.assign(HOST_EEPROM_SIZE, 0xFF);
+  FILE *f = fopen(hostEepromPath.c_str(), "rb");
+  if (!f) return;
+  size_t n = fread(hostEeprom.data(), 1, HOST_EEPROM_SIZE, f);
+  (void)n;
+  fclose(f);
+}
+
+uint8_t EEPROMClass::read(int address) {
+  hostEepromLoad();
+  return address >= 0 && address < HOST_EEPROM_SIZE ? hostEeprom[address] : 0;
+}
+
+void EEPROMClass::write(int address, uint8_t value) {
+  hostEepromLoad();
+  if (address < 0 || address >= HOST_EEPROM_SIZE) return;
+  hostEeprom[address] = value;
+  FILE *f = fopen(hostEepromPath.c_str(), "wb");
+  if (!f) return;
+  fwrite(hostEeprom.data(), 1, HOST_EEPROM_SIZE, f);
+  fclose(f);
+}
+
+// SD card directory
+
+static std::string hostSdRoot = "sd";
+
+void hostSetSdRoot(const char *path) {
+  hostSdRoot = path;
+}
+
+struct HostFile {
+  std::string path;
+  std::string name;
+  FILE *fp = nullptr;
+  bool directory = false;
+  std::vector<std::string> entries;  //Sorted, for a directory
+  size_t next = 0;
+
+  ~HostFile() {
+    if (fp) fclose(fp);
+  }
+};
+
+static std::string hostSdPath(const char *path) {
+  while (*path == '/') path++;
+  return *path ? hostSdRoot + "/" + path : hostSdRoot;
+}
+
+bool SDClass::begin(uint8_t) {
+  std::error_code e;
+  fs::create_directories(hostSdRoot, e);
+  return fs::is_directory(hostSdRoot, e);
+}
+
+static File hostOpen(const std::string &path, uint8_t mode) {
+  std::error_code e;
+  auto f = std::make_shared<HostFile>();
+  f->path = path;
+  f->name = fs::path(path).filename().string();
+  if (fs::is_directory(path, e)) {
+    f->directory = true;
+    for (const auto &entry : fs::directory_iterator(path, e)) f->entries.push_back(entry.path().string());
+    std::sort(f->entries.begin(), f->entries.end());
+    return File(f);
+  }
+  //FILE_WRITE appends, as on the Teensy
+  f->fp = fopen(path.c_str(), mode == FILE_WRITE ? "ab+" : "rb");
+  if (!f->fp) return File();
+  return File(f);
+}
+
+File SDClass::open(const char *path, uint8_t mode) {
+  return hostOpen(hostSdPath(path), mode);
+}
+
+bool SDClass::exists(const char *path) {
+  std::error_code e;
+  return fs::exists(hostSdPath(path), e);
+}
+
+bool SDClass::remove(const char *path) {
+  std::error_code e;
+  return fs::remove(hostSdPath(path), e);
+}
+
+const char *File::name() {
+  return _f ? _f->name.c_str() : "";
+}
+
+bool File::isDirectory() {
+  return _f && _f->directory;
+}
+
+File File::openNextFile() {
+  if (!_f || !_f->directory || _f->next >= _f->entries.size()) return File();
+  return hostOpen(_f->entries[_f->next++], FILE_READ);
+}
+
+size_t File::size() {
+  if (!_f || !_f->fp) return 0;
+  std::error_code e;
+  fflush(_f->fp);
+  return fs::file_size(_f->path, e);
+}
+
+uint32_t File::position() {
+  return _f && _f->fp ? ftell(_f->fp) : 0;
+}
+
+bool File::seek(uint32_t pos) {
+  return _f && _f->fp && fseek(_f->fp, pos, SEEK_SET) == 0;
+}
+
+int File::available() {
+  if (!_f || !_f->fp) return 0;
+  return size() - position();
+}
+
+int File::read() {
+  return _f && _f->fp ? fgetc(_f->fp) : -1;
+}
+
+int File::peek() {
+  if (!_f || !_f->fp) return -1;
+  int c = fgetc(_f->fp);
+  if (c != EOF) ungetc(c, _f->fp);
+  return c;
+}
+
+int File::read(void *buf, size_t size) {
+  return _f && _f->fp ? fread(buf, 1, size, _f->fp) : -1;
+}
+
+size_t File::write(uint8_t b) {
+  return write(&b, 1);
+}
+
+size_t File::write(const uint8_t *buf, size_t size) {
+  return _f && _f->fp ? fwrite(buf, 1, size, _f->fp) : 0;
+}
+
+void File::close() {
+  _f.reset();
+}
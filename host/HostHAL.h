@@ -0,0 +1,53 @@
+// Simulation side of the host HAL
+//
+// What a scenario uses to drive the stand-in hardware and read it back:
+// the virtual clock, the pots behind the three 4067 muxes, the buttons on
+// the 74HC165 chain, the LEDs latched by the 74HC595 chain and the files the
+// SD card and EEPROM live in. MIDI output is logged one message per line,
+// "<micros> <port> <bytes in hex>", port one of Serial1 (DIN), Serial6 (HID
+// keys), usb (the USB device) or host (the USB host port).
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define HOST_MUXES 3
+#define HOST_MUX_CHANNELS 16
+#define HOST_PANEL_BITS 80
+
+struct HostPanelPins {
+  uint8_t ledData, ledClk, ledLatch;
+  uint8_t btnData, btnClk, btnLoad;
+};
+
+struct HostMuxPins {
+  uint8_t select[4];           //Address bits, low first
+  uint8_t analog[HOST_MUXES];  //The ADC pin each mux output is on
+};
+
+//Runs the timer callbacks that fall due on the way
+void hostAdvanceUs(uint32_t us);
+
+void hostSetupMux(const HostMuxPins &pins);
+void hostSetPot(uint8_t mux, uint8_t channel, uint16_t value);  //0-1023, scaled to the ADC resolution
+uint32_t hostAnalogReads();
+uint32_t hostMuxReads(uint8_t address);     //Times the address was read on the first mux
+uint32_t hostMuxReadTime(uint8_t address);  //micros() of its last read
+
+void hostSetupPanel(const HostPanelPins &pins);
+void hostSetButton(uint8_t button, bool down);
+bool hostLedLatched(uint8_t led);
+void hostLedResetDuty();
+float hostLedDuty(uint8_t led);  //Time latched on since hostLedResetDuty(), 0-1
+uint32_t hostPanelLatches();
+
+void hostSetSdRoot(const char *path);
+void hostSetEepromFile(const char *path);
+
+typedef void (*HostMidiWatch)(const char *port, const uint8_t *bytes, unsigned length);
+
+void hostSetMidiLog(FILE *log);  //nullptr logs nothing
+void hostSetMidiWatch(HostMidiWatch watch);  //Called for every message sent, nullptr for none
+void hostMidiLog(const char *port, const uint8_t *bytes, unsigned length);
+uint32_t hostMidiMessages(const char *port);
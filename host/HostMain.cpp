@@ -0,0 +1,1251 @@
+// Host simulation of the firmware modules that do not need the display
+//
+// Builds the firmware headers from src/ that the .ino includes, in the same
+// order, against the stand-in HAL in this directory: patch manager, EEPROM
+// settings and the settings service, mux scan, pot reads (checkMux()), pot
+// thinning, panel driver, buttons and LEDs, scheduler, profiler, MIDI input
+// queue and passthrough, routing, traffic counters, batched USB output, DIN
+// thinning and the CC out path (midiCCOut()). It then drives them through
+// scripted scenarios on the virtual clock:
+//
+//   settings  EEPROM stores read back, the settings service stepping options
+//   patches   patches written to, listed from, deleted from and renumbered
+//             on the SD directory
+//   sweep     a filter cutoff sweep through the mux scan and pot thinning,
+//             with and without thinning, CCs out and settle latency
+//   session   a scripted playing session with the plain round robin and the
+//             activity weighted scan, reads/s and read interval histograms
+//             per mux address, motion to DIN CC latency histograms per pot
+//   load      CCs from USB and notes from DIN to DIN out under a display
+//             redraw, a pot sweep and a CC flood, percentiles and the
+//             scheduler's deadline misses
+//   latency   the firmware's pot to MIDI out benchmark (LatencyBench.h) on
+//             the virtual clock, idle, pot sweep, CC flood and patch recall
+//   dispatch  host time of the button change detection and table dispatch
+//             against the number of buttons changed, handlers muted
+//   glyphs    the TFT's glyph span cache against Adafruit_GFX's bit walk of
+//             the same text, pixels compared, host time per page and the
+//             heap the font takes, the cost of a patch list scroll
+//   panelio   the PanelIO driver alone on the timer: LED and button bit
+//             mapping, latches per frame, BAM duty per level, inactive glow,
+//             blink, writes held back until update()
+//   panel     LED brightness and blink duty measured on the 74HC595 model,
+//             two updates in one frame, a button press on the 74HC165 model
+//   echo      CCs looped back from DIN out to DIN in at different delays
+//             against each echo window
+//   loopback  a VST echoing the CCs it gets on USB back to USB in during a
+//             pot sweep, CCs out with each echo window against the filter off
+//   traffic   traffic query replies one port per pass, a note on DIN while
+//             they go out there, CC counts over USB only, replies to the
+//             USB host counted
+//
+// MemoryMode.ino itself is not built, its display, LCD, USB host and HID code
+// needs the Teensy. Of its handlers only the MIDI out is left below: the
+// parameter update functions myControlChange() runs end in midiCCOut(), here
+// it calls midiCCOut() straight away, and recallPatch() sends a CC per
+// parameter.
+//
+// memorymode_host [--sd DIR] [--eeprom FILE] [--midi-log FILE|-] [scenario...]
+//
+// Exits non zero when a check fails. The LOOP_PROFILE report at the end is
+// host CPU time, the virtual clock does not move while code runs.
+
+#include <SD.h>
+#include <chrono>
+#include <algorithm>
+#include <vector>
+#include <deque>
+#include <MIDI.h>
+#include <USBHost_t36.h>
+#include "MidiCC.h"
+#include "Profiler.h"
+#include "Constants.h"
+#include "Parameters.h"
+#include "PatchMgr.h"
+#include "HWControls.h"
+#include "MuxScan.h"
+#include "LatencyBench.h"
+#include "PotThinning.h"
+#include "MuxPots.h"
+#include "PanelIO.h"
+#include "PanelButtons.h"
+#include "PanelLEDs.h"
+#include "EepromMgr.h"
+#include "Scheduler.h"
+
+USBHost myusb;
+MIDIDevice midi1(myusb);
+
+MIDI_CREATE_INSTANCE(HardwareSerial, Serial1, MIDI);
+MIDI_CREATE_INSTANCE(HardwareSerial, Serial6, MIDI6);
+
+#include "MidiRouting.h"
+#include "MidiTraffic.h"
+#include "UsbMidiOut.h"
+#include "DinThinning.h"
+#include "MidiQueue.h"
+#include "MidiCCOut.h"
+#include "Settings.h"
+#include <gfxfont.h>
+#include "Yeysk16pt7b.h"
+#include "GlyphSpans.h"
+
+#define PIN_DATA 34
+#define PIN_LOAD 35
+#define PIN_CLK 33
+#define LED_DATA 21
+#define LED_LATCH 23
+#define LED_CLK 22
+#define BTN_DEBOUNCE 50
+
+#define HOST_PASS_US 20  //Virtual time of a loop() pass that runs no task
+
+PanelIO sr;
+
+static int hostFailures = 0;
+static uint32_t hostDinCCs = 0;  //CCs on the DIN output
+static uint8_t hostLastCC[128];
+static uint32_t hostLastCCTime[128];
+static uint32_t hostDinSysEx = 0;  //SysEx on the DIN and USB device outputs
+static uint32_t hostUsbSysEx = 0;
+static uint32_t hostDinNoteTime = 0;  //micros() of the last note on sent to DIN
+static void (*hostDinWatch)(const uint8_t *bytes) = nullptr;  //Every message on the DIN output
+static void (*hostUsbWatch)(const uint8_t *bytes) = nullptr;  //And on the USB device output
+
+static void hostCheck(const char *what, bool ok) {
+  Serial.printf("  %-4s %s\n", ok ? "ok" : "FAIL", what);
+  if (!ok) hostFailures++;
+}
+
+// The .ino's handlers, down to their MIDI out
+
+static bool hostCCsMuted = false;  //For the dispatch benchmark, only counted
+static uint32_t hostCCCalls = 0;
+
+void myControlChange(byte channel, byte control, int value) {
+  hostCCCalls++;
+  if (hostCCsMuted) return;
+  midiCCOut(control, value);
+}
+
+void myConvertControlChange(byte channel, byte number, byte value) {
+  myControlChange(channel, number, value);
+}
+
+//The note itself has been forwarded by the passthrough
+void myNoteOn(byte channel, byte note, byte velocity) {}
+
+void myProgramChange(byte channel, byte program) {}
+
+#define HOST_RECALL_CCS 110  //One per update function setCurrentPatchData() runs
+
+//recallPatch() without the SD read and the display, its program change, wait and CCs out
+void recallPatch(int patchNo) {
+  {
+    MidiOutGuard guard;
+    MIDI.sendProgramChange(0, midiOutCh);
+    midiTrafficMessage(TRAFFIC_DIN_OUT, 0xC0, 0, 0);
+  }
+  delay(100);
+  recallPatchFlag = true;
+  for (int i = 0; i < HOST_RECALL_CCS; i++) midiCCOut(i, 64);
+  recallPatchFlag = false;
+}
+
+// loop()
+
+//CCs, notes and SysEx as they leave the DIN port, SysEx on USB
+static void hostWatchMidi(const char *port, const uint8_t *bytes, unsigned length) {
+  if (strcmp(port, usbMIDI.name()) == 0 && bytes[0] == 0xF0) hostUsbSysEx++;
+  if (strcmp(port, usbMIDI.name()) == 0 && hostUsbWatch) hostUsbWatch(bytes);
+  if (strcmp(port, Serial1.name()) != 0) return;
+  if (hostDinWatch) hostDinWatch(bytes);
+  if (bytes[0] == 0xF0) hostDinSysEx++;
+  if ((bytes[0] & 0xF0) == 0x90) hostDinNoteTime = micros();
+  if ((bytes[0] & 0xF0) != 0xB0) return;
+  hostDinCCs++;
+  hostLastCC[bytes[1]] = bytes[2];
+  hostLastCCTime[bytes[1]] = micros();
+}
+
+//The panel buttons of controlsTask(), the encoder and menu buttons are not simulated
+static void hostControlsTask() {
+  processButtonFrame(sr.buttonFrame());
+}
+
+//refreshPanelLEDs()
+static void hostLedsTask() {
+  PROFILE_SCOPE(PROF_LEDS);
+  buildLEDFrame(sr);
+  sr.update();
+}
+
+//displayTask(), a redraw that keeps loop() busy for this long, 0 for none
+static uint32_t hostDisplayBusyUs = 0;
+
+static void hostDisplayTask() {
+  if (hostDisplayBusyUs) delayMicroseconds(hostDisplayBusyUs);
+}
+
+//loop() passes on the virtual clock for this long
+static void hostRun(uint32_t us) {
+  uint32_t start = micros();
+  while (micros() - start < us) {
+    uint32_t before = micros();
+    schedulerRun();
+    usbMidiFlush();
+    if (micros() == before) hostAdvanceUs(HOST_PASS_US);
+  }
+}
+
+//setup() without the display, USB host and HID
+static void hostSetupFirmware() {
+  sr.begin(LED_DATA, LED_LATCH, LED_CLK, -1);
+  sr.beginButtons(PIN_DATA, PIN_LOAD, PIN_CLK);
+  sr.setInactiveLevel(LED_INACTIVE_LEVEL);
+  hostSetupPanel({ LED_DATA, LED_CLK, LED_LATCH, PIN_DATA, PIN_CLK, PIN_LOAD });
+  setupButtons(BTN_DEBOUNCE);
+  setupHardware();
+  setupPotThinning();
+  hostSetupMux({ { MUX_0, MUX_1, MUX_2, MUX_3 }, { MUX1_S, MUX2_S, MUX3_S } });
+  for (int m = 0; m < 3; m++) {
+    for (int c = 0; c < MUXCHANNELS; c++) hostSetPot(m, c, 512);
+  }
+
+  midiChannel = getMIDIChannel();
+  setupMidiRouting();
+  midiRoutes = 0xFFFF;  //Everything to DIN and USB, whatever the EEPROM holds
+  myusb.begin();
+  MIDI.begin();
+  MIDI.turnThruOff();
+  MIDI6.begin();
+  setupMidiInputs();
+  setupMidiPoll();
+  midiOutCh = 1;
+  hostSetMidiWatch(hostWatchMidi);
+
+  schedulerAdd("midi in", midiQueueProcess, SCHED_EVERY_PASS, 0, MIDI_IN_DEADLINE_US);
+  schedulerAdd("pots", potsTask, POTS_PERIOD_US, 1);
+  schedulerAdd("controls", hostControlsTask, CONTROLS_PERIOD_US, 2);
+  schedulerAdd("leds", hostLedsTask, LEDS_PERIOD_US, 3);
+  schedulerAdd("display", hostDisplayTask, DISPLAY_PERIOD_US, 4);
+  schedulerAdd("traffic", midiTrafficTick, TRAFFIC_TICK_US, 7);
+  hostRun(100000);  //Pots read at rest
+}
+
+// settings
+
+static void scenarioSettings(const char *eepromFile) {
+  Serial.println("settings");
+  storeMidiChannel(5);
+  storeMidiOutCh(2);
+  storeEchoWindow(3);
+  uint16_t routes = 0x0F5A;
+  storeMidiRoutes(routes);
+  hostSetEepromFile(eepromFile);  //Read back from the file
+  hostCheck("MIDI channel read back", getMIDIChannel() == 5);
+  hostCheck("MIDI out channel read back", getMIDIOutCh() == 2);
+  hostCheck("echo window read back", getEchoWindow() == 3);
+  hostCheck("routing matrix read back", getMidiRoutes(0) == routes);
+
+  //The settings menu of the firmware, each option reads its value from the EEPROM
+  settings::reset();
+  setUpSettings();
+  hostCheck("first option selected", strcmp(settings::current_setting(), "MIDI Ch.") == 0);
+  hostCheck("current value from the EEPROM", strcmp(settings::current_setting_value(), "5") == 0);
+  settings::increment_setting();
+  hostCheck("next option", strcmp(settings::current_setting(), "MIDI Out Ch.") == 0 && strcmp(settings::current_setting_value(), "2") == 0);
+  while (strcmp(settings::current_setting(), "Echo Filter") != 0) settings::increment_setting();
+  settings::decrement_setting_value();
+  settings::save_current_value();
+  hostCheck("echo window saved", getEchoWindow() == 2 && routeEchoWindow == 2);
+  settings::decrement_setting();
+  settings::decrement_setting();  //Host In Notes, DIN+USB from 0x0F5A
+  hostCheck("route from the matrix", strcmp(settings::current_setting(), "Host In Notes") == 0
+                                       && strcmp(settings::current_setting_value(), "DIN+USB") == 0);
+  settings::decrement_setting_value();
+  settings::save_current_value();
+  hostCheck("route saved", midiRoute(MIDI_PORT_USB_HOST, ROUTE_NOTES) == ROUTE_TO_USB && getMidiRoutes(0) == midiRoutes);
+  for (int i = 0; i < 4; i++) settings::increment_setting();
+  hostCheck("options wrap", strcmp(settings::current_setting(), "MIDI Ch.") == 0);
+  settings::reset();
+
+  storeMidiChannel(MIDI_CHANNEL_OMNI);
+  storeMidiOutCh(1);
+  storeEchoWindow(2);
+  storeMidiRoutes(0xFFFF);
+  midiChannel = MIDI_CHANNEL_OMNI;
+  midiRoutes = 0xFFFF;
+  routeEchoWindow = 2;
+}
+
+// patches
+
+#define HOST_PATCHES 20
+
+static void scenarioPatches() {
+  Serial.println("patches");
+  hostCheck("SD directory", SD.begin(BUILTIN_SDCARD));
+  for (int i = 1; i <= HOST_PATCHES + 1; i++) deletePatch(String(i).c_str());
+  for (int i = 1; i <= HOST_PATCHES; i++) {
+    String data = "Patch " + String(i) + INITPATCH.substring(INITPATCH.indexOf(','));
+    savePatch(String(i).c_str(), data);
+  }
+  loadPatches();
+  hostCheck("patches listed", patches.size() >= HOST_PATCHES);
+  hostCheck("sorted by number", patches[0].patchNo == 1 && patches[HOST_PATCHES - 1].patchNo == HOST_PATCHES);
+  hostCheck("names read back", patches[4].patchName == "Patch 5");
+
+  String data[NO_OF_PARAMS];
+  File file = SD.open("7");
+  recallPatchData(file, data);
+  file.close();
+  hostCheck("patch recalled", data[0] == "Patch 7" && data[1] == "1");
+
+  deletePatch("3");
+  loadPatches();
+  renumberPatchesOnSD();
+  loadPatches();
+  hostCheck("renumbered after a delete", patches[2].patchName == "Patch 4" && !SD.exists(String(HOST_PATCHES).c_str()));
+}
+
+// sweep
+
+#define SWEEP_MUX 1
+#define SWEEP_CHANNEL MUX2_CUTOFF
+#define SWEEP_MS 250
+#define SWEEP_HOLD_MS 200
+#define SWEEP_STEP_US 100
+//A held final value goes out from the first pots run after it settles, millis() rounds down
+#define SWEEP_FLUSH_MIN_US ((POT_SETTLE_MS - 1) * 1000)
+#define SWEEP_FLUSH_MAX_US ((POT_SETTLE_MS + 1) * 1000 + POTS_PERIOD_US)
+
+static void sweepOnce(const char *name, bool thinned) {
+  hostSetPot(SWEEP_MUX, SWEEP_CHANNEL, 0);
+  hostRun(SWEEP_HOLD_MS * 1000);
+  uint32_t out = hostDinCCs;
+  uint32_t reads[MUXCHANNELS];
+  for (int c = 0; c < MUXCHANNELS; c++) reads[c] = hostMuxReads(c);
+
+  //Ramp then hold, noting the last read that changed the value and whether the thinning held it
+  int value = mux2ValuesPrev[SWEEP_CHANNEL];
+  uint32_t end = micros();
+  bool held = false;
+  uint32_t start = micros();
+  while (micros() - start < (SWEEP_MS + SWEEP_HOLD_MS) * 1000) {
+    uint32_t t = micros() - start;
+    hostSetPot(SWEEP_MUX, SWEEP_CHANNEL, t < SWEEP_MS * 1000 ? t * 1023 / (SWEEP_MS * 1000) : 1023);
+    hostRun(SWEEP_STEP_US);
+    if (mux2ValuesPrev[SWEEP_CHANNEL] != value) {
+      value = mux2ValuesPrev[SWEEP_CHANNEL];
+      end = hostMuxReadTime(SWEEP_CHANNEL);
+      held = potPending[CCfilterCutoff] != POT_NO_VALUE;
+    }
+  }
+
+  uint32_t others = 0;
+  for (int c = 0; c < MUXCHANNELS; c++) others += c == SWEEP_CHANNEL ? 0 : hostMuxReads(c) - reads[c];
+  int32_t latency = hostLastCCTime[CCfilterCutoff] - end;
+  Serial.printf("  %-12s %3u CCs on DIN | cutoff read %u times, others avg %u | final %u %s, sent %d uS after the last change read\n",
+                name, hostDinCCs - out, hostMuxReads(SWEEP_CHANNEL) - reads[SWEEP_CHANNEL], others / (MUXCHANNELS - 1),
+                hostLastCC[CCfilterCutoff], held ? "held" : "direct", latency);
+  hostCheck("last value read sent", hostLastCC[CCfilterCutoff] == value >> resolutionFrig);
+  hostCheck("sent after it was read", latency >= 0);
+  if (thinned) {
+    hostCheck("final value held and flushed once settled", held && latency >= SWEEP_FLUSH_MIN_US && latency <= SWEEP_FLUSH_MAX_US);
+  } else {
+    hostCheck("final value sent from the read", !held && latency <= POTS_PERIOD_US);
+  }
+}
+
+static void scenarioSweep() {
+  Serial.println("sweep");
+  sweepOnce("thinned", true);
+  setPotSweepStep(CCfilterCutoff, 1);
+  sweepOnce("every step", false);
+  setupPotThinning();
+}
+
+// session
+
+#define SESSION_MS 12000
+#define SESSION_STEP_US 250
+#define SESSION_BUCKETS 16  //log2 of the latency in uS
+
+//One hand on a pot, moving it linearly from one value to another
+struct SessionMove {
+  uint8_t mux, channel, cc;
+  uint16_t startMs, lengthMs, from, to;
+};
+
+//Cutoff sweeps, then cutoff and emphasis together, an LFO rate nudge, an echo and release tweak
+static const SessionMove sessionMoves[] = {
+  { 1, MUX2_CUTOFF, CCfilterCutoff, 200, 800, 200, 900 },
+  { 1, MUX2_CUTOFF, CCfilterCutoff, 1400, 600, 900, 300 },
+  { 1, MUX2_CUTOFF, CCfilterCutoff, 2500, 1500, 300, 700 },
+  { 1, MUX2_CUTOFF, CCfilterCutoff, 4500, 1200, 700, 150 },
+  { 1, MUX2_EMPHASIS, CCemphasis, 4600, 1000, 100, 800 },
+  { 0, MUX1_LFO_RATE, CClfoSpeed, 6500, 300, 500, 560 },
+  { 0, MUX1_LFO_RATE, CClfoSpeed, 7200, 400, 560, 420 },
+  { 1, MUX2_ECHO_MIX, CCechoLevel, 8200, 1200, 0, 600 },
+  { 2, MUX3_VCA_RELEASE, CCvcaRelease, 8400, 900, 800, 300 },
+  { 1, MUX2_CUTOFF, CCfilterCutoff, 10000, 1500, 150, 1000 },
+};
+#define SESSION_MOVES (sizeof(sessionMoves) / sizeof(sessionMoves[0]))
+
+static uint32_t sessionChanged[128];  //micros() of the first pot change not yet sent, 0 for none
+static uint32_t sessionLatency[128][SESSION_BUCKETS];
+
+//The first CC out after a change, later changes before it are covered by the same CC
+static void sessionCC(const uint8_t *bytes) {
+  uint8_t cc = bytes[1];
+  if ((bytes[0] & 0xF0) != 0xB0 || !sessionChanged[cc]) return;
+  uint32_t latency = micros() - sessionChanged[cc];
+  uint8_t bucket = 0;
+  while (latency > 1 && bucket < SESSION_BUCKETS - 1) {
+    latency >>= 1;
+    bucket++;
+  }
+  sessionLatency[cc][bucket]++;
+  sessionChanged[cc] = 0;
+}
+
+//Latency median in uS (bucket floor) and the count
+static uint32_t sessionMedian(uint8_t cc, uint32_t *count) {
+  uint32_t n = 0;
+  for (int b = 0; b < SESSION_BUCKETS; b++) n += sessionLatency[cc][b];
+  *count = n;
+  for (uint32_t b = 0, seen = 0; b < SESSION_BUCKETS; b++) {
+    seen += sessionLatency[cc][b];
+    if (seen * 2 >= n && n) return 1u << b;
+  }
+  return 0;
+}
+
+//Plays the session, returns the cutoff median latency
+static uint32_t sessionPlay(const char *name, uint32_t *readsPerSecond) {
+  Serial.printf("  %s\n", name);
+  for (const SessionMove &m : sessionMoves) hostSetPot(m.mux, m.channel, m.from);
+  hostRun(500000);
+  memset(sessionChanged, 0, sizeof(sessionChanged));
+  memset(sessionLatency, 0, sizeof(sessionLatency));
+  muxScanStatsReset();
+  uint32_t reads = hostAnalogReads();
+  hostDinWatch = sessionCC;
+
+  uint32_t start = micros();
+  uint16_t level[SESSION_MOVES];
+  for (unsigned i = 0; i < SESSION_MOVES; i++) level[i] = sessionMoves[i].from;
+  while (micros() - start < SESSION_MS * 1000) {
+    uint32_t ms = (micros() - start) / 1000;
+    for (unsigned i = 0; i < SESSION_MOVES; i++) {
+      const SessionMove &m = sessionMoves[i];
+      if (ms < m.startMs || ms > m.startMs + m.lengthMs) continue;
+      uint16_t v = m.from + ((int32_t)m.to - m.from) * (int32_t)(ms - m.startMs) / m.lengthMs;
+      if (v == level[i]) continue;
+      level[i] = v;
+      hostSetPot(m.mux, m.channel, v);
+      //Only a change the scan can see, beyond QUANTISE_FACTOR at the ADC resolution
+      int *prev = m.mux == 0 ? mux1ValuesPrev : m.mux == 1 ? mux2ValuesPrev : mux3ValuesPrev;
+      int adc = v >> 2;
+      if ((adc > prev[m.channel] + QUANTISE_FACTOR || adc < prev[m.channel] - QUANTISE_FACTOR) && !sessionChanged[m.cc]) {
+        sessionChanged[m.cc] = micros();
+      }
+    }
+    hostRun(SESSION_STEP_US);
+  }
+  hostRun(100000);
+  hostDinWatch = nullptr;
+
+  printMuxScanStats();
+  *readsPerSecond = (hostAnalogReads() - reads) * 1000 / (SESSION_MS + 100);
+  Serial.printf("  %u ADC reads/s | motion to DIN CC latency histogram (2^n uS), median\n", *readsPerSecond);
+  static const uint8_t ccs[] = { CCfilterCutoff, CCemphasis, CClfoSpeed, CCechoLevel, CCvcaRelease };
+  for (uint8_t cc : ccs) {
+    uint32_t count;
+    uint32_t median = sessionMedian(cc, &count);
+    Serial.printf("  cc %3u %4u |", cc, count);
+    for (int b = 0; b < SESSION_BUCKETS; b++) Serial.printf(" %u", sessionLatency[cc][b]);
+    Serial.printf(" | %u uS\n", median);
+  }
+  uint32_t count;
+  return sessionMedian(CCfilterCutoff, &count);
+}
+
+//No address read less often than once every 2 * MUXCHANNELS pots runs. Runs start late behind
+//midiCCOut()'s delays and the buckets are powers of two, so up to twice that time passes.
+static bool sessionIdleRefreshed() {
+  for (int i = 0; i < MUXCHANNELS; i++) {
+    for (int b = 0; b < MUX_STATS_BUCKETS; b++) {
+      if (muxIntervalHist[i][b] && (1UL << b) >= 4UL * MUXCHANNELS * POTS_PERIOD_US) return false;
+    }
+  }
+  return true;
+}
+
+//The same scripted playing session with the plain round robin and with the weighted scan
+static void scenarioSession() {
+  Serial.println("session");
+  muxScanBoost = false;
+  muxScanReset();
+  uint32_t roundRobinReads, weightedReads;
+  uint32_t roundRobin = sessionPlay("round robin", &roundRobinReads);
+  muxScanBoost = true;
+  muxScanReset();
+  uint32_t weighted = sessionPlay("activity weighted", &weightedReads);
+  hostCheck("cutoff median latency lower when weighted", weighted < roundRobin);
+  hostCheck("ADC load within 1%", weightedReads * 100 >= roundRobinReads * 99 && weightedReads * 100 <= roundRobinReads * 101);
+  hostCheck("idle addresses still refreshed", sessionIdleRefreshed());
+}
+
+// load
+
+#define LOAD_MS 3000
+#define LOAD_CC_EVERY_US 7000     //One CC in on USB per
+#define LOAD_NOTE_EVERY_US 5000   //One note in on DIN per
+#define LOAD_FLOOD_EVERY_US 2500  //An automation lane from the VST
+#define LOAD_DISPLAY_US 12000     //A full redraw of the TFT
+#define LOAD_CC CCechoLevel
+
+struct LoadResult {
+  std::vector<uint32_t> ccs, notes;
+  uint32_t ccsIn, notesIn;
+};
+
+//Arrival times by CC value and by note number, every one sent is different from the last 100
+static uint32_t loadCCIn[128], loadNoteIn[128];
+static LoadResult *loadResult;
+
+static void loadOut(const uint8_t *bytes) {
+  uint8_t type = bytes[0] & 0xF0;
+  if (type == 0xB0 && bytes[1] == LOAD_CC && loadCCIn[bytes[2]]) {
+    loadResult->ccs.push_back(micros() - loadCCIn[bytes[2]]);
+    loadCCIn[bytes[2]] = 0;
+  }
+  if (type == 0x90 && loadNoteIn[bytes[1]]) {
+    loadResult->notes.push_back(micros() - loadNoteIn[bytes[1]]);
+    loadNoteIn[bytes[1]] = 0;
+  }
+}
+
+static uint32_t loadPercentile(std::vector<uint32_t> &v, int p) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[(v.size() - 1) * p / 100];
+}
+
+//CCs from the VST on USB, which go out on DIN through midiCCOut(), and notes on DIN, which the
+//passthrough forwards, arriving while the loads run. Latency is arrival to DIN out.
+static LoadResult loadRun(bool display, bool sweep, bool flood) {
+  LoadResult r = {};
+  memset(loadCCIn, 0, sizeof(loadCCIn));
+  memset(loadNoteIn, 0, sizeof(loadNoteIn));
+  loadResult = &r;
+  hostDinWatch = loadOut;
+  hostDisplayBusyUs = display ? LOAD_DISPLAY_US : 0;
+  uint32_t start = micros(), nextCC = start, nextNote = start + 1300, nextFlood = start + 700;
+  uint8_t value = hostLastCC[LOAD_CC], note = 0, floodValue = 0;
+  while (micros() - start < LOAD_MS * 1000) {
+    uint32_t now = micros();
+    if (sweep) hostSetPot(1, MUX2_CUTOFF, (now - start) / 1000 % 1000);
+    if (flood && (int32_t)(now - nextFlood) >= 0) {
+      usbMIDI.receive(midi::ControlChange, 1, CCemphasis, floodValue++ & 0x7F);
+      nextFlood += LOAD_FLOOD_EVERY_US;
+    }
+    if ((int32_t)(now - nextCC) >= 0) {
+      value = (value + 37) & 0x7F;
+      loadCCIn[value] = now;
+      usbMIDI.receive(midi::ControlChange, 1, LOAD_CC, value);
+      r.ccsIn++;
+      nextCC += LOAD_CC_EVERY_US;
+    }
+    if ((int32_t)(now - nextNote) >= 0) {
+      note = (note + 1) % 100;
+      loadNoteIn[note] = now;
+      MIDI.receive(midi::NoteOn, 1, note, 100);
+      MIDI.receive(midi::NoteOff, 1, note, 0);
+      r.notesIn++;
+      nextNote += LOAD_NOTE_EVERY_US;
+    }
+    hostRun(100);
+  }
+  hostDisplayBusyUs = 0;
+  hostRun(100000);
+  hostDinWatch = nullptr;
+  return r;
+}
+
+//Input to output latency with the scheduler under load, and the deadline misses it counted
+static void scenarioLoad() {
+  Serial.println("load");
+  Serial.println("  load            CC in to DIN out p50/p99/max uS | note in to DIN out p50/p99/max uS | misses midi in/pots/leds");
+  struct {
+    const char *name;
+    bool display, sweep, flood;
+  } loads[] = {
+    { "idle", false, false, false },
+    { "display", true, false, false },
+    { "display+sweep", true, true, false },
+    { "cc flood", false, false, true },
+  };
+  bool ccOk = true, notesOk = true;
+  for (auto &l : loads) {
+    uint32_t misses[4];
+    for (int i = 0; i < 4; i++) misses[i] = schedTasks[i].misses;
+    LoadResult r = loadRun(l.display, l.sweep, l.flood);
+    uint32_t ccLost = r.ccsIn - r.ccs.size(), notesLost = r.notesIn - r.notes.size();
+    Serial.printf("  %-15s %5u %5u %5u lost %u | %5u %5u %5u lost %u | %u/%u/%u\n", l.name,
+                  loadPercentile(r.ccs, 50), loadPercentile(r.ccs, 99), loadPercentile(r.ccs, 100), ccLost,
+                  loadPercentile(r.notes, 50), loadPercentile(r.notes, 99), loadPercentile(r.notes, 100), notesLost,
+                  schedTasks[0].misses - misses[0], schedTasks[1].misses - misses[1], schedTasks[3].misses - misses[3]);
+    //A CC waits for the task running when it arrives, then the queue and midiCCOut()'s 2mS
+    uint32_t bound = (l.display ? LOAD_DISPLAY_US : 0) + MIDI_POLL_US + MIDI_IN_DEADLINE_US + 3000;
+    ccOk = ccOk && !ccLost && loadPercentile(r.ccs, 100) <= bound;
+    //The passthrough forwards from the poll interrupt whatever loop() is doing
+    notesOk = notesOk && !notesLost && loadPercentile(r.notes, 100) <= MIDI_POLL_US + 2000;
+  }
+  hostCheck("CCs out within the task they waited for", ccOk);
+  hostCheck("notes out within a poll period of the wire", notesOk);
+}
+
+// latency
+
+//The benchmark's pot movements come far apart, it takes a while on the virtual clock
+#define LATENCY_MAX_S 600
+
+//LatencyBench.h as the firmware runs it, latencyBenchStep() on every loop() pass
+static void scenarioLatency() {
+  Serial.println("latency");
+  if (patches.size() == 0) {
+    SD.begin(BUILTIN_SDCARD);
+    savePatch("1", INITPATCH);
+    loadPatches();
+  }
+  uint32_t start = millis();
+  while (!benchDone && millis() - start < LATENCY_MAX_S * 1000) {
+    uint32_t before = micros();
+    latencyBenchStep();
+    schedulerRun();
+    usbMidiFlush();
+    if (micros() == before) hostAdvanceUs(HOST_PASS_US);
+  }
+  hostCheck("benchmark ran under every load", benchDone);
+  bool samples = true;
+  for (int l = 0; l < BENCH_LOADS; l++) samples = samples && benchLoadSamples[l] > 0;
+  hostCheck("pot moves measured under every load", samples);
+  //Within a scan of the moved address, or once the pot settles where thinning holds the move
+  hostCheck("idle moves out within a scan and the settle time",
+            benchLoadMax[BENCH_IDLE] <= MUXCHANNELS * POTS_PERIOD_US + (POT_SETTLE_MS + 1) * 1000 + POTS_PERIOD_US);
+  hostRun(200000);
+}
+
+// dispatch
+
+#define DISPATCH_ROUNDS 20000
+
+//Host ns per processButtonFrame() call that dispatches a frame with these buttons changed
+static double dispatchBench(const ButtonFrame &idle, const ButtonFrame &pressed, uint32_t *handlers) {
+  uint32_t calls = hostCCCalls;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < DISPATCH_ROUNDS; r++) {
+    processButtonFrame(pressed);  //Noted, then dispatched on the next call with debounce 0
+    processButtonFrame(pressed);
+    processButtonFrame(idle);
+    processButtonFrame(idle);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  *handlers = (hostCCCalls - calls) / DISPATCH_ROUNDS;
+  //Four calls per round, two of them dispatch
+  return std::chrono::duration<double, std::nano>(elapsed).count() / (DISPATCH_ROUNDS * 2);
+}
+
+//Change detection and table dispatch cost against the number of buttons changed, handlers muted
+static void scenarioDispatch() {
+  Serial.println("dispatch");
+  int saved[BUTTON_TOTAL], savedExit[BUTTON_TOTAL];
+  for (int i = 0; i < BUTTON_TOTAL; i++) {
+    if (buttonActions[i].value) saved[i] = *buttonActions[i].value;
+    if (buttonActions[i].exitValue) savedExit[i] = *buttonActions[i].exitValue;
+  }
+  ButtonFrame idle = sr.buttonFrame();
+  setupButtons(0);
+  hostCCsMuted = true;
+
+  //Toggles only, one handler call per press and none per release
+  uint8_t toggles[BUTTON_TOTAL];
+  int toggleCount = 0;
+  for (int i = 0; i < BUTTON_TOTAL; i++) {
+    if (buttonActions[i].kind == BUTTON_TOGGLES) toggles[toggleCount++] = i;
+  }
+  Serial.printf("  %d rounds, host ns per dispatching call\n", DISPATCH_ROUNDS);
+  static const int counts[] = { 0, 1, 8, 32 };
+  double base = 0;
+  bool handled = true;
+  for (int n : counts) {
+    ButtonFrame pressed = idle;
+    for (int k = 0; k < n && k < toggleCount; k++) pressed.bits[toggles[k] >> 5] ^= 1UL << (toggles[k] & 31);
+    uint32_t handlers;
+    double ns = dispatchBench(idle, pressed, &handlers);
+    if (n == 0) base = ns;
+    Serial.printf("  %2d toggles changed %7.1f ns, %5.1f ns per button, %u handler calls\n",
+                  n, ns, n ? (ns - base) / n : 0.0, handlers);
+    handled = handled && handlers == (uint32_t)n;
+  }
+  ButtonFrame all = idle;
+  for (int w = 0; w < BUTTON_WORDS; w++) all.bits[w] = ~idle.bits[w];
+  all.bits[BUTTON_WORDS - 1] &= (1UL << (BUTTON_TOTAL - 32 * (BUTTON_WORDS - 1))) - 1;
+  uint32_t handlers;
+  double ns = dispatchBench(idle, all, &handlers);
+  Serial.printf("  all %d changed   %7.1f ns, %5.1f ns per button, %u handler calls\n",
+                BUTTON_TOTAL, ns, (ns - base) / BUTTON_TOTAL, handlers);
+  hostCheck("one handler call per toggle pressed", handled);
+
+  hostCCsMuted = false;
+  setupButtons(BTN_DEBOUNCE);
+  processButtonFrame(idle);
+  for (int i = 0; i < BUTTON_TOTAL; i++) {
+    if (buttonActions[i].value) *buttonActions[i].value = saved[i];
+    if (buttonActions[i].exitValue) *buttonActions[i].exitValue = savedExit[i];
+  }
+}
+
+// glyphs
+
+#define GLYPH_W 160
+#define GLYPH_H 128
+#define GLYPH_RUNS 2000
+
+static uint16_t glyphFrame[GLYPH_W * GLYPH_H];
+static int16_t glyphDirty[4];  //x0, y0, x1, y1 as ST7735_t3 keeps it
+
+static void glyphMarkDirty(int16_t x, int16_t y, int16_t w, int16_t h) {
+  glyphDirty[0] = std::min(glyphDirty[0], x);
+  glyphDirty[1] = std::min(glyphDirty[1], y);
+  glyphDirty[2] = std::max<int16_t>(glyphDirty[2], x + w - 1);
+  glyphDirty[3] = std::max<int16_t>(glyphDirty[3], y + h - 1);
+}
+
+//ST7735_t3::drawPixel() in frame buffer mode, called through a pointer as the virtual one is
+static void glyphPixel(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || x >= GLYPH_W || y < 0 || y >= GLYPH_H) return;
+  glyphFrame[y * GLYPH_W + x] = color;
+  glyphMarkDirty(x, y, 1, 1);
+}
+static void (*volatile glyphDrawPixel)(int16_t, int16_t, uint16_t) = glyphPixel;
+
+//Adafruit_GFX::drawChar() for a custom font, a pixel write per set bit
+static void glyphBitWalk(int16_t x, int16_t y, const GFXglyph *glyph, uint16_t color) {
+  const uint8_t *bitmap = Yeysk16pt7b.bitmap;
+  uint16_t bo = glyph->bitmapOffset;
+  uint8_t bits = 0, bit = 0;
+  for (uint8_t yy = 0; yy < glyph->height; yy++) {
+    for (uint8_t xx = 0; xx < glyph->width; xx++) {
+      if (!(bit++ & 7)) bits = bitmap[bo++];
+      if (bits & 0x80) glyphDrawPixel(x + glyph->xOffset + xx, y + glyph->yOffset + yy, color);
+      bits <<= 1;
+    }
+  }
+}
+
+//ST7735_t3::write()'s fill of the glyph's spans
+static void glyphSpanFill(int16_t x, int16_t y, const GFXglyph *glyph, const uint8_t *record, uint16_t color) {
+  uint16_t count = *(const uint16_t *)record;
+  const ST77XX_GlyphSpan *span = (const ST77XX_GlyphSpan *)(record + 2);
+  int16_t gx = x + glyph->xOffset;
+  int16_t gy = y + glyph->yOffset;
+  glyphMarkDirty(gx, gy, glyph->width, glyph->height);
+  for (; count; count--, span++) {
+    int16_t py = gy + span->dy;
+    if (py < 0 || py >= GLYPH_H) continue;
+    int16_t px = gx + span->dx;
+    int16_t x_end = px + span->len;
+    if (px < 0) px = 0;
+    if (x_end > GLYPH_W) x_end = GLYPH_W;
+    uint16_t *pixel = &glyphFrame[py * GLYPH_W + px];
+    for (; px < x_end; px++) *pixel++ = color;
+  }
+}
+
+//The texts of the parameter, patch and settings pages, all in the one font of the tree
+static const char *const glyphTexts[] = { "Filter Cutoff", "24000.00 Hz", "127", "Initial Patch", "MIDI In Ch.", "All" };
+
+static void glyphText(int16_t x, int16_t y, const char *text, bool spans, uint16_t color) {
+  for (const char *c = text; *c; c++) {
+    const GFXglyph *glyph = &Yeysk16pt7b.glyph[*c - Yeysk16pt7b.first];
+    if (glyph->width && glyph->height) {
+      if (spans) glyphSpanFill(x, y, glyph, glyphSpans(&Yeysk16pt7b, *c), color);
+      else glyphBitWalk(x, y, glyph, color);
+    }
+    x += glyph->xAdvance;
+  }
+}
+
+static void glyphClean() {
+  glyphDirty[0] = glyphDirty[1] = INT16_MAX;
+  glyphDirty[2] = glyphDirty[3] = -1;
+}
+
+static void glyphPage(bool spans) {
+  memset(glyphFrame, 0, sizeof(glyphFrame));
+  glyphClean();
+  int16_t y = Yeysk16pt7b.yAdvance - 4;
+  for (const char *text : glyphTexts) {
+    glyphText(0, y, text, spans, 0xFFFF);
+    y += Yeysk16pt7b.yAdvance / 2;
+  }
+}
+
+//ST7735_t3::fillRect() in frame buffer mode
+static void glyphFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  for (int16_t yy = y; yy < y + h; yy++) std::fill_n(&glyphFrame[yy * GLYPH_W + x], w, color);
+  glyphMarkDirty(x, y, w, h);
+}
+
+//A scroll of the recall page, renderRecallPage() once it is up: every row redrawn
+static void glyphListScroll(int first) {
+  static const int16_t rows[3][3] = { { 30, 26, 45 }, { 56, 23, 72 }, { 79, 27, 98 } };  //top, height, baseline
+  glyphClean();
+  for (int r = 0; r < 3; r++) {
+    char number[8], name[16];
+    snprintf(number, sizeof(number), "%d", first + r);
+    snprintf(name, sizeof(name), "Patch %d", first + r);
+    glyphFillRect(0, rows[r][0], GLYPH_W, rows[r][1], r == 1 ? 0xA000 : 0);
+    glyphText(0, rows[r][2], number, true, 0xFFE0);
+    glyphText(35, rows[r][2], name, true, 0xFFFF);
+  }
+}
+
+//Host ns per page
+static double glyphBench(bool spans) {
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < GLYPH_RUNS; r++) glyphPage(spans);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / GLYPH_RUNS;
+}
+
+//The TFT's glyph span cache against Adafruit_GFX's bit walk, the same pixels and the time per page
+static void scenarioGlyphs() {
+  Serial.println("glyphs");
+  static uint16_t walked[GLYPH_W * GLYPH_H];
+  glyphPage(false);
+  memcpy(walked, glyphFrame, sizeof(walked));
+  glyphPage(true);
+  hostCheck("spans draw the same pixels as the bit walk", memcmp(walked, glyphFrame, sizeof(walked)) == 0);
+
+  uint32_t glyphs = Yeysk16pt7b.last - Yeysk16pt7b.first + 1, spans = 0, size = glyphs * 2;
+  bool same = true;
+  for (uint16_t c = Yeysk16pt7b.first; c <= Yeysk16pt7b.last; c++) {
+    const GFXglyph *glyph = &Yeysk16pt7b.glyph[c - Yeysk16pt7b.first];
+    memset(glyphFrame, 0, sizeof(glyphFrame));
+    glyphBitWalk(40, 60, glyph, 1);
+    memcpy(walked, glyphFrame, sizeof(walked));
+    memset(glyphFrame, 0, sizeof(glyphFrame));
+    const uint8_t *record = glyphSpans(&Yeysk16pt7b, c);
+    glyphSpanFill(40, 60, glyph, record, 1);
+    same = same && memcmp(walked, glyphFrame, sizeof(walked)) == 0;
+    spans += *(const uint16_t *)record;
+    size += glyphRecordSize(*(const uint16_t *)record);
+  }
+  hostCheck("every glyph of the font the same", same);
+
+  double walk = glyphBench(false), fill = glyphBench(true);
+  Serial.printf("  %u glyphs, %u spans, %u bytes of heap for the font\n", glyphs, spans, _glyph_bytes);
+  Serial.printf("  host ns per page: bit walk %.0f, spans %.0f (%.1fx)\n", walk, fill, walk / fill);
+
+  //The patch list redraws all three rows on a scroll, what that costs against a full page
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < GLYPH_RUNS; r++) glyphListScroll(r % 100 + 1);
+  double scroll = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / GLYPH_RUNS;
+  //Rows 30 to 105, the list's FreeSans9pt7b stays inside them, this taller font does not
+  Serial.printf("  list scroll, three rows: host ns %.0f, %u bytes to the TFT of %u for the page\n",
+                scroll, GLYPH_W * (26 + 23 + 27) * 2, GLYPH_W * GLYPH_H * 2);
+  hostCheck("one block sized from the font's glyphs", _glyph_bytes == size);
+}
+
+// panelio
+
+#define PANEL_FRAME_US (PANEL_BAM_TICK * LED_LEVEL_FULL)
+
+//Only the refresh timer runs, loop() and its LED task do not
+static void panelFrames(int frames) {
+  hostAdvanceUs(PANEL_FRAME_US * frames + PANEL_BAM_TICK);
+}
+
+static bool panelOnlyLatched(int pin) {
+  for (int i = 0; i < PANEL_IO_BITS; i++) {
+    if (hostLedLatched(i) != (i == pin)) return false;
+  }
+  return true;
+}
+
+//The PanelIO driver on its own against the 74HC595 and 74HC165 models
+static void scenarioPanelIO() {
+  Serial.println("panelio");
+  const uint8_t off[PANEL_IO_BYTES] = {};
+  for (int i = 0; i < PANEL_IO_BITS; i++) sr.setLevel(i, LED_LEVEL_FULL);
+
+  //Each LED bit reaches its own 595 output, and only that one
+  bool ok = true;
+  for (int pin = 0; pin < PANEL_IO_BITS && ok; pin++) {
+    sr.writeFrame(off);
+    sr.writePin(pin, true);
+    sr.update();
+    panelFrames(2);
+    ok = panelOnlyLatched(pin) && sr.readPin(pin);
+    if (!ok) Serial.printf("  LED %d wrong\n", pin);
+  }
+  hostCheck("every LED on its own output", ok);
+
+  //Each 165 input lands on its own bit of the button frame
+  ok = true;
+  for (int b = 0; b < PANEL_IO_BITS && ok; b++) {
+    hostSetButton(b, true);
+    panelFrames(2);
+    ButtonFrame f = sr.buttonFrame();
+    for (int i = 0; i < PANEL_IO_BITS; i++) ok = ok && ((f.bits[i >> 5] >> (i & 31)) & 1) == (i == b);
+    hostSetButton(b, false);
+    if (!ok) Serial.printf("  button %d wrong\n", b);
+  }
+  panelFrames(2);
+  ButtonFrame none = sr.buttonFrame();
+  hostCheck("every button on its own bit, released reads 0", ok && !none.bits[0] && !none.bits[1] && !none.bits[2]);
+
+  //Four timer interrupts a frame whatever is lit
+  uint32_t frames = sr.frameCount(), latches = hostPanelLatches();
+  panelFrames(100);
+  frames = sr.frameCount() - frames;
+  latches = hostPanelLatches() - latches;
+  //The count starts and ends wherever the frame is, within a frame of each other
+  hostCheck("one latch per bit plane", latches + PANEL_BAM_PLANES > frames * PANEL_BAM_PLANES
+                                         && latches < (frames + 1) * PANEL_BAM_PLANES);
+
+  //Every level is lit for level / 15 of a frame, level 0 is off
+  sr.writeFrame(off);
+  for (int pin = 0; pin <= LED_LEVEL_FULL; pin++) {
+    sr.writePin(pin, true);
+    sr.setLevel(pin, pin);
+  }
+  sr.update();
+  panelFrames(2);
+  hostLedResetDuty();
+  panelFrames(60);
+  ok = true;
+  Serial.print("  duty by level");
+  for (int level = 0; level <= LED_LEVEL_FULL; level++) {
+    float duty = hostLedDuty(level);
+    Serial.printf(" %.2f", duty);
+    ok = ok && fabsf(duty - (float)level / LED_LEVEL_FULL) < 0.01f;
+  }
+  Serial.println();
+  hostCheck("BAM duty matches every level", ok);
+
+  //LEDs that are off glow at the inactive level, blinking masks whole frames
+  sr.writeFrame(off);
+  for (int pin = 0; pin <= LED_LEVEL_FULL; pin++) sr.setLevel(pin, LED_LEVEL_FULL);
+  sr.setInactiveLevel(3);
+  sr.writePin(1, true);
+  sr.setBlink(1, LED_BLINK_FAST);
+  sr.update();
+  panelFrames(2);
+  hostLedResetDuty();
+  panelFrames(PANEL_BLINK_STEP * 32);
+  float glow = hostLedDuty(0), blink = hostLedDuty(1);
+  Serial.printf("  inactive level 3 duty %.2f, fast blink duty %.2f\n", glow, blink);
+  hostCheck("inactive glow", fabsf(glow - 3.0f / LED_LEVEL_FULL) < 0.01f);
+  hostCheck("blink shows half the frames", fabsf(blink - 0.5f) < 0.02f);
+
+  //Writes go to the back state, only update() shows them
+  sr.setInactiveLevel(LED_INACTIVE_LEVEL);
+  sr.setBlink(1, LED_STEADY);
+  sr.writeFrame(off);
+  sr.writePin(5, true);
+  sr.update();
+  panelFrames(2);
+  sr.writePin(5, false);
+  sr.writePin(6, true);
+  panelFrames(2);
+  bool before = panelOnlyLatched(5);
+  sr.update();
+  panelFrames(2);
+  hostCheck("writes shown from the next update() on", before && panelOnlyLatched(6));
+
+  sr.writeFrame(off);
+  sr.update();
+  hostRun(20000);  //The LED task rebuilds the panel from the parameters
+}
+
+// panel
+
+static void scenarioPanel() {
+  Serial.println("panel");
+  //Brightness and blink from the 595 latches over a second, the LEDs are lit
+  //by the parameters they show as the LED task builds the frame
+  static const uint8_t levels[] = { 15, 8, 4, 1 };
+  static const uint8_t leds[] = { LFO_INVERT_LED, CONT_OSC3_AMOUNT_LED, VOICE_MOD_DEST_VCA_LED, PHASER_LED };
+  int *values[] = { &lfoInvert, &contourOsc3Amt, &voiceModDestVCA, &phaserSW };
+  for (int i = 0; i < 4; i++) {
+    *values[i] = 1;
+    sr.setLevel(leds[i], levels[i]);
+  }
+  chordMemoryWait = true;
+  hostRun(10000);
+  hostLedResetDuty();
+  uint32_t frames = sr.frameCount();
+  uint32_t latches = hostPanelLatches();
+  hostRun(1000000);
+  Serial.printf("  %u frames/s, %u latches/s | duty", sr.frameCount() - frames, hostPanelLatches() - latches);
+  bool ok = true;
+  for (int i = 0; i < 4; i++) {
+    float duty = hostLedDuty(leds[i]);
+    Serial.printf(" level %u %.3f", levels[i], duty);
+    ok = ok && fabsf(duty - levels[i] / 15.0f) < 0.02f;
+  }
+  Serial.printf(" | blink %.3f\n", hostLedDuty(CHORD_MODE_LED));
+  hostCheck("brightness levels", ok);
+  hostCheck("blinking half the time", fabsf(hostLedDuty(CHORD_MODE_LED) - 0.5f) < 0.05f);
+  for (int i = 0; i < 4; i++) {
+    *values[i] = 0;
+    sr.setLevel(leds[i], LED_LEVEL_FULL);
+  }
+  chordMemoryWait = false;
+  hostRun(10000);
+
+  //The LED task and a recall both updating before the next frame starts,
+  //the second frame must be the one latched
+  phaserSW = 1;
+  hostLedsTask();
+  lowSW = 1;
+  phaserSW = 0;
+  hostLedsTask();
+  hostAdvanceUs(PANEL_BAM_TICK * 15 * 2 + PANEL_BAM_TICK);
+  hostCheck("second update in a frame latched", hostLedLatched(LOW_LED) && !hostLedLatched(PHASER_LED));
+  lowSW = 0;
+  hostRun(10000);
+
+  //A toggle button from the 165 chain to a CC and its LED
+  int before = lfoInvert;
+  uint32_t out = hostDinCCs;
+  hostSetButton(LFO_INVERT_SW, true);
+  hostRun(100000);
+  hostSetButton(LFO_INVERT_SW, false);
+  hostRun(100000);
+  hostCheck("button toggled the value", lfoInvert != before && hostDinCCs == out + 1 && hostLastCC[CClfoInvert] == lfoInvert);
+  hostCheck("LED follows the value", hostLedLatched(LFO_INVERT_LED) == (lfoInvert != 0));
+}
+
+// echo
+
+//A CC with the value just sent arriving back on DIN, through the poll interrupt and the queue
+static bool hostEchoDropped(byte value) {
+  uint32_t echoes = midiTraffic[MIDI_PORT_DIN].echoes;
+  MIDI.receive(midi::ControlChange, 1, CCemphasis, value);
+  hostRun(2000);
+  return midiTraffic[MIDI_PORT_DIN].echoes != echoes;
+}
+
+static void scenarioEcho() {
+  Serial.println("echo");
+  static const uint32_t delaysMs[] = { 2, 20, 50, 200 };
+  for (uint8_t w = 0; w < sizeof(routeEchoWindowsMs); w++) {
+    routeEchoWindow = w;
+    bool ok = true;
+    Serial.printf("  window %3u mS, echo dropped after", routeEchoWindowsMs[w]);
+    for (uint32_t d : delaysMs) {
+      myControlChange(midiChannel, CCemphasis, 64);
+      hostRun(d * 1000 - 2000);  //Plus midiCCOut()'s 2mS
+      bool drop = hostEchoDropped(64);
+      Serial.printf(" %u mS %s", d, drop ? "yes" : "no ");
+      ok = ok && drop == (d <= routeEchoWindowsMs[w]);
+    }
+    Serial.println();
+    hostCheck("drops within the window only", ok);
+  }
+  //A different value is never an echo
+  routeEchoWindow = 3;
+  myControlChange(midiChannel, CCemphasis, 64);
+  uint32_t out = hostDinCCs;
+  hostCheck("new value passed", !hostEchoDropped(65) && hostDinCCs == out + 1 && hostLastCC[CCemphasis] == 65);
+  routeEchoWindow = getEchoWindow();
+}
+
+// loopback
+
+#define LOOPBACK_VST_US 5000  //The VST sends back what it gets after this long
+#define LOOPBACK_SWEEP_MS 1000
+#define LOOPBACK_TAIL_MS 500
+
+struct LoopbackCC {
+  uint32_t due;
+  uint8_t cc, value;
+};
+
+static std::deque<LoopbackCC> loopbackVst;
+static uint32_t loopbackDin, loopbackUsb;
+
+static void loopbackDinOut(const uint8_t *bytes) {
+  if ((bytes[0] & 0xF0) == 0xB0) loopbackDin++;
+}
+
+//A VST that echoes every CC it gets from the synth as its own automation
+static void loopbackUsbOut(const uint8_t *bytes) {
+  if ((bytes[0] & 0xF0) != 0xB0) return;
+  loopbackUsb++;
+  if (loopbackVst.size() < 1000) loopbackVst.push_back({ micros() + LOOPBACK_VST_US, bytes[1], bytes[2] });
+}
+
+struct LoopbackResult {
+  uint32_t din, usb, fromVst, echoes;
+};
+
+//A cutoff sweep with the VST echoing, and the tail after it, CCs on each output
+static LoopbackResult loopbackRun(uint8_t window, bool vst) {
+  routeEchoWindow = window;
+  loopbackVst.clear();
+  loopbackDin = loopbackUsb = 0;
+  hostDinWatch = loopbackDinOut;
+  hostUsbWatch = loopbackUsbOut;
+  LoopbackResult r = {};
+  uint32_t echoes = midiTraffic[MIDI_PORT_USB_DEVICE].echoes;
+  uint32_t start = micros();
+  while (micros() - start < (LOOPBACK_SWEEP_MS + LOOPBACK_TAIL_MS) * 1000) {
+    uint32_t t = micros() - start;
+    if (t < LOOPBACK_SWEEP_MS * 1000) hostSetPot(1, MUX2_CUTOFF, t * 1023 / (LOOPBACK_SWEEP_MS * 1000));
+    while (!loopbackVst.empty() && (int32_t)(micros() - loopbackVst.front().due) >= 0) {
+      if (vst) {
+        usbMIDI.receive(midi::ControlChange, midiOutCh, loopbackVst.front().cc, loopbackVst.front().value);
+        r.fromVst++;
+      }
+      loopbackVst.pop_front();
+    }
+    hostRun(100);
+  }
+  hostDinWatch = nullptr;
+  hostUsbWatch = nullptr;
+  hostSetPot(1, MUX2_CUTOFF, 512);
+  hostRun(100000);
+  r.din = loopbackDin;
+  r.usb = loopbackUsb;
+  r.echoes = midiTraffic[MIDI_PORT_USB_DEVICE].echoes - echoes;
+  return r;
+}
+
+//CCs looped back from USB out to USB in by the VST, against each echo window
+static void scenarioLoopback() {
+  Serial.println("loopback");
+  LoopbackResult alone = loopbackRun(0, false);
+  Serial.printf("  %-12s CCs DIN out %5u USB out %5u\n", "no VST", alone.din, alone.usb);
+  LoopbackResult off = {};
+  bool ok = true;
+  for (uint8_t w = 0; w < sizeof(routeEchoWindowsMs); w++) {
+    LoopbackResult r = loopbackRun(w, true);
+    if (w == 0) off = r;
+    uint32_t total = r.din + r.usb, offTotal = off.din + off.usb;
+    Serial.printf("  window %3u mS CCs DIN out %5u USB out %5u | from VST %5u echoes dropped %5u | %3u%% less than off\n",
+                  routeEchoWindowsMs[w], r.din, r.usb, r.fromVst, r.echoes,
+                  offTotal ? (offTotal - (total < offTotal ? total : offTotal)) * 100 / offTotal : 0);
+    //The VST answers within every window, its echoes all dropped and nothing more goes out than without it
+    if (w > 0) ok = ok && r.echoes == r.fromVst && r.din <= alone.din && r.usb <= alone.usb;
+  }
+  hostCheck("the VST loop grows traffic without the filter", off.din + off.usb > alone.din + alone.usb);
+  hostCheck("every echo dropped within each window", ok);
+  routeEchoWindow = getEchoWindow();
+}
+
+// traffic
+
+static IntervalTimer hostNoteTimer;
+static uint32_t hostNoteIn = 0;
+
+//From a timer, so it also arrives while loop() is blocked in a send
+static void hostNoteArrives() {
+  hostNoteTimer.end();
+  hostNoteIn = micros();
+  MIDI.receive(midi::NoteOn, 1, 60, 100);
+}
+
+//A note on DIN while a traffic query for all ports is answered there
+static void scenarioTraffic() {
+  Serial.println("traffic");
+  const uint8_t query[] = { 0xF0, TRAFFIC_SYSEX_ID, TRAFFIC_SYSEX_SUB, TRAFFIC_QUERY, TRAFFIC_ALL_PORTS, 0xF7 };
+  const uint8_t queryCCs[] = { 0xF0, TRAFFIC_SYSEX_ID, TRAFFIC_SYSEX_SUB, TRAFFIC_QUERY_CCS, TRAFFIC_ALL_PORTS, 0xF7 };
+  const uint32_t replyUs = (5 + 16 * 5 + 1) * TRAFFIC_DIN_BYTE_US;
+
+  uint32_t din = hostDinSysEx;
+  uint32_t noteOut = hostDinNoteTime;
+  MIDI.receiveSysEx(query, sizeof(query));
+  hostNoteTimer.begin(hostNoteArrives, 5000);
+  while (hostDinNoteTime == noteOut) hostRun(100);
+  uint32_t noteLatency = hostDinNoteTime - hostNoteIn;
+  MIDI.receive(midi::NoteOff, 1, 60, 0);
+  hostRun(TRAFFIC_PORTS * replyUs + 10000);
+  Serial.printf("  DIN query, %u replies, note out %u uS after it came in (one reply %u uS)\n",
+                hostDinSysEx - din, noteLatency, replyUs);
+  hostCheck("one reply per port", hostDinSysEx - din == TRAFFIC_PORTS);
+  hostCheck("note waited for one reply at most", noteLatency <= replyUs + MIDI_POLL_US);
+
+  din = hostDinSysEx;
+  MIDI.receiveSysEx(queryCCs, sizeof(queryCCs));
+  hostRun(100000);
+  hostCheck("CC counts not sent on DIN", hostDinSysEx == din);
+
+  //midiQueueProcess() is the midi in task's pass
+  uint32_t usb = hostUsbSysEx;
+  usbMIDI.receiveSysEx(queryCCs, sizeof(queryCCs));
+  hostAdvanceUs(MIDI_POLL_US);
+  bool onePerPass = true;
+  for (uint32_t p = 1; p <= TRAFFIC_PORTS + 1; p++) {
+    midiQueueProcess();
+    onePerPass = onePerPass && hostUsbSysEx - usb == (p < TRAFFIC_PORTS ? p : TRAFFIC_PORTS);
+  }
+  hostCheck("CC counts sent over USB, one port per pass", onePerPass);
+
+  uint32_t hostOut = midiTraffic[TRAFFIC_HOST_OUT].msgs;
+  midi1.receiveSysEx(query, sizeof(query));
+  hostRun(10000);
+  hostCheck("replies to the USB host counted", midiTraffic[TRAFFIC_HOST_OUT].msgs - hostOut == TRAFFIC_PORTS);
+}
+
+int main(int argc, char **argv) {
+  const char *eepromFile = "eeprom.bin";
+  const char *scenarios[8];
+  int count = 0;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--sd") == 0 && i + 1 < argc) {
+      hostSetSdRoot(argv[++i]);
+    } else if (strcmp(argv[i], "--eeprom") == 0 && i + 1 < argc) {
+      eepromFile = argv[++i];
+    } else if (strcmp(argv[i], "--midi-log") == 0 && i + 1 < argc) {
+      const char *path = argv[++i];
+      hostSetMidiLog(strcmp(path, "-") == 0 ? stdout : fopen(path, "w"));
+    } else if (count < 8) {
+      scenarios[count++] = argv[i];
+    }
+  }
+  hostSetEepromFile(eepromFile);
+  hostSetupFirmware();
+
+  bool all = count == 0;
+  auto run = [&](const char *name) {
+    if (all) return true;
+    for (int i = 0; i < count; i++) {
+      if (strcmp(scenarios[i], name) == 0) return true;
+    }
+    return false;
+  };
+  if (run("settings")) scenarioSettings(eepromFile);
+  if (run("patches")) scenarioPatches();
+  if (run("sweep")) scenarioSweep();
+  if (run("session")) scenarioSession();
+  if (run("load")) scenarioLoad();
+  if (run("latency")) scenarioLatency();
+  if (run("dispatch")) scenarioDispatch();
+  if (run("glyphs")) scenarioGlyphs();
+  if (run("panelio")) scenarioPanelIO();
+  if (run("panel")) scenarioPanel();
+  if (run("echo")) scenarioEcho();
+  if (run("loopback")) scenarioLoopback();
+  if (run("traffic")) scenarioTraffic();
+  profileCommand('p');
+  Serial.printf("%d failed\n", hostFailures);
+  return hostFailures ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+// Shared by the MIDI port stand-ins, MIDI.h (DIN), usb_midi.h (usbMIDI) and
+// USBHost_t36.h (midi1)
+//
+// What the simulation has a port receive is queued and handed to the
+// handlers by read(), one message per call, as the libraries do for what has
+// arrived on the wire. What the firmware sends is logged with the time it was
+// sent (HostHAL.h), a DIN port also writes it to its serial port, which models
+// the transmit backlog.
+
+#pragma once
+
+#include <Arduino.h>
+#include <deque>
+#include <vector>
+
+namespace midi {
+
+enum MidiType : uint8_t {
+  InvalidType = 0x00,
+  NoteOff = 0x80,
+  NoteOn = 0x90,
+  AfterTouchPoly = 0xA0,
+  ControlChange = 0xB0,
+  ProgramChange = 0xC0,
+  AfterTouchChannel = 0xD0,
+  PitchBend = 0xE0,
+  SystemExclusive = 0xF0
+};
+
+}
+
+struct HostMidiMessage {
+  uint8_t type;
+  uint8_t channel;
+  uint8_t data1;
+  uint8_t data2;
+  std::vector<uint8_t> sysex;  //F0 .. F7
+};
+
+class HostMidiPort {
+public:
+  HostMidiPort(const char *name = nullptr)
+    : _name(name) {}
+  virtual ~HostMidiPort() {}
+
+  virtual const char *name() const {
+    return _name;
+  }
+
+  //Simulation side, a message arriving on this port
+  void receive(uint8_t type, uint8_t channel, uint8_t data1, uint8_t data2) {
+    _in.push_back({ type, channel, data1, data2, {} });
+  }
+  void receiveSysEx(const uint8_t *data, unsigned length) {
+    _in.push_back({ midi::SystemExclusive, 0, 0, 0, std::vector<uint8_t>(data, data + length) });
+  }
+  size_t received() const {
+    return _in.size();
+  }
+
+  void send(uint8_t type, uint8_t data1, uint8_t data2, uint8_t channel) {
+    uint8_t bytes[3] = { (uint8_t)((type & 0xF0) | ((channel - 1) & 15)), (uint8_t)(data1 & 0x7F), (uint8_t)(data2 & 0x7F) };
+    sent(bytes, type == midi::ProgramChange || type == midi::AfterTouchChannel ? 2 : 3);
+  }
+  void sendNoteOn(uint8_t note, uint8_t velocity, uint8_t channel) {
+    send(midi::NoteOn, note, velocity, channel);
+  }
+  void sendNoteOff(uint8_t note, uint8_t velocity, uint8_t channel) {
+    send(midi::NoteOff, note, velocity, channel);
+  }
+  void sendControlChange(uint8_t cc, uint8_t value, uint8_t channel) {
+    send(midi::ControlChange, cc, value, channel);
+  }
+  void sendProgramChange(uint8_t program, uint8_t channel) {
+    send(midi::ProgramChange, program, 0, channel);
+  }
+  void sendAfterTouch(uint8_t pressure, uint8_t channel) {
+    send(midi::AfterTouchChannel, pressure, 0, channel);
+  }
+  void sendPitchBend(int bend, uint8_t channel) {
+    unsigned value = bend + 8192;
+    send(midi::PitchBend, value & 0x7F, (value >> 7) & 0x7F, channel);
+  }
+  void sendSysEx(unsigned length, const uint8_t *data, bool hasTerm = false) {
+    std::vector<uint8_t> bytes;
+    if (!hasTerm) bytes.push_back(0xF0);
+    bytes.insert(bytes.end(), data, data + length);
+    if (!hasTerm) bytes.push_back(0xF7);
+    sent(bytes.data(), bytes.size());
+  }
+
+  //The handler names of all three libraries
+  void setHandleNoteOn(void (*f)(uint8_t, uint8_t, uint8_t)) {
+    _noteOn = f;
+  }
+  void setHandleNoteOff(void (*f)(uint8_t, uint8_t, uint8_t)) {
+    _noteOff = f;
+  }
+  void setHandleControlChange(void (*f)(uint8_t, uint8_t, uint8_t)) {
+    _controlChange = f;
+  }
+  void setHandleProgramChange(void (*f)(uint8_t, uint8_t)) {
+    _programChange = f;
+  }
+  void setHandleAfterTouchChannel(void (*f)(uint8_t, uint8_t)) {
+    _afterTouch = f;
+  }
+  void setHandleAfterTouch(void (*f)(uint8_t, uint8_t)) {
+    _afterTouch = f;
+  }
+  void setHandlePitchBend(void (*f)(uint8_t, int)) {
+    _pitchBend = f;
+  }
+  void setHandlePitchChange(void (*f)(uint8_t, int)) {
+    _pitchBend = f;
+  }
+  void setHandleSystemExclusive(void (*f)(uint8_t *, unsigned)) {
+    _sysEx = f;
+  }
+  void setHandleSystemExclusive(void (*f)(const uint8_t *, uint16_t, bool)) {
+    _sysExUsb = f;
+  }
+
+  bool read(uint8_t channel = 0) {
+    if (_in.empty()) return false;
+    HostMidiMessage m = _in.front();
+    _in.pop_front();
+    if (m.type != midi::SystemExclusive && channel != 0 && m.channel != channel) return false;
+    switch (m.type) {
+      case midi::NoteOn:
+        if (_noteOn) _noteOn(m.channel, m.data1, m.data2);
+        break;
+      case midi::NoteOff:
+        if (_noteOff) _noteOff(m.channel, m.data1, m.data2);
+        break;
+      case midi::ControlChange:
+        if (_controlChange) _controlChange(m.channel, m.data1, m.data2);
+        break;
+      case midi::ProgramChange:
+        if (_programChange) _programChange(m.channel, m.data1);
+        break;
+      case midi::AfterTouchChannel:
+        if (_afterTouch) _afterTouch(m.channel, m.data1);
+        break;
+      case midi::PitchBend:
+        if (_pitchBend) _pitchBend(m.channel, (m.data1 | (m.data2 << 7)) - 8192);
+        break;
+      case midi::SystemExclusive:
+        if (_sysEx) _sysEx(m.sysex.data(), m.sysex.size());
+        if (_sysExUsb) _sysExUsb(m.sysex.data(), m.sysex.size(), true);
+        break;
+    }
+    return true;
+  }
+
+protected:
+  //Bytes on their way out, logged once this returns
+  virtual void write(const uint8_t *bytes, unsigned length) {}
+
+private:
+  void sent(const uint8_t *bytes, unsigned length) {
+    write(bytes, length);
+    hostMidiLog(name(), bytes, length);
+  }
+
+  const char *_name;
+  std::deque<HostMidiMessage> _in;
+  void (*_noteOn)(uint8_t, uint8_t, uint8_t) = nullptr;
+  void (*_noteOff)(uint8_t, uint8_t, uint8_t) = nullptr;
+  void (*_controlChange)(uint8_t, uint8_t, uint8_t) = nullptr;
+  void (*_programChange)(uint8_t, uint8_t) = nullptr;
+  void (*_afterTouch)(uint8_t, uint8_t) = nullptr;
+  void (*_pitchBend)(uint8_t, int) = nullptr;
+  void (*_sysEx)(uint8_t *, unsigned) = nullptr;
+  void (*_sysExUsb)(const uint8_t *, uint16_t, bool) = nullptr;
+};
@@ -0,0 +1,56 @@
+// Stand-in for the Arduino MIDI library on a DIN serial port
+//
+// Messages go out through the serial port's transmit model, so a full buffer
+// blocks as it does on the Teensy (HostMidi.h for the rest).
+
+#pragma once
+
+#include "HostMidi.h"
+
+#define MIDI_CHANNEL_OMNI 0
+#define MIDI_CHANNEL_OFF 17
+
+namespace midi {
+
+namespace Thru {
+enum Mode { Off, Full, SameChannel, DifferentChannel };
+}
+
+template<class SerialPort>
+class MidiInterface : public HostMidiPort {
+public:
+  //The serial port may not be constructed yet, its name is asked for when logging
+  MidiInterface(SerialPort &port)
+    : _port(port) {}
+
+  const char *name() const override {
+    return _port.name();
+  }
+
+  void begin(int channel = 1) {
+    _channel = channel;
+    _port.begin(31250);
+  }
+  void turnThruOff() {}
+  void setThruFilterMode(Thru::Mode) {}
+
+  bool read() {
+    return HostMidiPort::read(_channel);
+  }
+  bool read(uint8_t channel) {
+    return HostMidiPort::read(channel);
+  }
+
+protected:
+  void write(const uint8_t *bytes, unsigned length) override {
+    _port.write(bytes, length);
+  }
+
+private:
+  SerialPort &_port;
+  uint8_t _channel = 1;
+};
+
+}
+
+#define MIDI_CREATE_INSTANCE(Type, SerialPort, Name) midi::MidiInterface<Type> Name(SerialPort);
@@ -0,0 +1,51 @@
+// Stand-in for the Teensy SD library, backed by a host directory
+//
+// Paths are relative to the directory set with hostSetSdRoot(). Only the
+// root directory is listed, as loadPatches() needs.
+
+#pragma once
+
+#include <Arduino.h>
+#include <memory>
+
+#define FILE_READ 0
+#define FILE_WRITE 1
+#define BUILTIN_SDCARD 254
+
+struct HostFile;
+
+class File : public Stream {
+public:
+  File() {}
+  File(std::shared_ptr<HostFile> f)
+    : _f(f) {}
+  operator bool() const {
+    return (bool)_f;
+  }
+  const char *name();
+  bool isDirectory();
+  File openNextFile();
+  int available() override;
+  int read() override;
+  int peek() override;
+  int read(void *buf, size_t size);
+  size_t write(uint8_t b) override;
+  size_t write(const uint8_t *buf, size_t size) override;
+  size_t size();
+  uint32_t position();
+  bool seek(uint32_t pos);
+  void close();
+
+private:
+  std::shared_ptr<HostFile> _f;
+};
+
+class SDClass {
+public:
+  bool begin(uint8_t);
+  File open(const char *path, uint8_t mode = FILE_READ);
+  bool exists(const char *path);
+  bool remove(const char *path);
+};
+
+extern SDClass SD;
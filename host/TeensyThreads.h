@@ -0,0 +1,55 @@
+// Stand-in for TeensyThreads
+//
+// There is one thread on the host. A thread added is not started,
+// threads.delay() blocks on the virtual clock like delay().
+
+#pragma once
+
+#include <Arduino.h>
+
+class Threads {
+public:
+  typedef void (*ThreadFunction)(void *);
+  typedef void (*ThreadFunctionNone)();
+
+  int addThread(ThreadFunctionNone, int = 0, int = -1, void * = nullptr) {
+    return ++_threads;
+  }
+  int addThread(ThreadFunction, void * = nullptr, int = -1, void * = nullptr) {
+    return ++_threads;
+  }
+  void delay(int ms) {
+    ::delay(ms);
+  }
+  void yield() {}
+  int suspend(int) {
+    return 1;
+  }
+  int restart(int) {
+    return 1;
+  }
+  int id() {
+    return 0;
+  }
+  int setTimeSlice(int, unsigned) {
+    return 1;
+  }
+
+  class Mutex {
+  public:
+    int lock(unsigned = 0) {
+      return 1;
+    }
+    int try_lock() {
+      return 1;
+    }
+    int unlock() {
+      return 1;
+    }
+  };
+
+private:
+  int _threads = 0;
+};
+
+extern Threads threads;
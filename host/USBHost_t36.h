@@ -0,0 +1,27 @@
+// Stand-in for the USB host library, a MIDI device plugged into the USB host
+// port (HostMidi.h). Nothing is ever enumerated, Task() does nothing.
+
+#pragma once
+
+#include "HostMidi.h"
+
+class USBHost {
+public:
+  void begin() {}
+  void Task() {}
+};
+
+class USBHub {
+public:
+  USBHub(USBHost &) {}
+};
+
+class MIDIDevice : public HostMidiPort {
+public:
+  MIDIDevice(USBHost &)
+    : HostMidiPort("host") {}
+
+  void sendSysEx(uint32_t length, const uint8_t *data, bool hasTerm = false, uint8_t cable = 0) {
+    HostMidiPort::sendSysEx(length, data, hasTerm);
+  }
+};
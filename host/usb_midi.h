@@ -0,0 +1,25 @@
+// Stand-in for the Teensy core's usbMIDI, the USB device port to the computer
+//
+// send_now() is counted as one USB transaction (HostMidi.h for the rest).
+
+#pragma once
+
+#include "HostMidi.h"
+
+class usb_midi_class : public HostMidiPort {
+public:
+  usb_midi_class()
+    : HostMidiPort("usb") {}
+
+  using HostMidiPort::send;
+  void send(uint8_t type, uint8_t data1, uint8_t data2, uint8_t channel, uint8_t cable) {
+    send(type, data1, data2, channel);
+  }
+  void send_now() {
+    transactions++;
+  }
+
+  uint32_t transactions = 0;
+};
+
+extern usb_midi_class usbMIDI;
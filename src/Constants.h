@@ -1,27 +1,55 @@
 const char* VERSION = "V1.2";
-const float MEMORYMODEFREQ3[128] = {-30.04, -29.56, -29.09, -28.62, -28.15, -27.67, -27.20, -26.73, -26.25, -25.78, -25.31, -24.83, -24.36, -23.89, -23.42, -22.94, -22.47, -22.00, -21.52, -21.05, -20.58, -20.10, -19.63, -19.16, -18.68, -18.21, -17.74, -17.27, -16.79, -16.32, -15.85, -15.37, -14.90, -14.43, -13.95, -13.48, -13.01, -12.54, -12.06, -11.59, -11.12, -10.64, -10.17, -9.70, -9.22, -8.75, -8.28, -7.81, -7.33, -6.86, -6.39, -5.91, -5.44, -4.97, -4.49, -4.02, -3.55, -3.07, -2.60, -2.13, -1.66, -1.18, -0.71, -0.24, 0.24, 0.71, 1.18, 1.66, 2.13, 2.60, 3.07, 3.55, 4.02, 4.49, 4.97, 5.44, 5.91, 6.39, 6.86, 7.33, 7.81, 8.28, 8.75, 9.22, 9.70, 10.17, 10.64, 11.12, 11.59, 12.06, 12.54, 13.01, 13.48, 13.95, 14.43, 14.90, 15.37, 15.85, 16.32, 16.79, 17.27, 17.74, 18.21, 18.68, 19.16, 19.63, 20.10, 20.58, 21.05, 21.52, 22.00, 22.47, 22.94, 23.42, 23.89, 24.36, 24.83, 25.31, 25.78, 26.25, 26.73, 27.20, 27.67, 28.15, 28.62, 29.09, 29.56, 30.04};
-const float MEMORYMODE100LOG[128] = {0.00, 0.00, 0.00, 0.1, 0.1, 0.2, 0.2, 0.3, 0.4, 0.5, 0.6, 0.8, 0.9, 1.0, 1.2, 1.4, 1.6, 1.8, 2.0, 2.2, 2.5, 2.7, 3.0, 3.3, 3.6, 3.9, 4.2, 4.5, 4.9, 5.2, 5.6, 6.0, 6.3, 6.8, 7.2, 7.6, 8.0, 8.5, 9.0, 9.4, 9.9, 10.04, 10.9, 11.5, 12.0, 12.6, 13.1, 13.7, 14.3, 14.9, 15.5, 16.1, 16.8, 17.4, 18.1, 18.8, 19.4, 20.1, 20.9, 21.6, 22.3, 23.1, 23.8, 24.6, 25.4, 26.2, 27.0, 27.8, 28.7, 29.5, 30.4, 31.3, 32.1, 33.0, 34.0, 34.9, 35.8, 36.8, 37.7, 38.7, 39.7, 40.7, 41.7, 42.7, 43.7, 44.8, 45.9, 46.9, 48.0, 49.1, 50.2, 51.3, 52.5, 53.6, 54.8, 56.0, 57.1, 58.3, 59.5, 60.8, 62.0, 63.2, 64.5, 65.8, 67.1, 68.4, 69.7, 71.0, 72.3, 73.7, 75.0, 76.4, 77.8, 79.2, 80.6, 82.0, 83.4, 84.9, 86.3, 87.8, 89.3, 90.8, 92.3, 93.8, 95.3, 96.9, 98.4, 100.0};
-const float MEMORYMODE100[128] = {0.00, 0.8, 1.6, 2.4, 3.1, 3.9, 4.7, 5.5, 6.3, 7.1, 7.9, 8.7, 9.4, 10.2, 11.0, 11.8, 12.6, 13.4, 14.2, 15.0, 15.7, 16.5, 17.3, 18.1, 18.9, 19.7, 20.5, 21.3, 22.0, 22.8, 23.6, 24.4, 25.2, 26.0, 26.8, 27.6, 28.3, 29.1, 29.9, 30.7, 31.5, 32.3, 33.1, 33.9, 34.6, 35.4, 36.2, 37.0, 37.8, 38.6, 39.4, 40.2, 40.9, 41.7, 42.5, 43.3, 44.1, 44.9, 45.7, 46.5, 47.2, 48.0, 48.8, 49.6, 50.4, 51.2, 52.0, 52.8, 53.5, 54.3, 55.1, 55.9, 56.7, 57.5, 58.3, 59.1, 59.8, 60.6, 61.4, 62.2, 63.0, 63.8, 64.6, 65.4, 66.1, 66.9, 67.7, 68.5, 69.3, 70.1, 70.9, 71.7, 72.4, 73.2, 74.0, 74.8, 75.6, 76.4, 77.2, 78.0, 78.7, 79.5, 80.3, 81.1, 81.9, 82.7, 83.5, 84.3, 85.0, 85.8, 86.6, 87.4, 88.2, 89.0, 89.8, 90.6, 91.3, 92.1, 92.9, 93.7, 94.5, 95.3, 96.1, 96.9, 97.6, 98.4, 99.2, 100.0};
-const float MEMORYMODE200[128] = {0.00, 0.01, 0.05, 0.11, 0.20, 0.31, 0.45, 0.61, 0.79, 1.00, 1.24, 1.50, 1.79, 2.10, 2.43, 2.79, 3.17, 3.58, 4.02, 4.48, 4.96, 5.47, 6.00, 6.56, 7.14, 7.75, 8.38, 9.04, 9.72, 10.43, 11.16, 11.92, 12.70, 13.50, 14.33, 15.19, 16.07, 16.98, 17.91, 18.86, 19.84, 20.84, 21.87, 22.93, 24.01, 25.11, 26.24, 27.39, 28.57, 29.77, 31.0, 32.25, 33.53, 34.83, 36.16, 37.51, 38.89, 40.29, 41.71, 43.16, 44.64, 46.14, 47.67, 49.22, 50.79, 52.39, 54.01, 55.66, 57.34, 59.04, 60.76, 62.51, 64.28, 66.08, 67.90, 69.75, 71.62, 73.52, 75.44, 77.39, 79.36, 81.36, 83.38, 85.42, 87.49, 89.59, 91.71, 93.86, 96.03, 98.22, 100.44, 102.68, 104.95, 107.25, 109.57, 111.91, 114.28, 116.67, 119.09, 121.53, 124.00, 126.49, 129.01, 131.55, 134.12, 136.71, 139.33, 141.97, 144.63, 147.32, 150.04, 152.78, 155.55, 158.34, 161.15, 163.99, 166.85, 169.74, 172.66, 175.60, 178.56, 181.55, 184.56, 187.60, 190.66, 193.75, 196.86, 200.00};
-const float MEMORYMODEFREQ2[128] = {-8.01, -7.88, -7.76, -7.63, -7.51, -7.38, -7.25, -7.13, -7.00, -6.87, -6.75, -6.62, -6.50, -6.37, -6.24, -6.12, -5.99, -5.87, -5.74, -5.61, -5.49, -5.36, -5.23, -5.11, -4.98, -4.86, -4.73, -4.60, -4.48, -4.35, -4.23, -4.10, -3.97, -3.85, -3.72, -3.60, -3.47, -3.34, -3.22, -3.09, -2.96, -2.84, -2.71, -2.59, -2.46, -2.33, -2.21, -2.08, -1.96, -1.83, -1.70, -1.58, -1.45, -1.32, -1.20, -1.07, -0.95, -0.82, -0.69, -0.57, -0.44, -0.32, -0.19, -0.06, 0.06, 0.19, 0.32, 0.44, 0.57, 0.69, 0.82, 0.95, 1.07, 1.20, 1.32, 1.45, 1.58, 1.70, 1.83, 1.96, 2.08, 2.21, 2.33, 2.46, 2.59, 2.71, 2.84, 2.96, 3.09, 3.22, 3.34, 3.47, 3.60, 3.72, 3.85, 3.97, 4.10, 4.23, 4.35, 4.48, 4.60, 4.73, 4.86, 4.98, 5.11, 5.23, 5.36, 5.49, 5.61, 5.74, 5.87, 5.99, 6.12, 6.24, 6.37, 6.50, 6.62, 6.75, 6.87, 7.00, 7.13, 7.25, 7.38, 7.51, 7.63, 7.76, 7.88, 8.01};
-const float MEMORYMODETUNE[128] = {-5.01, -4.93, -4.85, -4.77, -4.69, -4.62, -4.54, -4.46, -4.38, -4.30, -4.22, -4.14, -4.06, -3.98, -3.91, -3.83, -3.75, -3.67, -3.59, -3.51, -3.43, -3.35, -3.27, -3.20, -3.12, -3.04, -2.96, -2.88, -2.80, -2.72, -2.64, -2.56, -2.49, -2.41, -2.33, -2.25, -2.17, -2.09, -2.01, -1.93, -1.85, -1.78, -1.70, -1.62, -1.54, -1.46, -1.38, -1.30, -1.22, -1.14, -1.07, -0.99, -0.91, -0.83, -0.75, -0.67, -0.59, -0.51, -0.43, -0.36, -0.28, -0.20, -0.12, -0.04, 0.04, 0.12, 0.20, 0.28, 0.36, 0.43, 0.51, 0.59, 0.67, 0.75, 0.83, 0.91, 0.99, 1.07, 1.14, 1.22, 1.30, 1.38, 1.46, 1.54, 1.62, 1.70, 1.78, 1.85, 1.93, 2.01, 2.09, 2.17, 2.25, 2.33, 2.41, 2.49, 2.56, 2.64, 2.72, 2.80, 2.88, 2.96, 3.04, 3.12, 3.20, 3.27, 3.35, 3.43, 3.51, 3.59, 3.67, 3.75, 3.83, 3.91, 3.98, 4.06, 4.14, 4.22, 4.30, 4.38, 4.46, 4.54, 4.62, 4.69, 4.77, 4.85, 4.93, 5.01};
-const float MEMORYMODEATTACK[128] = {1.00, 1.00, 1.01, 1.04, 1.10, 1.21, 1.38, 1.64, 1.99, 2.47, 3.09, 3.87, 4.84, 6.02, 7.42, 9.08, 11.02, 13.27, 15.84, 18.77, 22.09, 25.81, 29.97, 34.60, 39.72, 45.37, 51.57, 58.34, 65.73, 73.77, 82.47, 91.88, 102.03, 112.94, 124.65, 137.20, 150.61, 164.91, 180.15, 196.36, 213.56, 231.79, 251.10, 271.50, 293.05, 315.76, 339.69, 364.86, 391.31, 419.08, 448.21, 478.73, 510.67, 544.08, 578.99, 615.45, 653.49, 693.14, 734.45, 777.46, 822.20, 868.71, 917.04, 967.23, 1019.30, 1073.31, 1129.30, 1187.30, 1247.35, 1309.50, 1373.79, 1440.26, 1508.95, 1579.90, 1653.15, 1728.75, 1806.74, 1887.17, 1970.06, 2055.48, 2143.45, 2234.03, 2327.25, 2423.17, 2521.82, 2623.25, 2727.50, 2834.62, 2944.65, 3057.64, 3173.63, 3292.66, 3414.79, 3540.06, 3668.50, 3800.18, 3935.13, 4073.40, 4215.03, 4360.08, 4508.59, 4660.60, 4816.17, 4975.33, 5138.15, 5304.65, 5474.90, 5648.94, 5826.81, 6008.57, 6194.27, 6383.94, 6577.64, 6775.42, 6977.33, 7183.41, 7393.72, 7608.30, 7827.20, 8050.47, 8278.17, 8510.33, 8747.02, 8988.27, 9234.15, 9484.69, 9739.96, 10000.00};
-const float MEMORYMODEDECAY[128] = {2.00, 2.00, 2.02, 2.08, 2.20, 2.42, 2.76, 3.27, 3.99, 4.95, 6.18, 7.75, 9.68, 12.03, 14.85, 18.17, 22.05, 26.54, 31.69, 37.55, 44.18, 51.63, 59.95, 69.20, 79.45, 90.94, 103.13, 116.68, 131.47, 147.54, 164.95, 183.77, 204.06, 225.88, 249.31, 274.40, 301.21, 329.83, 360.30, 392.71, 427.12, 463.59, 502.19, 543.01, 586.09, 631.53, 679.38, 729.72, 782.63, 838.17, 896.42, 957.45, 1021.34, 1088.16, 1157.99, 1230.90, 1306.97, 1386.28, 1468.90, 1554.91, 1644.40, 1737.43, 1834.09, 1934.45, 2038.61, 2146.63, 2258.60, 2374.59, 2494.70, 2619.00, 2747.58, 2880.52, 3017.89, 3159.79, 3306.30, 3457.51, 3613.49, 3774.33, 3940.13, 4110.95, 4286.90, 4468.06, 4654.51, 4846.34, 5043.64, 5246.50, 5455.00, 5669.24, 5889.30, 6115.28, 6347.26, 6585.33, 6829.58, 7080.11, 7337.00, 7600.35, 7870.25, 8146.79, 8430.06, 8720.16, 9017.17, 9321.20, 9632.34, 9950.67, 10276.29, 10609.31, 10949.80, 11297.88, 11653.63, 12017.15, 12388.53, 12767.88, 13155.29, 13550.85, 13954.66, 14366.82, 14787.44, 15216.59, 15654.40, 16100.94, 16556.33, 17020.66, 17494.03, 17976.54, 18468.30, 18969.39, 19479.92, 20000.00};
-const float MEMORYMODERELEASE[128] = {2.00, 2.00, 2.02, 2.08, 2.20, 2.42, 2.76, 3.27, 3.99, 4.95, 6.18, 7.75, 9.68, 12.03, 14.85, 18.17, 22.05, 26.54, 31.69, 37.55, 44.18, 51.63, 59.95, 69.20, 79.45, 90.94, 103.13, 116.68, 131.47, 147.54, 164.95, 183.77, 204.06, 225.88, 249.31, 274.40, 301.21, 329.83, 360.30, 392.71, 427.12, 463.59, 502.19, 543.01, 586.09, 631.53, 679.38, 729.72, 782.63, 838.17, 896.42, 957.45, 1021.34, 1088.16, 1157.99, 1230.90, 1306.97, 1386.28, 1468.90, 1554.91, 1644.40, 1737.43, 1834.09, 1934.45, 2038.61, 2146.63, 2258.60, 2374.59, 2494.70, 2619.00, 2747.58, 2880.52, 3017.89, 3159.79, 3306.30, 3457.51, 3613.49, 3774.33, 3940.13, 4110.95, 4286.90, 4468.06, 4654.51, 4846.34, 5043.64, 5246.50, 5455.00, 5669.24, 5889.30, 6115.28, 6347.26, 6585.33, 6829.58, 7080.11, 7337.00, 7600.35, 7870.25, 8146.79, 8430.06, 8720.16, 9017.17, 9321.20, 9632.34, 9950.67, 10276.29, 10609.31, 10949.80, 11297.88, 11653.63, 12017.15, 12388.53, 12767.88, 13155.29, 13550.85, 13954.66, 14366.82, 14787.44, 15216.59, 15654.40, 16100.94, 16556.33, 17020.66, 17494.03, 17976.54, 18468.30, 18969.39, 19479.92, 20000.00};
-const float MEMORYMODECUTOFF[128] = {20.00, 20.00, 20.00, 20.00, 20.00, 20.00, 20.01, 20.01, 20.02, 20.04, 20.07, 20.12, 20.18, 20.27, 20.39, 20.55, 20.76, 21.03, 21.37, 21.80, 22.32, 22.96, 23.74, 24.67, 25.78, 27.09, 28.62, 30.41, 32.49, 34.89, 37.64, 40.78, 44.35, 48.41, 52.98, 58.12, 63.89, 70.33, 77.51, 85.49, 94.32, 104.09, 114.86, 126.70, 139.70, 153.93, 169.49, 186.46, 204.94, 225.03, 246.82, 270.43, 295.96, 323.54, 353.27, 385.30, 419.73, 456.72, 496.40, 538.91, 584.40, 633.03, 684.95, 740.33, 799.35, 862.17, 928.97, 999.95, 1075.30, 1155.21, 1239.89, 1329.55, 1424.41, 1524.68, 1630.61, 1742.41, 1860.34, 1984.65, 2115.58, 2253.40, 2398.38, 2550.79, 2710.91, 2879.05, 3055.48, 3240.51, 3434.47, 3637.65, 3850.40, 4073.04, 4305.91, 4549.37, 4803.76, 5069.46, 5346.84, 5636.28, 5938.16, 6252.89, 6580.86, 6922.50, 7278.23, 7648.47, 8033.67, 8434.27, 8850.74, 9283.54, 9733.15, 10200.04, 10684.72, 11187.68, 11709.45, 12250.54, 12811.48, 13392.81, 13995.10, 14618.89, 15264.76, 15933.29, 16625.07, 17340.70, 18080.79, 18845.97, 19636.87, 20454.13, 21298.40, 22170.35, 23070.66, 24000.00};
-const float MEMORYMODEPORT[128] = {0.00, 0.06, 0.25, 0.56, 0.99, 1.55, 2.23, 3.04, 3.97, 5.02, 6.20, 7.50, 8.93, 10.48, 12.15, 13.95, 15.87, 17.92, 20.09, 22.38, 24.80, 27.34, 30.01, 32.80, 35.71, 38.75, 41.91, 45.20, 48.61, 52.14, 55.80, 59.58, 63.49, 67.52, 71.67, 75.95, 80.35, 84.88, 89.53, 94.30, 99.20, 104.22, 109.37, 114.64, 120.03, 125.55, 131.19, 136.96, 142.85, 148.86, 155.00, 161.26, 167.65, 174.16, 180.79, 187.55, 194.43, 201.44, 208.57, 215.82, 223.20, 230.70, 238.33, 246.08, 253.95, 261.95, 270.07, 278.32, 286.69, 295.18, 303.80, 312.54, 321.41, 330.40, 339.51, 348.75, 358.11, 367.60, 377.21, 386.94, 396.80, 406.78, 416.89, 427.12, 437.47, 447.95, 458.55, 469.28, 480.13, 491.10, 502.20, 513.42, 524.77, 536.24, 547.83, 559.55, 571.39, 583.36, 595.45, 607.66, 620.00, 632.46, 645.05, 657.78, 670.59, 683.55, 696.63, 709.84, 723.17, 736.62, 750.20, 763.90, 777.73, 791.68, 805.75, 819.95, 834.27, 848.72, 863.29, 877.98, 892.80, 907.74, 922.81, 938.00, 953.31, 968.75, 984.31, 1000.00};
-const float MEMORYMODEINITPW[128] = {0.00, 0.80, 1.60, 2.40, 3.10, 3.90, 4.70, 5.50, 6.30, 7.10, 7.80, 8.60, 9.40, 10.20, 11.00, 11.80, 12.50, 13.30, 14.10, 14.90, 15.70, 16.50, 17.20, 18.00, 18.80, 19.60, 20.40, 21.20, 21.90, 22.70, 23.50, 24.30, 25.10, 25.90, 26.60, 27.40, 28.20, 29.00, 29.80, 30.60, 31.30, 32.10, 32.90, 33.70, 34.50, 35.30, 36.00, 36.80, 37.60, 38.40, 39.20, 40.00, 40.70, 41.50, 42.30, 43.10, 43.90, 44.70, 45.40, 46.20, 47.00, 47.80, 48.60, 49.40, 50.10, 50.90, 51.70, 52.50, 53.30, 54.10, 54.80, 55.60, 56.40, 57.20, 58.00, 58.80, 59.50, 60.30, 61.10, 61.90, 62.70, 63.50, 64.20, 65.00, 65.80, 66.60, 67.40, 68.20, 68.90, 69.70, 70.50, 71.30, 72.10, 72.90, 73.60, 74.40, 75.20, 76.00, 76.80, 77.60, 78.30, 79.10, 79.90, 80.70, 81.50, 82.30, 83.00, 83.80, 84.60, 85.40, 86.20, 87.00, 87.70, 88.50, 89.30, 90.10, 90.90, 91.70, 92.40, 93.20, 94.00, 94.80, 95.60, 96.40, 97.10, 97.90, 98.70, 99.50};
-const float MEMORYMODEPHASERRATE[128] = {0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.02, 0.02, 0.02, 0.02, 0.02, 0.02, 0.02, 0.03, 0.03, 0.03, 0.03, 0.04, 0.04, 0.04, 0.05, 0.05, 0.06, 0.06, 0.07, 0.07, 0.08, 0.09, 0.10, 0.10, 0.11, 0.12, 0.13, 0.15, 0.16, 0.17, 0.19, 0.20, 0.22, 0.23, 0.25, 0.27, 0.29, 0.32, 0.34, 0.36, 0.39, 0.42, 0.45, 0.48, 0.51, 0.55, 0.58, 0.62, 0.66, 0.71, 0.75, 0.80, 0.85, 0.90, 0.96, 1.02, 1.08, 1.14, 1.21, 1.28, 1.35, 1.42, 1.50, 1.59, 1.67, 1.76, 1.86, 1.96, 2.06, 2.17, 2.28, 2.39, 2.51, 2.64, 2.77, 2.90, 3.04, 3.19, 3.34, 3.50, 3.66, 3.83, 4.01, 4.19, 4.38, 4.57, 4.77, 4.98, 5.20, 5.42, 5.65, 5.89, 6.14, 6.39, 6.66, 6.93, 7.21, 7.50};
-const float MEMORYMODEECHOTIME[128] = {1, 1.12, 1.5, 2.12, 2.98, 4.1, 5.46, 7.07, 8.93, 11.04, 13.39, 16, 18.85, 21.95, 25.29, 28.89, 32.73, 36.83, 41.16, 45.74, 50.58, 55.66, 60.99, 66.56, 72.39, 78.46, 84.78, 91.35, 98.17, 105.23, 112.54, 120.10, 127.91, 135.97, 144.27, 152.82, 161.62, 170.67, 179.97, 189.51, 199.30, 209.34, 219.63, 230.16, 240.94, 251.97, 263.25, 274.78, 286.55, 298.58, 310.85, 323.36, 336.13, 349.14, 362.40, 375.91, 389.67, 403.68, 417.93, 432.43, 447.18, 462.17, 477.42, 492.91, 508.65, 524.64, 540.88, 557.36, 574.09, 591.07, 608.30, 625.77, 643.50, 661.47, 679.69, 698.15, 716.87, 735.83, 755.04, 774.50, 794.20, 814.16, 834.36, 854.81, 875.51, 896.45, 917.65, 939.09, 960.78, 982.71, 1004.90, 1027.33, 1050.01, 1072.94, 1096.12, 1119.54, 1143.21, 1167.13, 1191.30, 1215.72, 1240.38, 1265.29, 1290.45, 1315.86, 1341.52, 1367.42, 1393.57, 1419.97, 1446.62, 1473.51, 1500.65, 1528.04, 1555.68, 1583.57, 1611.7, 1640.08, 1668.71, 1697.59, 1726.72, 1756.09, 1785.71, 1815.58, 1845.7, 1876.06, 1906.67, 1937.54, 1968.64, 2000};
-const float MEMORYMODEARPRATE[128] = {0.25, 0.25, 0.25, 0.25, 0.25, 0.25, 0.25, 0.25, 0.25, 0.25, 0.26, 0.26, 0.26, 0.26, 0.27, 0.27, 0.28, 0.29, 0.29, 0.30, 0.31, 0.32, 0.34, 0.35, 0.37, 0.38, 0.40, 0.42, 0.44, 0.47, 0.49, 0.52, 0.55, 0.58, 0.62, 0.66, 0.70, 0.74, 0.78, 0.83, 0.88, 0.94, 0.99, 1.05, 1.12, 1.19, 1.26, 1.33, 1.41, 1.49, 1.58, 1.67, 1.77, 1.87, 1.97, 2.08, 2.19, 2.31, 2.43, 2.56, 2.69, 2.83, 2.98, 3.12, 3.28, 3.44, 3.61, 3.78, 3.96, 4.14, 4.33, 4.53, 4.74, 4.95, 5.17, 5.39, 5.62, 5.86, 6.11, 6.36, 6.62, 6.89, 7.17, 7.46, 7.75, 8.05, 8.36, 8.68, 9.01, 9.34, 9.69, 10.04, 10.41, 10.78, 11.16, 11.55, 11.96, 12.37, 12.79, 13.22, 13.66, 14.11, 14.58, 15.05, 15.53, 16.03, 16.54, 17.05, 17.58, 18.12, 18.68, 19.24, 19.82, 20.41, 21.01, 21.62, 22.25, 22.88, 23.54, 24.20, 24.88, 25.57, 26.27, 26.99, 27.72, 28.47, 29.23, 30.00};
-const float MEMORYMODELFORATE[128] = {0.10, 0.10, 0.10, 0.10, 0.10, 0.10, 0.10, 0.10, 0.10, 0.10, 0.10, 0.10, 0.10, 0.10, 0.10, 0.10, 0.10, 0.10, 0.10, 0.10, 0.11, 0.11, 0.11, 0.11, 0.11, 0.12, 0.12, 0.13, 0.13, 0.14, 0.15, 0.16, 0.17, 0.18, 0.20, 0.21, 0.23, 0.25, 0.27, 0.30, 0.33, 0.36, 0.40, 0.43, 0.48, 0.52, 0.58, 0.63, 0.70, 0.76, 0.84, 0.92, 1.01, 1.10, 1.21, 1.32, 1.44, 1.57, 1.71, 1.87, 2.03, 2.21, 2.39, 2.60, 2.81, 3.04, 3.29, 3.55, 3.83, 4.13, 4.44, 4.78, 5.14, 5.52, 5.92, 6.35, 6.80, 7.27, 7.78, 8.31, 8.87, 9.47, 10.09, 10.75, 11.44, 12.17, 12.94, 13.74, 14.59, 15.48, 16.41, 17.38, 18.41, 19.48, 20.60, 21.78, 23.00, 24.29, 25.63, 27.03, 28.49, 30.02, 31.61, 33.27, 35.00, 36.81, 38.69, 40.64, 42.67, 44.79, 46.99, 49.28, 51.66, 54.12, 56.69, 59.35, 62.11, 64.98, 67.95, 71.03, 74.23, 77.54, 80.96, 84.51, 88.19, 91.99, 95.93, 100.00};
-const float MEMORYMODEBENDDEPTH[128] = {0.00, 0.09, 0.19, 0.28, 0.38, 0.47, 0.57, 0.66, 0.76, 0.85, 0.94, 1.04, 1.13, 1.23, 1.32, 1.42, 1.51, 1.61, 1.70, 1.80, 1.89, 1.98, 2.08, 2.17, 2.27, 2.36, 2.46, 2.55, 2.65, 2.74, 2.83, 2.93, 3.02, 3.12, 3.21, 3.31, 3.40, 3.50, 3.59, 3.69, 3.78, 3.87, 3.97, 4.06, 4.16, 4.25, 4.35, 4.44, 4.54, 4.63, 4.72, 4.82, 4.91, 5.01, 5.10, 5.20, 5.29, 5.39, 5.48, 5.57, 5.67, 5.76, 5.86, 5.95, 6.05, 6.14, 6.24, 6.33, 6.43, 6.52, 6.61, 6.71, 6.80, 6.90, 6.99, 7.09, 7.18, 7.28, 7.37, 7.46, 7.56, 7.65, 7.75, 7.84, 7.94, 8.03, 8.13, 8.22, 8.31, 8.41, 8.50, 8.60, 8.69, 8.79, 8.88, 8.98, 9.07, 9.17, 9.26, 9.35, 9.45, 9.54, 9.64, 9.73, 9.83, 9.92, 10.02, 10.11, 10.20, 10.30, 10.39, 10.49, 10.58, 10.68, 10.77, 10.87, 10.96, 11.06, 11.15, 11.24, 11.34, 11.43, 11.53, 11.62, 11.72, 11.81, 11.91, 12.00};
-const float MEMORYMODEENSEMBLERATE[128] = {0.01, 0.01, 0.01, 0.01, 0.02, 0.02, 0.03, 0.03, 0.04, 0.05, 0.06, 0.07, 0.08, 0.09, 0.11, 0.12, 0.14, 0.15, 0.17, 0.19, 0.21, 0.23, 0.25, 0.27, 0.30, 0.32, 0.34, 0.37, 0.40, 0.43, 0.46, 0.49, 0.52, 0.55, 0.58, 0.62, 0.65, 0.69, 0.73, 0.76, 0.80, 0.84, 0.88, 0.93, 0.97, 1.01, 1.06, 1.10, 1.15, 1.20, 1.25, 1.30, 1.35, 1.40, 1.45, 1.51, 1.56, 1.62, 1.68, 1.73, 1.79, 1.85, 1.91, 1.98, 2.04, 2.10, 2.17, 2.23, 2.30, 2.37, 2.44, 2.51, 2.58, 2.65, 2.72, 2.80, 2.87, 2.95, 3.02, 3.10, 3.18, 3.26, 3.34, 3.42, 3.51, 3.59, 3.67, 3.76, 3.85, 3.93, 4.02, 4.11, 4.20, 4.29, 4.39, 4.48, 4.58, 4.67, 4.77, 4.87, 4.96, 5.06, 5.16, 5.27, 5.37, 5.47, 5.58, 5.68, 5.79, 5.90, 6.00, 6.11, 6.22, 6.34, 6.45, 6.56, 6.68, 6.79, 6.91, 7.03, 7.14, 7.26, 7.38, 7.50, 7.63, 7.75, 7.87, 8.00};
-const float MEMORYMODEECHOSPREAD[128] = {0.00, 0.16, 0.31, 0.47, 0.63, 0.79, 0.94, 1.10, 1.26, 1.42, 1.57, 1.73, 1.89, 2.05, 2.20, 2.36, 2.52, 2.68, 2.83, 2.99, 3.15, 3.31, 3.46, 3.62, 3.78, 3.94, 4.09, 4.25, 4.41, 4.57, 4.72, 4.88, 5.04, 5.20, 5.35, 5.51, 5.67, 5.83, 5.98, 6.14, 6.30, 6.46, 6.61, 6.77, 6.93, 7.09, 7.24, 7.40, 7.56, 7.72, 7.87, 8.03, 8.19, 8.35, 8.50, 8.66, 8.82, 8.98, 9.13, 9.29, 9.45, 9.61, 9.76, 9.92, 10.08, 10.24, 10.39, 10.55, 10.71, 10.87, 11.02, 11.18, 11.34, 11.50, 11.65, 11.81, 11.97, 12.13, 12.28, 12.44, 12.60, 12.76, 12.91, 13.07, 13.23, 13.39, 13.54, 13.70, 13.86, 14.02, 14.17, 14.33, 14.49, 14.65, 14.80, 14.96, 15.12, 15.28, 15.43, 15.59, 15.75, 15.91, 16.06, 16.22, 16.38, 16.54, 16.69, 16.85, 17.01, 17.17, 17.32, 17.48, 17.64, 17.80, 17.95, 18.11, 18.27, 18.43, 18.58, 18.74, 18.90, 19.06, 19.21, 19.37, 19.53, 19.69, 19.84, 20.00};
-const float MEMORYMODEEMPHASIS[128] = {0.00, 0.98, 1.96, 2.95, 3.93, 4.91, 5.89, 6.87, 7.85, 8.84, 9.82, 10.80, 11.78, 12.76, 13.75, 14.73, 15.71, 16.69, 17.67, 18.65, 19.64, 20.62, 21.60, 22.58, 23.56, 24.54, 23.53, 26.51, 27.49, 28.47, 29.45, 30.44, 31.42, 32.40, 33.38, 34.36, 35.34, 36.33, 37.31, 38.29, 39.27, 40.25, 41.24, 42.22, 43.20, 44.18, 45.16, 46.14, 47.13, 48.11, 49.09, 50.07, 51.05, 52.03, 53.02, 54.00, 54.98, 55.96, 56.94, 57.93, 58.91, 59.89, 60.87, 61.85, 62.83, 63.82, 64.80, 65.78, 66.76, 67.74, 68.73, 69.71, 70.69, 71.67, 72.65, 73.63, 74.62, 75.60, 76.58, 77.56, 78.54, 79.53, 80.51, 81.49, 82.47, 83.45, 84.43, 85.42, 86.40, 87.38, 88.36, 89.34, 90.32, 91.31, 92.29, 93.27, 94.25, 95.23, 96.22, 97.20, 98.18, 99.16, 99.75, 99.76, 99.77, 99.78, 99.79, 99.80, 99.81, 99.82, 99.83, 99.84, 99.85, 99.86, 99.87, 99.88, 99.89, 99.90, 99.91, 99.92, 99.93, 99.94, 99.95, 99.96, 99.97, 99.98, 99.99, 100.00};
 
-const String MEMORYMODEECHOSYNC[20] = {"1/64 Triplet", "1/64", "1/64 Dotted", "1/32 Triplet", "1/32", "1/32 Dotted", "1/16 Triplet", "1/16", "1/16 Dotted", "1/8 Triplet", "1/8", "1/8 Dotted", "1/4 Triplet", "1/4", "1/4 Dotted", "1/2 Triplet", "1/2", "1/62 Dotted", "4 Beats", "8 Beats" };
-const String MEMORYMODEARPSYNC[20] = {"8 Beats", "4 Beats", "1/2 Dotted", "1/2", "1/2 Triplet", "1/4 Dotted", "1/4", "1/14 Triplet", "1/8 Dotted", "1/8", "1/8 Triplet", "1/16 Dotted", "1/16", "1/16 Triplet", "1/32 Dotted", "1/32", "1/32 Triplet", "1/64 Dotted", "1/64", "1/64 Triplet" };
+// Display value tables, in hundredths (2.50 is stored as 250)
+//
+// Plain const data is copied to RAM on the Teensy 4, PROGMEM keeps these in
+// flash. Curves with a known formula are generated at compile time, the rest
+// are the measured values. Print them with TextBuffer::addCenti().
+
+struct CentiTable {
+  int32_t v[128];
+  constexpr int32_t operator[](int i) const {
+    return v[i];
+  }
+};
+
+//lo + (hi - lo) * (i / 127)^power, rounded to the given number of decimals
+constexpr CentiTable centiCurve(double lo, double hi, int power, int decimals) {
+  CentiTable t = {};
+  int scale = decimals == 1 ? 10 : 100;
+  for (int i = 0; i < 128; i++) {
+    double x = 1.0;
+    for (int p = 0; p < power; p++) x *= i / 127.0;
+    x = (lo + (hi - lo) * x) * scale;
+    int32_t n = x < 0 ? -(int32_t)(-x + 0.5) : (int32_t)(x + 0.5);
+    t.v[i] = n * (100 / scale);
+  }
+  return t;
+}
+
+const int32_t MEMORYMODEFREQ3[128] PROGMEM = {-3004, -2956, -2909, -2862, -2815, -2767, -2720, -2673, -2625, -2578, -2531, -2483, -2436, -2389, -2342, -2294, -2247, -2200, -2152, -2105, -2058, -2010, -1963, -1916, -1868, -1821, -1774, -1727, -1679, -1632, -1585, -1537, -1490, -1443, -1395, -1348, -1301, -1254, -1206, -1159, -1112, -1064, -1017, -970, -922, -875, -828, -781, -733, -686, -639, -591, -544, -497, -449, -402, -355, -307, -260, -213, -166, -118, -71, -24, 24, 71, 118, 166, 213, 260, 307, 355, 402, 449, 497, 544, 591, 639, 686, 733, 781, 828, 875, 922, 970, 1017, 1064, 1112, 1159, 1206, 1254, 1301, 1348, 1395, 1443, 1490, 1537, 1585, 1632, 1679, 1727, 1774, 1821, 1868, 1916, 1963, 2010, 2058, 2105, 2152, 2200, 2247, 2294, 2342, 2389, 2436, 2483, 2531, 2578, 2625, 2673, 2720, 2767, 2815, 2862, 2909, 2956, 3004};
+const int32_t MEMORYMODE100LOG[128] PROGMEM = {0, 0, 0, 10, 10, 20, 20, 30, 40, 50, 60, 80, 90, 100, 120, 140, 160, 180, 200, 220, 250, 270, 300, 330, 360, 390, 420, 450, 490, 520, 560, 600, 630, 680, 720, 760, 800, 850, 900, 940, 990, 1004, 1090, 1150, 1200, 1260, 1310, 1370, 1430, 1490, 1550, 1610, 1680, 1740, 1810, 1880, 1940, 2010, 2090, 2160, 2230, 2310, 2380, 2460, 2540, 2620, 2700, 2780, 2870, 2950, 3040, 3130, 3210, 3300, 3400, 3490, 3580, 3680, 3770, 3870, 3970, 4070, 4170, 4270, 4370, 4480, 4590, 4690, 4800, 4910, 5020, 5130, 5250, 5360, 5480, 5600, 5710, 5830, 5950, 6080, 6200, 6320, 6450, 6580, 6710, 6840, 6970, 7100, 7230, 7370, 7500, 7640, 7780, 7920, 8060, 8200, 8340, 8490, 8630, 8780, 8930, 9080, 9230, 9380, 9530, 9690, 9840, 10000};
+constexpr CentiTable MEMORYMODE100 PROGMEM = centiCurve(0.0, 100.0, 1, 1);
+constexpr CentiTable MEMORYMODE200 PROGMEM = centiCurve(0.0, 200.0, 2, 2);
+constexpr CentiTable MEMORYMODEFREQ2 PROGMEM = centiCurve(-8.01, 8.01, 1, 2);
+constexpr CentiTable MEMORYMODETUNE PROGMEM = centiCurve(-5.01, 5.01, 1, 2);
+const int32_t MEMORYMODEATTACK[128] PROGMEM = {100, 100, 101, 104, 110, 121, 138, 164, 199, 247, 309, 387, 484, 602, 742, 908, 1102, 1327, 1584, 1877, 2209, 2581, 2997, 3460, 3972, 4537, 5157, 5834, 6573, 7377, 8247, 9188, 10203, 11294, 12465, 13720, 15061, 16491, 18015, 19636, 21356, 23179, 25110, 27150, 29305, 31576, 33969, 36486, 39131, 41908, 44821, 47873, 51067, 54408, 57899, 61545, 65349, 69314, 73445, 77746, 82220, 86871, 91704, 96723, 101930, 107331, 112930, 118730, 124735, 130950, 137379, 144026, 150895, 157990, 165315, 172875, 180674, 188717, 197006, 205548, 214345, 223403, 232725, 242317, 252182, 262325, 272750, 283462, 294465, 305764, 317363, 329266, 341479, 354006, 366850, 380018, 393513, 407340, 421503, 436008, 450859, 466060, 481617, 497533, 513815, 530465, 547490, 564894, 582681, 600857, 619427, 638394, 657764, 677542, 697733, 718341, 739372, 760830, 782720, 805047, 827817, 851033, 874702, 898827, 923415, 948469, 973996, 1000000};
+const int32_t MEMORYMODEDECAY[128] PROGMEM = {200, 200, 202, 208, 220, 242, 276, 327, 399, 495, 618, 775, 968, 1203, 1485, 1817, 2205, 2654, 3169, 3755, 4418, 5163, 5995, 6920, 7945, 9094, 10313, 11668, 13147, 14754, 16495, 18377, 20406, 22588, 24931, 27440, 30121, 32983, 36030, 39271, 42712, 46359, 50219, 54301, 58609, 63153, 67938, 72972, 78263, 83817, 89642, 95745, 102134, 108816, 115799, 123090, 130697, 138628, 146890, 155491, 164440, 173743, 183409, 193445, 203861, 214663, 225860, 237459, 249470, 261900, 274758, 288052, 301789, 315979, 330630, 345751, 361349, 377433, 394013, 411095, 428690, 446806, 465451, 484634, 504364, 524650, 545500, 566924, 588930, 611528, 634726, 658533, 682958, 708011, 733700, 760035, 787025, 814679, 843006, 872016, 901717, 932120, 963234, 995067, 1027629, 1060931, 1094980, 1129788, 1165363, 1201715, 1238853, 1276788, 1315529, 1355085, 1395466, 1436682, 1478744, 1521659, 1565440, 1610094, 1655633, 1702066, 1749403, 1797654, 1846830, 1896939, 1947992, 2000000};
+const int32_t MEMORYMODERELEASE[128] PROGMEM = {200, 200, 202, 208, 220, 242, 276, 327, 399, 495, 618, 775, 968, 1203, 1485, 1817, 2205, 2654, 3169, 3755, 4418, 5163, 5995, 6920, 7945, 9094, 10313, 11668, 13147, 14754, 16495, 18377, 20406, 22588, 24931, 27440, 30121, 32983, 36030, 39271, 42712, 46359, 50219, 54301, 58609, 63153, 67938, 72972, 78263, 83817, 89642, 95745, 102134, 108816, 115799, 123090, 130697, 138628, 146890, 155491, 164440, 173743, 183409, 193445, 203861, 214663, 225860, 237459, 249470, 261900, 274758, 288052, 301789, 315979, 330630, 345751, 361349, 377433, 394013, 411095, 428690, 446806, 465451, 484634, 504364, 524650, 545500, 566924, 588930, 611528, 634726, 658533, 682958, 708011, 733700, 760035, 787025, 814679, 843006, 872016, 901717, 932120, 963234, 995067, 1027629, 1060931, 1094980, 1129788, 1165363, 1201715, 1238853, 1276788, 1315529, 1355085, 1395466, 1436682, 1478744, 1521659, 1565440, 1610094, 1655633, 1702066, 1749403, 1797654, 1846830, 1896939, 1947992, 2000000};
+constexpr CentiTable MEMORYMODECUTOFF PROGMEM = centiCurve(20.0, 24000.0, 5, 2);
+const int32_t MEMORYMODEPORT[128] PROGMEM = {0, 6, 25, 56, 99, 155, 223, 304, 397, 502, 620, 750, 893, 1048, 1215, 1395, 1587, 1792, 2009, 2238, 2480, 2734, 3001, 3280, 3571, 3875, 4191, 4520, 4861, 5214, 5580, 5958, 6349, 6752, 7167, 7595, 8035, 8488, 8953, 9430, 9920, 10422, 10937, 11464, 12003, 12555, 13119, 13696, 14285, 14886, 15500, 16126, 16765, 17416, 18079, 18755, 19443, 20144, 20857, 21582, 22320, 23070, 23833, 24608, 25395, 26195, 27007, 27832, 28669, 29518, 30380, 31254, 32141, 33040, 33951, 34875, 35811, 36760, 37721, 38694, 39680, 40678, 41689, 42712, 43747, 44795, 45855, 46928, 48013, 49110, 50220, 51342, 52477, 53624, 54783, 55955, 57139, 58336, 59545, 60766, 62000, 63246, 64505, 65778, 67059, 68355, 69663, 70984, 72317, 73662, 75020, 76390, 77773, 79168, 80575, 81995, 83427, 84872, 86329, 87798, 89280, 90774, 92281, 93800, 95331, 96875, 98431, 100000};
+constexpr CentiTable MEMORYMODEINITPW PROGMEM = centiCurve(0.0, 99.5, 1, 1);
+constexpr CentiTable MEMORYMODEPHASERRATE PROGMEM = centiCurve(0.01, 7.5, 5, 2);
+const int32_t MEMORYMODEECHOTIME[128] PROGMEM = {100, 112, 150, 212, 298, 410, 546, 707, 893, 1104, 1339, 1600, 1885, 2195, 2529, 2889, 3273, 3683, 4116, 4574, 5058, 5566, 6099, 6656, 7239, 7846, 8478, 9135, 9817, 10523, 11254, 12010, 12791, 13597, 14427, 15282, 16162, 17067, 17997, 18951, 19930, 20934, 21963, 23016, 24094, 25197, 26325, 27478, 28655, 29858, 31085, 32336, 33613, 34914, 36240, 37591, 38967, 40368, 41793, 43243, 44718, 46217, 47742, 49291, 50865, 52464, 54088, 55736, 57409, 59107, 60830, 62577, 64350, 66147, 67969, 69815, 71687, 73583, 75504, 77450, 79420, 81416, 83436, 85481, 87551, 89645, 91765, 93909, 96078, 98271, 100490, 102733, 105001, 107294, 109612, 111954, 114321, 116713, 119130, 121572, 124038, 126529, 129045, 131586, 134152, 136742, 139357, 141997, 144662, 147351, 150065, 152804, 155568, 158357, 161170, 164008, 166871, 169759, 172672, 175609, 178571, 181558, 184570, 187606, 190667, 193754, 196864, 200000};
+const int32_t MEMORYMODEARPRATE[128] PROGMEM = {25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 26, 26, 26, 26, 27, 27, 28, 29, 29, 30, 31, 32, 34, 35, 37, 38, 40, 42, 44, 47, 49, 52, 55, 58, 62, 66, 70, 74, 78, 83, 88, 94, 99, 105, 112, 119, 126, 133, 141, 149, 158, 167, 177, 187, 197, 208, 219, 231, 243, 256, 269, 283, 298, 312, 328, 344, 361, 378, 396, 414, 433, 453, 474, 495, 517, 539, 562, 586, 611, 636, 662, 689, 717, 746, 775, 805, 836, 868, 901, 934, 969, 1004, 1041, 1078, 1116, 1155, 1196, 1237, 1279, 1322, 1366, 1411, 1458, 1505, 1553, 1603, 1654, 1705, 1758, 1812, 1868, 1924, 1982, 2041, 2101, 2162, 2225, 2288, 2354, 2420, 2488, 2557, 2627, 2699, 2772, 2847, 2923, 3000};
+const int32_t MEMORYMODELFORATE[128] PROGMEM = {10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 11, 11, 11, 11, 11, 12, 12, 13, 13, 14, 15, 16, 17, 18, 20, 21, 23, 25, 27, 30, 33, 36, 40, 43, 48, 52, 58, 63, 70, 76, 84, 92, 101, 110, 121, 132, 144, 157, 171, 187, 203, 221, 239, 260, 281, 304, 329, 355, 383, 413, 444, 478, 514, 552, 592, 635, 680, 727, 778, 831, 887, 947, 1009, 1075, 1144, 1217, 1294, 1374, 1459, 1548, 1641, 1738, 1841, 1948, 2060, 2178, 2300, 2429, 2563, 2703, 2849, 3002, 3161, 3327, 3500, 3681, 3869, 4064, 4267, 4479, 4699, 4928, 5166, 5412, 5669, 5935, 6211, 6498, 6795, 7103, 7423, 7754, 8096, 8451, 8819, 9199, 9593, 10000};
+constexpr CentiTable MEMORYMODEBENDDEPTH PROGMEM = centiCurve(0.0, 12.0, 1, 2);
+constexpr CentiTable MEMORYMODEENSEMBLERATE PROGMEM = centiCurve(0.01, 8.0, 2, 2);
+constexpr CentiTable MEMORYMODEECHOSPREAD PROGMEM = centiCurve(0.0, 20.0, 1, 2);
+const int32_t MEMORYMODEEMPHASIS[128] PROGMEM = {0, 98, 196, 295, 393, 491, 589, 687, 785, 884, 982, 1080, 1178, 1276, 1375, 1473, 1571, 1669, 1767, 1865, 1964, 2062, 2160, 2258, 2356, 2454, 2353, 2651, 2749, 2847, 2945, 3044, 3142, 3240, 3338, 3436, 3534, 3633, 3731, 3829, 3927, 4025, 4124, 4222, 4320, 4418, 4516, 4614, 4713, 4811, 4909, 5007, 5105, 5203, 5302, 5400, 5498, 5596, 5694, 5793, 5891, 5989, 6087, 6185, 6283, 6382, 6480, 6578, 6676, 6774, 6873, 6971, 7069, 7167, 7265, 7363, 7462, 7560, 7658, 7756, 7854, 7953, 8051, 8149, 8247, 8345, 8443, 8542, 8640, 8738, 8836, 8934, 9032, 9131, 9229, 9327, 9425, 9523, 9622, 9720, 9818, 9916, 9975, 9976, 9977, 9978, 9979, 9980, 9981, 9982, 9983, 9984, 9985, 9986, 9987, 9988, 9989, 9990, 9991, 9992, 9993, 9994, 9995, 9996, 9997, 9998, 9999, 10000};
+
+const char MEMORYMODEECHOSYNC[20][13] PROGMEM = {"1/64 Triplet", "1/64", "1/64 Dotted", "1/32 Triplet", "1/32", "1/32 Dotted", "1/16 Triplet", "1/16", "1/16 Dotted", "1/8 Triplet", "1/8", "1/8 Dotted", "1/4 Triplet", "1/4", "1/4 Dotted", "1/2 Triplet", "1/2", "1/62 Dotted", "4 Beats", "8 Beats" };
+const char MEMORYMODEARPSYNC[20][13] PROGMEM = {"8 Beats", "4 Beats", "1/2 Dotted", "1/2", "1/2 Triplet", "1/4 Dotted", "1/4", "1/14 Triplet", "1/8 Dotted", "1/8", "1/8 Triplet", "1/16 Dotted", "1/16", "1/16 Triplet", "1/32 Dotted", "1/32", "1/32 Triplet", "1/64 Dotted", "1/64", "1/64 Triplet" };
 
 #define RE_READ -9
 #define  NO_OF_VOICES 1
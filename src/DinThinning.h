@@ -0,0 +1,133 @@
+// Bandwidth aware thinning of continuous controllers on the DIN output
+//
+// The DIN output carries about 3125 bytes a second. A keyboard sending 1000+
+// aftertouch or pitch bend messages a second fills the serial transmit buffer
+// and every note passed through after that waits behind the backlog.
+//
+// Pitch bend, aftertouch and mod wheel for DIN are held as the newest value per
+// channel and type. They go out while the transmit backlog is at most
+// DIN_THIN_BACKLOG bytes, otherwise a newer value replaces the pending one and
+// the intermediate is dropped. The MIDI poll interrupt sends what is pending as
+// the link drains. Before a note goes out everything pending is sent first, so
+// a note is never moved ahead of a controller value that arrived before it.
+
+#define DIN_THIN_BACKLOG 6  //Bytes waiting to transmit above which the link is saturated
+#define DIN_BYTE_US 320     //10 bits at 31250 baud
+
+//Uncomment to print DIN link utilisation, thinned messages and how long notes wait behind the backlog
+//#define DIN_THINNING_STATS
+#define DIN_THINNING_STATS_INTERVAL 10000
+
+enum { DIN_THIN_PITCH_BEND, DIN_THIN_AFTERTOUCH, DIN_THIN_MOD_WHEEL, DIN_THIN_TYPES };
+
+static int16_t dinPendingValue[DIN_THIN_TYPES][16];
+static uint16_t dinPendingMask[DIN_THIN_TYPES] = {};  //One bit per channel with a pending value
+static int dinTxCapacity = 0;
+
+#ifdef DIN_THINNING_STATS
+static uint32_t dinContinuousIn = 0;
+static uint32_t dinContinuousSent = 0;
+static volatile uint32_t dinPollTicks = 0;
+static volatile uint32_t dinBusyTicks = 0;  //Ticks with bytes still to transmit
+static volatile uint16_t dinBacklogMax = 0;
+static uint32_t dinNotes = 0;
+static uint32_t dinNoteFlushes = 0;  //Notes that had pending values sent ahead of them
+static uint32_t dinNoteWaitTotal = 0;
+static uint32_t dinNoteWaitMax = 0;
+static unsigned long dinThinningStatsTimer = 0;
+#endif
+
+//Called before the MIDI poll starts, while nothing is waiting to transmit
+void dinThinningSetup() {
+  dinTxCapacity = Serial1.availableForWrite();
+}
+
+static int dinBacklog() {
+  int backlog = dinTxCapacity - Serial1.availableForWrite();
+  return backlog < 0 ? 0 : backlog;
+}
+
+static void dinContinuousWrite(uint8_t type, byte channel, int value) {
+  switch (type) {
+    case DIN_THIN_PITCH_BEND:
+      MIDI.sendPitchBend(value, channel);
+      midiTrafficMessage(TRAFFIC_DIN_OUT, 0xE0, 0, 0);
+      break;
+    case DIN_THIN_AFTERTOUCH:
+      MIDI.sendAfterTouch(value, channel);
+      midiTrafficMessage(TRAFFIC_DIN_OUT, 0xD0, value, 0);
+      break;
+    case DIN_THIN_MOD_WHEEL:
+      MIDI.sendControlChange(CCmodWheelinput, value, channel);
+      midiTrafficMessage(TRAFFIC_DIN_OUT, 0xB0, CCmodWheelinput, value);
+      break;
+  }
+#ifdef DIN_THINNING_STATS
+  dinContinuousSent++;
+#endif
+}
+
+//Send pending values while the link has room, or all of them when forced
+static void dinFlushContinuous(bool force) {
+  for (int t = 0; t < DIN_THIN_TYPES; t++) {
+    while (dinPendingMask[t]) {
+      if (!force && dinBacklog() > DIN_THIN_BACKLOG) return;
+      byte c = __builtin_ctz(dinPendingMask[t]);
+      dinPendingMask[t] &= ~(1 << c);
+      dinContinuousWrite(t, c + 1, dinPendingValue[t][c]);
+    }
+  }
+}
+
+//Callers hold MidiOutGuard or are the poll interrupt
+void dinSendContinuous(uint8_t type, byte channel, int value) {
+  byte c = (channel - 1) & 15;
+#ifdef DIN_THINNING_STATS
+  dinContinuousIn++;
+#endif
+  if (dinPendingMask[type] & (1 << c)) midiTrafficCoalesced(TRAFFIC_DIN_OUT);
+  dinPendingValue[type][c] = value;  //Replaces a value that never went out
+  dinPendingMask[type] |= 1 << c;
+  dinFlushContinuous(false);
+}
+
+//Before every note sent on DIN
+void dinBeforeNote() {
+#ifdef DIN_THINNING_STATS
+  if (dinPendingMask[DIN_THIN_PITCH_BEND] | dinPendingMask[DIN_THIN_AFTERTOUCH] | dinPendingMask[DIN_THIN_MOD_WHEEL]) dinNoteFlushes++;
+#endif
+  dinFlushContinuous(true);
+#ifdef DIN_THINNING_STATS
+  uint32_t wait = dinBacklog() * DIN_BYTE_US;
+  dinNotes++;
+  dinNoteWaitTotal += wait;
+  if (wait > dinNoteWaitMax) dinNoteWaitMax = wait;
+#endif
+}
+
+//From the MIDI poll interrupt, sends what is pending as the link drains
+void dinThinningPoll() {
+#ifdef DIN_THINNING_STATS
+  int backlog = dinBacklog();
+  dinPollTicks++;
+  if (backlog > 0) dinBusyTicks++;
+  if (backlog > dinBacklogMax) dinBacklogMax = backlog;
+#endif
+  if (!midiOutBusy) dinFlushContinuous(false);
+}
+
+#ifdef DIN_THINNING_STATS
+void checkDinThinningStats() {
+  if (millis() - dinThinningStatsTimer > DIN_THINNING_STATS_INTERVAL) {
+    dinThinningStatsTimer = millis();
+    Serial.printf("DIN link: busy %lu%% backlog max %u bytes | continuous in %lu sent %lu thinned %lu\n",
+                  dinPollTicks ? (dinBusyTicks * 100) / dinPollTicks : 0, dinBacklogMax,
+                  dinContinuousIn, dinContinuousSent, dinContinuousIn - dinContinuousSent);
+    Serial.printf("DIN notes: %lu, %lu behind pending values | wait on the wire avg %lu max %lu uS\n",
+                  dinNotes, dinNoteFlushes, dinNotes ? dinNoteWaitTotal / dinNotes : 0, dinNoteWaitMax);
+    dinPollTicks = dinBusyTicks = dinBacklogMax = 0;
+    dinContinuousIn = dinContinuousSent = 0;
+    dinNotes = dinNoteFlushes = dinNoteWaitTotal = dinNoteWaitMax = 0;
+  }
+}
+#endif
@@ -0,0 +1,103 @@
+// Latest state model for pot parameters on the displays
+//
+// A pot sweep or a burst of CCs from a DAW used to format and draw every
+// value on both the LCD and the TFT. The handlers now only record which
+// parameter was touched and its raw values. renderDisplayModel() formats
+// the latest one at most every DISPLAY_FRAME_MS, anything in between is
+// overwritten and never formatted.
+
+void updateMOOGstyle(int PREVparam, int value, const char *WhichParameter);
+
+//Uncomment to print the CPU time per incoming CC and per display render
+//#define DISPLAY_STATS
+#define DISPLAY_STATS_INTERVAL 10000
+
+struct PotDisplay {
+  const char *name;   //TFT name
+  const char *unit;
+  const char *label;  //LCD label
+  int32_t value;
+  bool isCenti;  //value is in hundredths
+  int prev;
+  int value100;
+};
+
+static PotDisplay potDisplay;
+static bool potDisplayPending = false;
+static unsigned long potDisplayTime = 0;
+
+#ifdef DISPLAY_STATS
+static uint32_t displayStatCCs = 0;
+static uint32_t displayStatCCCycles = 0;
+static uint32_t displayStatCCMax = 0;
+static uint32_t displayStatRenders = 0;
+static uint32_t displayStatRenderCycles = 0;
+static uint32_t displayStatFormatCycles = 0;  //Value to text only
+static unsigned long displayStatTimer = 0;
+#endif
+
+void showPotParameterCenti(const char *name, int32_t centi, const char *unit, int prev, int value100, const char *label) {
+  potDisplay = { name, unit, label, centi, true, prev, value100 };
+  potDisplayPending = true;
+}
+
+void showPotParameter(const char *name, int value, const char *unit, int prev, int value100, const char *label) {
+  potDisplay = { name, unit, label, value, false, prev, value100 };
+  potDisplayPending = true;
+}
+
+//Something else took the displays, a pending pot value must not overwrite it
+void cancelPotDisplay() {
+  potDisplayPending = false;
+}
+
+//Format and show the latest pot parameter, run by the display task
+void renderDisplayModel() {
+  if (!potDisplayPending || millis() - potDisplayTime < DISPLAY_FRAME_MS) return;
+#ifdef DISPLAY_STATS
+  uint32_t start = ARM_DWT_CYCCNT;
+#endif
+  potDisplayPending = false;
+  potDisplayTime = millis();
+#ifdef DISPLAY_STATS
+  uint32_t formatStart = ARM_DWT_CYCCNT;
+#endif
+  TextBuffer<24> value;
+  if (potDisplay.isCenti) {
+    value.addCenti(potDisplay.value);
+  } else {
+    value.addInt(potDisplay.value);
+  }
+  value.add(potDisplay.unit);
+#ifdef DISPLAY_STATS
+  displayStatFormatCycles += ARM_DWT_CYCCNT - formatStart;
+#endif
+  updateMOOGstyle(potDisplay.prev, potDisplay.value100, potDisplay.label);
+  showCurrentParameterPage(potDisplay.name, value.c_str());
+#ifdef DISPLAY_STATS
+  displayStatRenders++;
+  displayStatRenderCycles += ARM_DWT_CYCCNT - start;
+#endif
+}
+
+#ifdef DISPLAY_STATS
+void displayRecordCC(uint32_t cycles) {
+  displayStatCCs++;
+  displayStatCCCycles += cycles;
+  if (cycles > displayStatCCMax) displayStatCCMax = cycles;
+}
+
+void checkDisplayStats() {
+  if (millis() - displayStatTimer > DISPLAY_STATS_INTERVAL) {
+    displayStatTimer = millis();
+    uint32_t perUs = F_CPU_ACTUAL / 1000000;
+    Serial.printf("Display: %lu CCs in, avg %lu max %lu uS each | %lu renders, avg %lu uS each, format avg %lu cycles\n",
+                  displayStatCCs, displayStatCCs ? displayStatCCCycles / displayStatCCs / perUs : 0,
+                  displayStatCCMax / perUs, displayStatRenders,
+                  displayStatRenders ? displayStatRenderCycles / displayStatRenders / perUs : 0,
+                  displayStatRenders ? displayStatFormatCycles / displayStatRenders : 0);
+    displayStatCCs = displayStatCCCycles = displayStatCCMax = 0;
+    displayStatRenders = displayStatRenderCycles = displayStatFormatCycles = 0;
+  }
+}
+#endif
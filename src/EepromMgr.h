@@ -6,6 +6,9 @@
 #define EEPROM_MIDI_OUT_CH 3
 #define EEPROM_UPDATE_PARAMS 5
 #define EEPROM_SEND_NOTES 8
+#define EEPROM_MIDI_ROUTES 10  //Two bytes
+#define EEPROM_MIDI_ROUTES_SET 12
+#define EEPROM_ECHO_WINDOW 13
 
 int getMIDIChannel() {
   byte midiChannel = EEPROM.read(EEPROM_MIDI_CH);
@@ -35,20 +38,33 @@ boolean getUpdateParams() {
   return params == 1 ? true : false;
 }
 
-void storeUpdateParams(byte updateParameters)
-{
-  EEPROM.update(EEPROM_UPDATE_PARAMS, updateParameters);
-}
-
 boolean getSendNotes() {
   byte sn = EEPROM.read(EEPROM_SEND_NOTES); 
   if ( sn < 0 || sn > 1 )return true; //If EEPROM has no encoder direction stored
   return sn == 1 ? true : false;
 }
 
-void storeSendNotes(byte sendUSBNotes)
+uint16_t getMidiRoutes(uint16_t defaults) {
+  if (EEPROM.read(EEPROM_MIDI_ROUTES_SET) != 1) return defaults; //If EEPROM has no routing matrix stored
+  return EEPROM.read(EEPROM_MIDI_ROUTES) | (EEPROM.read(EEPROM_MIDI_ROUTES + 1) << 8);
+}
+
+void storeMidiRoutes(uint16_t routes)
+{
+  EEPROM.update(EEPROM_MIDI_ROUTES, routes & 0xFF);
+  EEPROM.update(EEPROM_MIDI_ROUTES + 1, routes >> 8);
+  EEPROM.update(EEPROM_MIDI_ROUTES_SET, 1);
+}
+
+byte getEchoWindow() {
+  byte ew = EEPROM.read(EEPROM_ECHO_WINDOW);
+  if (ew > 3) return 2; //If EEPROM has no echo window stored
+  return ew;
+}
+
+void storeEchoWindow(byte window)
 {
-  EEPROM.update(EEPROM_SEND_NOTES, sendUSBNotes);
+  EEPROM.update(EEPROM_ECHO_WINDOW, window);
 }
 
 int getLastPatch() {
@@ -0,0 +1,101 @@
+// Glyph span cache for the ST7735_t3 frame buffer
+//
+// Adafruit_GFX draws custom font glyphs one drawPixel per set bit. Here each
+// glyph is turned into horizontal runs, which the caller fills straight into
+// its frame buffer. A font's spans are built the first time it is drawn, into
+// one block sized from its glyphs and allocated then, so the cache only takes
+// heap (RAM2 on Teensy 4) for the fonts in use and nothing from RAM1.
+//
+// Needs GFXfont and GFXglyph (gfxfont.h) declared first. Shared by all
+// displays, and built by the host run for its glyph benchmark.
+
+#ifndef __GLYPH_SPANS_H_
+#define __GLYPH_SPANS_H_
+
+#include <stdlib.h>
+
+#define ST77XX_GLYPH_FONTS 8        // fonts that can be cached
+
+typedef struct {
+  uint8_t dy, dx, len;  // row and column in the glyph box, run length
+} ST77XX_GlyphSpan;
+
+static const GFXfont *_glyph_fonts[ST77XX_GLYPH_FONTS];
+static uint8_t *_glyph_blocks[ST77XX_GLYPH_FONTS];  // a uint16_t offset per glyph, then the span records
+static uint32_t _glyph_bytes = 0;
+
+// Walk the packed glyph bits the way Adafruit_GFX::drawChar() does and collect
+// the runs of set pixels. Returns the count, spans may be NULL to only count.
+static uint16_t glyphRasterise(const GFXfont *font, const GFXglyph *glyph, ST77XX_GlyphSpan *spans)
+{
+  const uint8_t *bitmap = font->bitmap;
+  uint16_t bo = glyph->bitmapOffset;
+  uint8_t bits = 0, bit = 0;
+  uint16_t count = 0;
+  for (uint8_t yy = 0; yy < glyph->height; yy++) {
+    int16_t run_start = -1;
+    for (uint8_t xx = 0; xx <= glyph->width; xx++) {
+      bool set = false;
+      if (xx < glyph->width) {
+        if (!(bit++ & 7)) bits = bitmap[bo++];
+        set = bits & 0x80;
+        bits <<= 1;
+      }
+      if (set && (run_start < 0)) run_start = xx;
+      if (!set && (run_start >= 0)) {
+        if (spans) spans[count] = {yy, (uint8_t)run_start, (uint8_t)(xx - run_start)};
+        count++;
+        run_start = -1;
+      }
+    }
+  }
+  return count;
+}
+
+// A glyph's record, a uint16_t count and the spans, padded to keep the counts aligned
+static inline uint32_t glyphRecordSize(uint16_t count)
+{
+  return (2 + count*sizeof(ST77XX_GlyphSpan) + 1) & ~1;
+}
+
+// All the spans of a font in one block, NULL when it does not fit
+static uint8_t *glyphBuild(const GFXfont *font)
+{
+  uint16_t glyphs = font->last - font->first + 1;
+  uint32_t size = glyphs*2;
+  for (uint16_t g = 0; g < glyphs; g++) {
+    size += glyphRecordSize(glyphRasterise(font, &font->glyph[g], NULL));
+  }
+  if (size > 0xffff) return NULL;  // the offsets are uint16_t
+  uint8_t *block = (uint8_t *)malloc(size);
+  if (!block) return NULL;
+  uint16_t *offsets = (uint16_t *)block;
+  uint32_t used = glyphs*2;
+  for (uint16_t g = 0; g < glyphs; g++) {
+    uint8_t *record = block + used;
+    uint16_t count = glyphRasterise(font, &font->glyph[g], (ST77XX_GlyphSpan *)(record + 2));
+    *(uint16_t *)record = count;
+    offsets[g] = used;
+    used += glyphRecordSize(count);
+  }
+  _glyph_bytes += size;
+  return block;
+}
+
+// Span record for a glyph of the font, c between font->first and font->last.
+// NULL when there is no room for the font, it is then drawn the slow way.
+static const uint8_t *glyphSpans(const GFXfont *font, uint8_t c)
+{
+  uint8_t f = 0;
+  while ((f < ST77XX_GLYPH_FONTS) && _glyph_fonts[f] && (_glyph_fonts[f] != font)) f++;
+  if (f == ST77XX_GLYPH_FONTS) return NULL;
+  if (!_glyph_fonts[f]) {
+    _glyph_fonts[f] = font;
+    _glyph_blocks[f] = glyphBuild(font);  // stays NULL if it failed, not retried
+  }
+  const uint8_t *block = _glyph_blocks[f];
+  if (!block) return NULL;
+  return block + ((const uint16_t *)block)[c - font->first];
+}
+
+#endif
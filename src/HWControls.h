@@ -303,7 +303,23 @@ static int mux1Read = 0;
 static int mux2Read = 0;
 static int mux3Read = 0;
 
-static long encPrevious = 0;
+//Encoder acceleration for the patch lists, a fast spin (around 60 detents/s)
+//moves several patches per detent
+#define ENC_ACCEL_FAST_MS 25
+#define ENC_ACCEL_FAST_STEP 8
+#define ENC_ACCEL_MEDIUM_MS 50
+#define ENC_ACCEL_MEDIUM_STEP 3
+static unsigned long encLastDetent = 0;
+
+//Patches to move for this detent, from the time since the last one
+byte encoderStep() {
+  unsigned long now = millis();
+  unsigned long dt = now - encLastDetent;
+  encLastDetent = now;
+  if (dt < ENC_ACCEL_FAST_MS) return ENC_ACCEL_FAST_STEP;
+  if (dt < ENC_ACCEL_MEDIUM_MS) return ENC_ACCEL_MEDIUM_STEP;
+  return 1;
+}
 
 //These are pushbuttons and require debouncing
 
@@ -0,0 +1,86 @@
+// Shadow buffer for the 2x20 HD44780 LCD
+//
+// The UI writes into lcdShadow, which costs nothing. lcdFlush() runs from
+// loop() and compares it with lcdGlass, what is actually on the display, and
+// only sends the cells that differ, at most LCD_FLUSH_CHUNK per pass. Each
+// cell over the PCF8574 backpack is several slow I2C writes, so a pot sweep
+// now costs a few changed digits per pass instead of clearing and rewriting
+// both lines from inside the CC path.
+
+#include "HD44780_LCD_PCF8574.h"
+
+#define LCD_ROWS 2
+#define LCD_COLS 20
+#define LCD_FLUSH_CHUNK 4  //Changed cells sent per loop pass
+#define LCD_NO_CURSOR 0xFF
+
+HD44780LCD LCD(LCD_ROWS, LCD_COLS, 0x27, &Wire);  // instantiate an object
+
+static char lcdShadow[LCD_ROWS][LCD_COLS];
+static char lcdGlass[LCD_ROWS][LCD_COLS];
+static uint8_t lcdCursorRow = LCD_NO_CURSOR;  //Where the LCD will put the next char
+static uint8_t lcdCursorCol = 0;
+static uint8_t lcdScan = 0;  //Cell the next flush starts looking from
+
+static inline HD44780LCD::LCDLineNumber_e lcdLine(uint8_t row) {
+  return row == 0 ? LCD.LCDLineNumberOne : LCD.LCDLineNumberTwo;
+}
+
+//After the LCD has been cleared directly
+void lcdResetGlass() {
+  memset(lcdShadow, ' ', sizeof(lcdShadow));
+  memset(lcdGlass, ' ', sizeof(lcdGlass));
+  lcdCursorRow = LCD_NO_CURSOR;
+  lcdScan = 0;
+}
+
+void lcdClear() {
+  memset(lcdShadow, ' ', sizeof(lcdShadow));
+}
+
+void lcdClearLine(uint8_t row) {
+  memset(lcdShadow[row], ' ', LCD_COLS);
+}
+
+//Text runs to the end of the line, anything past it is dropped
+void lcdPrint(uint8_t row, uint8_t col, const char *text) {
+  if (row >= LCD_ROWS) return;
+  while (*text && col < LCD_COLS) {
+    lcdShadow[row][col++] = *text++;
+  }
+}
+
+static void lcdSendCell(uint8_t row, uint8_t col) {
+  if (lcdCursorRow != row || lcdCursorCol != col) {
+    LCD.PCF8574_LCDGOTO(lcdLine(row), col);
+  }
+  LCD.PCF8574_LCDSendChar(lcdShadow[row][col]);
+  lcdGlass[row][col] = lcdShadow[row][col];
+  lcdCursorRow = row;
+  lcdCursorCol = col + 1;  //Auto increment, only valid within the line
+  if (lcdCursorCol >= LCD_COLS) lcdCursorRow = LCD_NO_CURSOR;
+}
+
+//Send up to LCD_FLUSH_CHUNK changed cells, run by the lcd task
+void lcdFlush() {
+  PROFILE_SCOPE(PROF_LCD);
+  uint8_t sent = 0;
+  for (int n = 0; n < LCD_ROWS * LCD_COLS && sent < LCD_FLUSH_CHUNK; n++) {
+    uint8_t row = lcdScan / LCD_COLS;
+    uint8_t col = lcdScan % LCD_COLS;
+    if (lcdShadow[row][col] != lcdGlass[row][col]) {
+      lcdSendCell(row, col);
+      sent++;
+    }
+    lcdScan = (lcdScan + 1) % (LCD_ROWS * LCD_COLS);
+  }
+}
+
+//Everything at once, for setup before loop() is running
+void lcdFlushAll() {
+  for (uint8_t row = 0; row < LCD_ROWS; row++) {
+    for (uint8_t col = 0; col < LCD_COLS; col++) {
+      if (lcdShadow[row][col] != lcdGlass[row][col]) lcdSendCell(row, col);
+    }
+  }
+}
@@ -0,0 +1,191 @@
+// Pot to MIDI out latency benchmark
+//
+// With LATENCY_BENCH the pots are replaced by synthetic ADC values from
+// LATENCY_BENCH_START_MS after boot. Each of the 48 mux channels is moved
+// LATENCY_BENCH_REPEATS times, and the time is measured from the move to the
+// matching CC being handed to the DIN port in midiCCOut(). That covers the
+// wait for the mux scan, checkMux(), pot thinning, myControlChange(), the
+// update function and the display model. The run is repeated under each load:
+// idle, another pot sweeping, an incoming MIDI flood and a patch recall every
+// second. Each load prints one CSV line:
+//
+//   latency_bench,<load>,<samples>,<missing>,<p50_us>,<p90_us>,<p99_us>,<max_us>
+//
+// Missing are movements with no CC out, e.g. unused mux channels or the MIDI
+// out channel set to off. Set LATENCY_BENCH_PIN to a free pin to see each
+// movement on a scope or logic analyser, it is high from the move to the CC.
+//
+// Built without the Teensy core (ARM_DWT_CYCCNT not defined) the time is the
+// host build's virtual clock in uS, host/HostMain.cpp runs it as a scenario.
+
+//Uncomment to run the benchmark after boot, the pots do nothing while it runs
+//#define LATENCY_BENCH
+#define LATENCY_BENCH_PIN -1
+#define LATENCY_BENCH_START_MS 5000
+#define LATENCY_BENCH_GAP_MS 150      //Between movements, long enough for the pot to be at rest
+#define LATENCY_BENCH_TIMEOUT_MS 500  //No CC by then, nothing on this channel
+#define LATENCY_BENCH_REPEATS 4
+#define LATENCY_BENCH_CHANNELS (3 * MUXCHANNELS)
+#define LATENCY_BENCH_FLOOD 4         //Incoming CCs per pass for the MIDI flood load
+#define LATENCY_BENCH_RECALL_MS 1000
+#define LATENCY_BENCH_NO_CC 0xFF
+
+#ifdef LATENCY_BENCH
+
+#ifdef ARM_DWT_CYCCNT
+static inline uint32_t benchNow() {
+  return ARM_DWT_CYCCNT;
+}
+#define BENCH_TICKS_PER_US (F_CPU_ACTUAL / 1000000)
+#else
+static inline uint32_t benchNow() {
+  return micros();
+}
+#define BENCH_TICKS_PER_US 1
+#endif
+
+void myConvertControlChange(byte channel, byte number, byte value);
+void recallPatch(int patchNo);
+
+enum { BENCH_IDLE, BENCH_SWEEP, BENCH_FLOOD, BENCH_RECALL, BENCH_LOADS };
+static const char *const benchLoadNames[BENCH_LOADS] = { "idle", "sweep", "midi_flood", "patch_recall" };
+
+static int benchPots[3][MUXCHANNELS];
+static bool benchRunning = false;
+static bool benchDone = false;
+static bool benchWaiting = false;
+static bool benchArmed = false;  //checkMux() is on the moved channel's address
+static byte benchCC = LATENCY_BENCH_NO_CC;
+static uint8_t benchLoad = 0;
+static uint8_t benchChannel = 0;
+static uint8_t benchRepeat = 0;
+static uint8_t benchFloodValue = 0;
+static uint32_t benchStart = 0;
+static unsigned long benchMoveTime = 0;
+static unsigned long benchRecallTime = 0;
+static uint32_t benchSamples[LATENCY_BENCH_CHANNELS * LATENCY_BENCH_REPEATS];
+static uint16_t benchSampleCount = 0;
+static uint16_t benchMissing = 0;
+static uint16_t benchLoadSamples[BENCH_LOADS];  //Per load once reported, for the host run's checks
+static unsigned long benchLoadMax[BENCH_LOADS];
+
+static unsigned long benchPercentile(int p) {
+  return benchSamples[(benchSampleCount - 1) * p / 100] / BENCH_TICKS_PER_US;
+}
+
+static void benchReport() {
+  //Insertion sort, a few hundred samples once per load
+  for (int i = 1; i < benchSampleCount; i++) {
+    uint32_t v = benchSamples[i];
+    int j = i;
+    while (j > 0 && benchSamples[j - 1] > v) {
+      benchSamples[j] = benchSamples[j - 1];
+      j--;
+    }
+    benchSamples[j] = v;
+  }
+  Serial.printf("latency_bench,%s,%u,%u", benchLoadNames[benchLoad], benchSampleCount, benchMissing);
+  benchLoadSamples[benchLoad] = benchSampleCount;
+  if (benchSampleCount) {
+    benchLoadMax[benchLoad] = benchPercentile(100);
+    Serial.printf(",%lu,%lu,%lu,%lu\n", benchPercentile(50), benchPercentile(90), benchPercentile(99), benchPercentile(100));
+  } else {
+    Serial.println(",,,,");
+  }
+}
+
+static void benchNext() {
+  benchWaiting = false;
+#if LATENCY_BENCH_PIN >= 0
+  digitalWriteFast(LATENCY_BENCH_PIN, LOW);
+#endif
+  if (++benchRepeat < LATENCY_BENCH_REPEATS) return;
+  benchRepeat = 0;
+  if (++benchChannel < LATENCY_BENCH_CHANNELS) return;
+  benchChannel = 0;
+  benchReport();
+  benchSampleCount = 0;
+  benchMissing = 0;
+  if (++benchLoad < BENCH_LOADS) return;
+  benchRunning = false;
+  benchDone = true;
+  Serial.println("latency_bench,done");
+}
+
+//Called by checkMux() after the ADC reads, replaces them while the benchmark runs
+void latencyBenchReads(byte input, int &read1, int &read2, int &read3) {
+  if (!benchRunning) return;
+  if (benchLoad == BENCH_SWEEP) {
+    byte sweep = (benchChannel + 5) % LATENCY_BENCH_CHANNELS;  //Never on the moved channel's address
+    if (input == sweep % MUXCHANNELS) {
+      int &pot = benchPots[sweep / MUXCHANNELS][input];
+      pot = (pot + 4) & 0xFF;
+    }
+  }
+  benchArmed = benchWaiting && input == benchChannel % MUXCHANNELS;
+  read1 = benchPots[0][input];
+  read2 = benchPots[1][input];
+  read3 = benchPots[2][input];
+}
+
+//Called by potControlChange(), learns which CC the moved channel sends
+void latencyBenchControl(byte cc) {
+  if (benchArmed && benchCC == LATENCY_BENCH_NO_CC) benchCC = cc;
+}
+
+//Called by midiCCOut() once the CC is queued on the DIN port
+void latencyBenchOutput(byte cc) {
+  if (!benchWaiting || recallPatchFlag || cc != benchCC) return;
+  benchSamples[benchSampleCount++] = benchNow() - benchStart;
+  benchNext();
+}
+
+//Called every loop() pass
+void latencyBenchStep() {
+  unsigned long now = millis();
+  if (!benchRunning) {
+    if (benchDone || now < LATENCY_BENCH_START_MS) return;
+    for (int i = 0; i < MUXCHANNELS; i++) {
+      benchPots[0][i] = mux1ValuesPrev[i];
+      benchPots[1][i] = mux2ValuesPrev[i];
+      benchPots[2][i] = mux3ValuesPrev[i];
+    }
+#if LATENCY_BENCH_PIN >= 0
+    pinMode(LATENCY_BENCH_PIN, OUTPUT);
+#endif
+    Serial.println("latency_bench,load,samples,missing,p50_us,p90_us,p99_us,max_us");
+    benchRunning = true;
+  }
+
+  if (benchLoad == BENCH_FLOOD) {
+    for (int i = 0; i < LATENCY_BENCH_FLOOD; i++) {
+      myConvertControlChange(1, CCmodWheelinput, benchFloodValue++ & 0x7F);
+    }
+  }
+  if (benchLoad == BENCH_RECALL && now - benchRecallTime > LATENCY_BENCH_RECALL_MS && patches.size() > 0) {
+    benchRecallTime = now;
+    recallPatch(patches.first().patchNo);
+  }
+
+  if (benchWaiting) {
+    if (now - benchMoveTime > LATENCY_BENCH_TIMEOUT_MS) {
+      benchMissing++;
+      benchNext();
+    }
+    return;
+  }
+  if (now - benchMoveTime < LATENCY_BENCH_GAP_MS) return;
+
+  //Turn the knob, far enough that the pot thinning never holds it back
+  int &pot = benchPots[benchChannel / MUXCHANNELS][benchChannel % MUXCHANNELS];
+  pot = pot < 128 ? pot + 100 : pot - 100;
+  benchCC = LATENCY_BENCH_NO_CC;
+  benchMoveTime = now;
+  benchWaiting = true;
+#if LATENCY_BENCH_PIN >= 0
+  digitalWriteFast(LATENCY_BENCH_PIN, HIGH);
+#endif
+  benchStart = benchNow();
+}
+
+#endif
@@ -31,12 +31,20 @@
 #include <MIDI.h>
 #include <USBHost_t36.h>
 #include "MidiCC.h"
+#include "Profiler.h"
 #include "Constants.h"
 #include "Parameters.h"
 #include "PatchMgr.h"
 #include "HWControls.h"
+#include "MuxScan.h"
+#include "LatencyBench.h"
+#include "PotThinning.h"
+#include "MuxPots.h"
+#include "PanelIO.h"
+#include "PanelButtons.h"
+#include "PanelLEDs.h"
 #include "EepromMgr.h"
-#include <RoxMux.h>
+#include "Scheduler.h"
 
 #define PARAMETER 0      //The main page for displaying the current patch and control (parameter) changes
 #define RECALL 1         //Patches list
@@ -51,7 +59,9 @@
 
 unsigned int state = PARAMETER;
 
+#include "TextFormat.h"
 #include "ST7735Display.h"
+#include "DisplayModel.h"
 
 boolean cardStatus = false;
 
@@ -65,17 +75,22 @@ MIDIDevice midi1(myusb);
 MIDI_CREATE_INSTANCE(HardwareSerial, Serial1, MIDI);
 MIDI_CREATE_INSTANCE(HardwareSerial, Serial6, MIDI6);
 
-#define OCTO_TOTAL 10
+#include "MidiRouting.h"
+#include "MidiTraffic.h"
+#include "UsbMidiOut.h"
+#include "DinThinning.h"
+#include "MidiQueue.h"
+#include "MidiReplay.h"
+#include "MidiCCOut.h"
+
 #define BTN_DEBOUNCE 50
-RoxOctoswitch<OCTO_TOTAL, BTN_DEBOUNCE> octoswitch;
 
 // pins for 74HC165
 #define PIN_DATA 34  // pin 9 on 74HC165 (DATA)
 #define PIN_LOAD 35  // pin 1 on 74HC165 (LOAD)
 #define PIN_CLK 33   // pin 2 on 74HC165 (CLK))
 
-#define SR_TOTAL 10
-Rox74HC595<SR_TOTAL> sr;
+PanelIO sr;  //Both chains, refreshed from a timer
 
 // pins for 74HC595
 #define LED_DATA 21   // pin 14 on 74HC595 (DATA)
@@ -91,21 +106,26 @@ int patchNo = 1;               //Current patch no
 int voiceToReturn = -1;        //Initialise
 long earliestTime = millis();  //For voice allocation - initialise to now
 
+static unsigned long LCD_timer = 0;
+static unsigned long learn_timer = 0;
+static unsigned long maxVoices_timer = 0;
+static unsigned long arpRange_timer = 0;
+static unsigned long arpMode_timer = 0;
+static unsigned long reverbType_timer = 0;
+static unsigned long poly_timer = 0;
+static unsigned long mono_timer = 0;
+static long encPrevious = 0;
+
 void setup() {
   SPI.begin();
-  octoswitch.begin(PIN_DATA, PIN_LOAD, PIN_CLK);
-  octoswitch.setCallback(onButtonPress);
-  octoswitch.setIgnoreAfterHold(NUM_OF_VOICES_SW, true);
-  octoswitch.setIgnoreAfterHold(POLY_SW, true);
-  octoswitch.setIgnoreAfterHold(MONO_SW, true);
-  octoswitch.setIgnoreAfterHold(ARP_MODE_SW, true);
-  octoswitch.setIgnoreAfterHold(ARP_RANGE_SW, true);
-
-  octoswitch.setIgnoreAfterHold(REVERB_TYPE_SW, true);
   sr.begin(LED_DATA, LED_LATCH, LED_CLK, LED_PWM);
+  sr.beginButtons(PIN_DATA, PIN_LOAD, PIN_CLK);
+  sr.setInactiveLevel(LED_INACTIVE_LEVEL);
+  setupButtons(BTN_DEBOUNCE);
   setupDisplay();
   setUpSettings();
   setupHardware();
+  setupPotThinning();
 
   cardStatus = SD.begin(BUILTIN_SDCARD);
   if (cardStatus) {
@@ -127,45 +147,25 @@ void setup() {
   midiChannel = getMIDIChannel();
   Serial.println("MIDI Ch:" + String(midiChannel) + " (0 is Omni On)");
 
-  //Read UpdateParams type from EEPROM
-  updateParams = getUpdateParams();
-
-  //Read SendNotes type from EEPROM
-  sendNotes = getSendNotes();
+  //Read the MIDI routing matrix from EEPROM
+  setupMidiRouting();
 
   //USB HOST MIDI Class Compliant
   delay(400);  //Wait to turn on USB Host
   myusb.begin();
-  midi1.setHandleControlChange(myConvertControlChange);
-  midi1.setHandleProgramChange(myProgramChange);
-  midi1.setHandleNoteOff(myNoteOff);
-  midi1.setHandleNoteOn(myNoteOn);
-  midi1.setHandlePitchChange(myPitchBend);
-  midi1.setHandleAfterTouch(myAfterTouch);
-  Serial.println("USB HOST MIDI Class Compliant Listening");
-
-  //USB Client MIDI
-  usbMIDI.setHandleControlChange(myConvertControlChange);
-  usbMIDI.setHandleProgramChange(myProgramChange);
-  usbMIDI.setHandleNoteOff(myNoteOff);
-  usbMIDI.setHandleNoteOn(myNoteOn);
-  usbMIDI.setHandlePitchChange(myPitchBend);
-  usbMIDI.setHandleAfterTouch(myAfterTouch);
-  Serial.println("USB Client MIDI Listening");
 
   //MIDI 5 Pin DIN
   MIDI.begin();
-  MIDI.setHandleControlChange(myConvertControlChange);
-  MIDI.setHandleProgramChange(myProgramChange);
-  MIDI.setHandleNoteOn(myNoteOn);
-  MIDI.setHandleNoteOff(myNoteOff);
-  MIDI.setHandlePitchBend(myPitchBend);
-  MIDI.setHandleAfterTouchChannel(myAfterTouch);
-  Serial.println("MIDI In DIN Listening");
-
+  MIDI.turnThruOff();  //The passthrough forwards DIN input as routed, Thru would write Serial1 from the poll interrupt under a send from loop()
   MIDI6.begin();
+
+  setupMidiInputs();
+  Serial.println("USB HOST MIDI Class Compliant Listening");
+  Serial.println("USB Client MIDI Listening");
   Serial.println("MIDI In DIN Listening");
 
+  setupMidiPoll();  //The ports are read from a timer interrupt from here on
+
   //Read Encoder Direction from EEPROM
   encCW = getEncoderDir();
 
@@ -174,37 +174,24 @@ void setup() {
 
   recallPatch(patchNo);
   delay(20);
-  LCD.PCF8574_LCDClearScreen();
+  lcdClear();
+
+  setupScheduler();
 }
 
+//The note itself has been forwarded by the passthrough in MidiQueue.h
 void myNoteOn(byte channel, byte note, byte velocity) {
   if (learning) {
     learningNote = note;
     noteArrived = true;
   }
-  if (!learning) {
-    MIDI.sendNoteOn(note, velocity, channel);
-    if (sendNotes) {
-      usbMIDI.sendNoteOn(note, velocity, channel);
-    }
-  }
 
   if (chordMemoryWait) {
     chordMemoryWait = false;
-    sr.writePin(CHORD_MODE_LED, LOW);
     updateLoadingMessages("   CHORD MODE ON", "");
   }
 }
 
-void myNoteOff(byte channel, byte note, byte velocity) {
-  if (!learning) {
-    MIDI.sendNoteOff(note, velocity, channel);
-    if (sendNotes) {
-      usbMIDI.sendNoteOff(note, velocity, channel);
-    }
-  }
-}
-
 void convertIncomingNote() {
 
   if (learning && noteArrived) {
@@ -213,85 +200,36 @@ void convertIncomingNote() {
 }
 
 void myConvertControlChange(byte channel, byte number, byte value) {
+#ifdef DISPLAY_STATS
+  uint32_t start = ARM_DWT_CYCCNT;
+#endif
   int newvalue = value;
   myControlChange(channel, number, newvalue);
-}
-
-void myPitchBend(byte channel, int bend) {
-  MIDI.sendPitchBend(bend, channel);
-  if (sendNotes) {
-    usbMIDI.sendPitchBend(bend, channel);
-  }
-}
-
-void myAfterTouch(byte channel, byte pressure) {
-  MIDI.sendAfterTouch(pressure, channel);
-  if (sendNotes) {
-    usbMIDI.sendAfterTouch(pressure, channel);
-  }
-}
-
-void updateLoadingMessages(String val1, String val2) {
-  updateLoadingMessages(val1.c_str(), val2.c_str());
+#ifdef DISPLAY_STATS
+  displayRecordCC(ARM_DWT_CYCCNT - start);
+#endif
 }
 
 // For char* (including string literals)
 void updateLoadingMessages(const char* val1, const char* val2) {
-  LCD.PCF8574_LCDClearLine(LCD.LCDLineNumberOne);
-  LCD.PCF8574_LCDClearLine(LCD.LCDLineNumberTwo);
-  LCD.PCF8574_LCDGOTO(LCD.LCDLineNumberOne, 0);
-  LCD.PCF8574_LCDSendString(const_cast<char*>(val1));
-  LCD.PCF8574_LCDGOTO(LCD.LCDLineNumberTwo, 0);
-  LCD.PCF8574_LCDSendString(const_cast<char*>(val2));
+  cancelPotDisplay();
+  lcdClear();
+  lcdPrint(0, 0, val1);
+  lcdPrint(1, 0, val2);
   LCD_timer = millis();
-  oldWhichParameter = "Trash";
 }
 
-void updateMOOGstyle(int PREVparam, int value, String WhichParameter) {
+void updateMOOGstyle(int PREVparam, int value, const char *WhichParameter) {
   LCD_timer = millis();
-  if (WhichParameter.equals(oldWhichParameter)) {
-    char spaces2[] = "   ";
-    LCD.PCF8574_LCDGOTO(LCD.LCDLineNumberOne, 11);
-    LCD.PCF8574_LCDSendString(spaces2);
-  } else {
-    char spaces1[] = "                    ";
-    LCD.PCF8574_LCDClearLine(LCD.LCDLineNumberOne);
-    LCD.PCF8574_LCDGOTO(LCD.LCDLineNumberOne, 0);
-    LCD.PCF8574_LCDSendString(spaces1);
-    LCD.PCF8574_LCDClearLine(LCD.LCDLineNumberTwo);
-    LCD.PCF8574_LCDGOTO(LCD.LCDLineNumberTwo, 0);
-    LCD.PCF8574_LCDSendString(spaces1);
-    oldWhichParameter = WhichParameter;
-  }
-
-  String myString = String(PREVparam, DEC);
-  if (PREVparam < 10) {
-    myString = "00" + myString;
-  }
-  if (PREVparam < 100 && PREVparam > 9) {
-    myString = "0" + myString;
-  }
-  char myChar[4];
-  myString.toCharArray(myChar, sizeof(myChar));
-  LCD.PCF8574_LCDGOTO(LCD.LCDLineNumberOne, 6);
-  LCD.PCF8574_LCDSendString(myChar);
-
-  String myString2 = String(value, DEC);
-  if (value < 10) {
-    myString2 = "00" + myString2;
-  }
-  if (value < 100 && value > 9) {
-    myString2 = "0" + myString2;
-  }
-  char myChar2[4];
-  myString2.toCharArray(myChar2, sizeof(myChar2));
-  LCD.PCF8574_LCDGOTO(LCD.LCDLineNumberOne, 11);
-  LCD.PCF8574_LCDSendString(myChar2);
-
-  char destinationArray[WhichParameter.length() + 1];
-  WhichParameter.toCharArray(destinationArray, sizeof(destinationArray));
-  LCD.PCF8574_LCDGOTO(LCD.LCDLineNumberTwo, 0);
-  LCD.PCF8574_LCDSendString(destinationArray);
+  //Redrawn in full, lcdFlush() only sends the cells that changed
+  TextBuffer<4> number;
+  lcdClear();
+  number.addInt(PREVparam, 3);
+  lcdPrint(0, 6, number.c_str());
+  number.clear();
+  number.addInt(value, 3);
+  lcdPrint(0, 11, number.c_str());
+  lcdPrint(1, 0, WhichParameter);
 }
 
 void allNotesOff() {
@@ -364,7 +302,6 @@ void updatearpMode() {
   if (arpModeSW && !arpModeFirstPress) {
     arpMode_timer = millis();
     arpMode = 1;
-    sr.writePin(ARP_MODE_LED, HIGH);  // LED on
     if (!recallPatchFlag) {
       arpModeNames();
     }
@@ -395,7 +332,6 @@ void updatearpModeExitSW() {
     arpModeSW = 0;
     arpModeExitSW = 0;
     arpMode_timer = 0;
-    sr.writePin(ARP_MODE_LED, LOW);  // LED on
   }
 }
 
@@ -430,7 +366,6 @@ void updatearpRange() {
   if (arpRangeSW && !arpRangeFirstPress) {
     arpRange_timer = millis();
     arpRange = 1;
-    sr.writePin(ARP_RANGE_LED, HIGH);  // LED on
     if (!recallPatchFlag) {
       arpRangeDisplay();
     }
@@ -461,15 +396,13 @@ void updatearpRangeExitSW() {
     arpRangeSW = 0;
     arpRangeExitSW = 0;
     arpRange_timer = 0;
-    sr.writePin(ARP_RANGE_LED, LOW);  // LED on
   }
 }
 
 void updatemodWheel() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(modWheelPREV, modWheel100, "  Mod Wheel Amount");
-    showCurrentParameterPage("MW Amount", String(modWheelstr) + " %");
+    showPotParameter("MW Amount", modWheelstr, " %", modWheelPREV, modWheel100, "  Mod Wheel Amount");
   }
   midiCCOut(CCmodWheel, modWheel);
 }
@@ -492,8 +425,7 @@ void arpRangeDisplay() {
 void updateGlide() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(glidePREV, glide100, "     Glide Rate");
-    showCurrentParameterPage("Glide", String(glidestr) + " mS");
+    showPotParameter("Glide", glidestr, " mS", glidePREV, glide100, "     Glide Rate");
   }
   midiCCOut(CCglide, glide);
 }
@@ -501,8 +433,7 @@ void updateGlide() {
 void updatephaserSpeed() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(phaserSpeedPREV, phaserSpeed100, "    Phaser Rate");
-    showCurrentParameterPage("Phaser Rate", String(phaserSpeedstr) + " Hz");
+    showPotParameterCenti("Phaser Rate", phaserSpeedstr, " Hz", phaserSpeedPREV, phaserSpeed100, "    Phaser Rate");
   }
   midiCCOut(CCphaserSpeed, phaserSpeed);
 }
@@ -510,8 +441,7 @@ void updatephaserSpeed() {
 void updateensembleRate() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(ensembleRatePREV, ensembleRate100, "   Ensemble Rate");
-    showCurrentParameterPage("Ensemble Rate", String(ensembleRatestr) + " Hz");
+    showPotParameterCenti("Ensemble Rate", ensembleRatestr, " Hz", ensembleRatePREV, ensembleRate100, "   Ensemble Rate");
   }
   midiCCOut(CCensembleRate, ensembleRate);
 }
@@ -519,8 +449,7 @@ void updateensembleRate() {
 void updateensembleDepth() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(ensembleDepthPREV, ensembleDepth100, "   Ensemble Depth");
-    showCurrentParameterPage("Ens. Depth", String(ensembleDepthstr) + " %");
+    showPotParameterCenti("Ens. Depth", ensembleDepthstr, " %", ensembleDepthPREV, ensembleDepth100, "   Ensemble Depth");
   }
   midiCCOut(CCensembleDepth, ensembleDepth);
 }
@@ -528,8 +457,7 @@ void updateensembleDepth() {
 void updateuniDetune() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(uniDetunePREV, uniDetune100, "    Unison Detune");
-    showCurrentParameterPage("Unison Detune", String(uniDetunestr) + " %");
+    showPotParameter("Unison Detune", uniDetunestr, " %", uniDetunePREV, uniDetune100, "    Unison Detune");
   }
   midiCCOut(CCuniDetune, uniDetune);
 }
@@ -537,8 +465,7 @@ void updateuniDetune() {
 void updatebendDepth() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(bendDepthPREV, bendDepth100, "     Bend Depth");
-    showCurrentParameterPage("Bend Depth", String(bendDepthstr) + " SemiTones");
+    showPotParameter("Bend Depth", bendDepthstr, " SemiTones", bendDepthPREV, bendDepth100, "     Bend Depth");
   }
   midiCCOut(CCbendDepth, bendDepth);
 }
@@ -546,8 +473,7 @@ void updatebendDepth() {
 void updatelfoOsc3() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(lfoOsc3PREV, lfoOsc3100, "  Osc3 Modulation");
-    showCurrentParameterPage("Osc3 Mod.", String(lfoOsc3str) + " %");
+    showPotParameter("Osc3 Mod.", lfoOsc3str, " %", lfoOsc3PREV, lfoOsc3100, "  Osc3 Modulation");
   }
   midiCCOut(CClfoOsc3, lfoOsc3);
 }
@@ -555,8 +481,7 @@ void updatelfoOsc3() {
 void updatelfoFilterContour() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(lfoFilterContourPREV, lfoFilterContour100, "   Filter Contour");
-    showCurrentParameterPage("Filter Contour", String(lfoFilterContourstr) + " %");
+    showPotParameter("Filter Contour", lfoFilterContourstr, " %", lfoFilterContourPREV, lfoFilterContour100, "   Filter Contour");
   }
   midiCCOut(CClfoFilterContour, lfoFilterContour);
 }
@@ -564,8 +489,7 @@ void updatelfoFilterContour() {
 void updatephaserDepth() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(phaserDepthPREV, phaserDepth100, "    Phaser Depth");
-    showCurrentParameterPage("Phaser Depth", String(phaserDepthstr) + " %");
+    showPotParameter("Phaser Depth", phaserDepthstr, " %", phaserDepthPREV, phaserDepth100, "    Phaser Depth");
   }
   midiCCOut(CCphaserDepth, phaserDepth);
 }
@@ -573,8 +497,7 @@ void updatephaserDepth() {
 void updatelfoInitialAmount() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(lfoInitialAmountPREV, lfoInitialAmount100, " LFO Initial Amount");
-    showCurrentParameterPage("LFO Init Amnt", String(lfoInitialAmountstr) + " %");
+    showPotParameter("LFO Init Amnt", lfoInitialAmountstr, " %", lfoInitialAmountPREV, lfoInitialAmount100, " LFO Initial Amount");
   }
   midiCCOut(CClfoInitialAmount, lfoInitialAmount);
 }
@@ -582,8 +505,7 @@ void updatelfoInitialAmount() {
 void updateosc2Frequency() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(osc2FrequencyPREV, osc2Frequency100, "   OSC2 Frequency");
-    showCurrentParameterPage("OSC2 Freq.", String(osc2Frequencystr) + " Semi");
+    showPotParameterCenti("OSC2 Freq.", osc2Frequencystr, " Semi", osc2FrequencyPREV, osc2Frequency100, "   OSC2 Frequency");
   }
   midiCCOut(CCosc2Frequency, osc2Frequency);
 }
@@ -591,8 +513,7 @@ void updateosc2Frequency() {
 void updateosc1PW() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(osc1PWPREV, osc1PW100, "  OSC1 Pulse Width");
-    showCurrentParameterPage("OSC1 PW", String(osc1PWstr) + " %");
+    showPotParameterCenti("OSC1 PW", osc1PWstr, " %", osc1PWPREV, osc1PW100, "  OSC1 Pulse Width");
   }
   midiCCOut(CCosc1PW, osc1PW);
 }
@@ -600,8 +521,7 @@ void updateosc1PW() {
 void updateosc2PW() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(osc2PWPREV, osc2PW100, "  OSC2 Pulse Width");
-    showCurrentParameterPage("OSC2 PW", String(osc2PWstr) + " %");
+    showPotParameterCenti("OSC2 PW", osc2PWstr, " %", osc2PWPREV, osc2PW100, "  OSC2 Pulse Width");
   }
   midiCCOut(CCosc2PW, osc2PW);
 }
@@ -609,8 +529,7 @@ void updateosc2PW() {
 void updateosc3PW() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(osc3PWPREV, osc3PW100, "  OSC3 Pulse Width");
-    showCurrentParameterPage("OSC3 PW", String(osc3PWstr) + " %");
+    showPotParameterCenti("OSC3 PW", osc3PWstr, " %", osc3PWPREV, osc3PW100, "  OSC3 Pulse Width");
   }
   midiCCOut(CCosc3PW, osc3PW);
 }
@@ -618,8 +537,7 @@ void updateosc3PW() {
 void updatelfoSpeed() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(lfoSpeedPREV, lfoSpeed100, "      LFO Rate");
-    showCurrentParameterPage("LFO Speed", String(lfoSpeedstr) + " Hz");
+    showPotParameterCenti("LFO Speed", lfoSpeedstr, " Hz", lfoSpeedPREV, lfoSpeed100, "      LFO Rate");
   }
   midiCCOut(CClfoSpeed, lfoSpeed);
 }
@@ -627,8 +545,7 @@ void updatelfoSpeed() {
 void updateposc1PW() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(osc1PWPREV, osc1PW100, "  OSC1 Pulse Width");
-    showCurrentParameterPage("Osc1 PW", String(osc1PWstr) + " %");
+    showPotParameterCenti("Osc1 PW", osc1PWstr, " %", osc1PWPREV, osc1PW100, "  OSC1 Pulse Width");
   }
   midiCCOut(CCosc1PW, osc1PW);
 }
@@ -636,8 +553,7 @@ void updateposc1PW() {
 void updateosc3Frequency() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(osc3FrequencyPREV, osc3Frequency100, "   OSC3 Frequency");
-    showCurrentParameterPage("OSC3 Freq.", String(osc3Frequencystr) + " Semi");
+    showPotParameterCenti("OSC3 Freq.", osc3Frequencystr, " Semi", osc3FrequencyPREV, osc3Frequency100, "   OSC3 Frequency");
   }
   midiCCOut(CCosc3Frequency, osc3Frequency);
 }
@@ -645,8 +561,7 @@ void updateosc3Frequency() {
 void updateechoTime() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(echoTimePREV, echoTime100, "     Echo Time");
-    showCurrentParameterPage("Echo Time", String(echoTimestr) + " ms");
+    showPotParameterCenti("Echo Time", echoTimestr, " ms", echoTimePREV, echoTime100, "     Echo Time");
   }
   midiCCOut(CCechoTime, echoTime);
 }
@@ -654,8 +569,7 @@ void updateechoTime() {
 void updateechoSpread() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(echoSpreadPREV, echoSpread100, "     Echo Spread");
-    showCurrentParameterPage("Echo Spread", String(echoSpreadstr) + " ms");
+    showPotParameterCenti("Echo Spread", echoSpreadstr, " ms", echoSpreadPREV, echoSpread100, "     Echo Spread");
   }
   midiCCOut(CCechoSpread, echoSpread);
 }
@@ -663,8 +577,7 @@ void updateechoSpread() {
 void updateechoRegen() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(echoRegenPREV, echoRegen100, "     Echo Regen");
-    showCurrentParameterPage("Echo Regen", String(echoRegenstr) + " %");
+    showPotParameterCenti("Echo Regen", echoRegenstr, " %", echoRegenPREV, echoRegen100, "     Echo Regen");
   }
   midiCCOut(CCechoRegen, echoRegen);
 }
@@ -672,8 +585,7 @@ void updateechoRegen() {
 void updateechoDamp() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(echoDampPREV, echoDamp100, "     Echo Damp");
-    showCurrentParameterPage("Echo Damp", String(echoDampstr) + " %");
+    showPotParameterCenti("Echo Damp", echoDampstr, " %", echoDampPREV, echoDamp100, "     Echo Damp");
   }
   midiCCOut(CCechoDamp, echoDamp);
 }
@@ -681,8 +593,7 @@ void updateechoDamp() {
 void updateechoLevel() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(echoLevelPREV, echoLevel100, "     Echo Level");
-    showCurrentParameterPage("Echo Level", String(echoLevelstr) + " %");
+    showPotParameterCenti("Echo Level", echoLevelstr, " %", echoLevelPREV, echoLevel100, "     Echo Level");
   }
   midiCCOut(CCechoLevel, echoLevel);
 }
@@ -690,8 +601,7 @@ void updateechoLevel() {
 void updatenoise() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(noisePREV, noise100, "     Noise Level");
-    showCurrentParameterPage("Noise Level", String(noisestr) + " %");
+    showPotParameterCenti("Noise Level", noisestr, " %", noisePREV, noise100, "     Noise Level");
   }
   midiCCOut(CCnoise, noise);
 }
@@ -699,8 +609,7 @@ void updatenoise() {
 void updateosc3Level() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(osc3LevelPREV, osc3Level100, "     OSC3 Level");
-    showCurrentParameterPage("OSC3 Level", String(osc3Levelstr) + " %");
+    showPotParameterCenti("OSC3 Level", osc3Levelstr, " %", osc3LevelPREV, osc3Level100, "     OSC3 Level");
   }
   midiCCOut(CCosc3Level, osc3Level);
 }
@@ -708,8 +617,7 @@ void updateosc3Level() {
 void updateosc2Level() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(osc2LevelPREV, osc2Level100, "     OSC2 Level");
-    showCurrentParameterPage("OSC2 Level", String(osc2Levelstr) + " %");
+    showPotParameterCenti("OSC2 Level", osc2Levelstr, " %", osc2LevelPREV, osc2Level100, "     OSC2 Level");
   }
   midiCCOut(CCosc2Level, osc2Level);
 }
@@ -717,8 +625,7 @@ void updateosc2Level() {
 void updateosc1Level() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(osc1LevelPREV, osc1Level100, "     OSC1 Level");
-    showCurrentParameterPage("OSC1 Level", String(osc1Levelstr) + " %");
+    showPotParameterCenti("OSC1 Level", osc1Levelstr, " %", osc1LevelPREV, osc1Level100, "     OSC1 Level");
   }
   midiCCOut(CCosc1Level, osc1Level);
 }
@@ -726,8 +633,7 @@ void updateosc1Level() {
 void updatefilterCutoff() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(filterCutoffPREV, filterCutoff100, "   Filter Cutoff");
-    showCurrentParameterPage("Filter Cutoff", String(filterCutoffstr) + " Hz");
+    showPotParameterCenti("Filter Cutoff", filterCutoffstr, " Hz", filterCutoffPREV, filterCutoff100, "   Filter Cutoff");
   }
   midiCCOut(CCfilterCutoff, filterCutoff);
 }
@@ -735,8 +641,7 @@ void updatefilterCutoff() {
 void updateemphasis() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(emphasisPREV, emphasis100, "   Filter Emphasis");
-    showCurrentParameterPage("Filter Emphasis", String(emphasisstr) + " %");
+    showPotParameterCenti("Filter Emphasis", emphasisstr, " %", emphasisPREV, emphasis100, "   Filter Emphasis");
   }
   midiCCOut(CCemphasis, emphasis);
 }
@@ -744,8 +649,7 @@ void updateemphasis() {
 void updatevcfAttack() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(vcfAttackPREV, vcfAttack100, "   Filter Attack");
-    showCurrentParameterPage("Filter Attack", String(vcfAttackstr) + " mS");
+    showPotParameterCenti("Filter Attack", vcfAttackstr, " mS", vcfAttackPREV, vcfAttack100, "   Filter Attack");
   }
   midiCCOut(CCvcfAttack, vcfAttack);
 }
@@ -753,8 +657,7 @@ void updatevcfAttack() {
 void updatevcfDecay() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(vcfDecayPREV, vcfDecay100, "   Filter Decay");
-    showCurrentParameterPage("Filter Decay", String(vcfDecaystr) + " mS");
+    showPotParameterCenti("Filter Decay", vcfDecaystr, " mS", vcfDecayPREV, vcfDecay100, "   Filter Decay");
   }
   midiCCOut(CCvcfDecay, vcfDecay);
 }
@@ -762,8 +665,7 @@ void updatevcfDecay() {
 void updatevcfSustain() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(vcfSustainPREV, vcfSustain100, "   Filter Sustain");
-    showCurrentParameterPage("Filter Sustain", String(vcfSustainstr) + " %");
+    showPotParameterCenti("Filter Sustain", vcfSustainstr, " %", vcfSustainPREV, vcfSustain100, "   Filter Sustain");
   }
   midiCCOut(CCvcfSustain, vcfSustain);
 }
@@ -771,8 +673,7 @@ void updatevcfSustain() {
 void updatevcfRelease() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(vcfReleasePREV, vcfRelease100, "   Filter Release");
-    showCurrentParameterPage("Filter Release", String(vcfReleasestr) + " mS");
+    showPotParameterCenti("Filter Release", vcfReleasestr, " mS", vcfReleasePREV, vcfRelease100, "   Filter Release");
   }
   midiCCOut(CCvcfRelease, vcfRelease);
 }
@@ -780,8 +681,7 @@ void updatevcfRelease() {
 void updatevcfContourAmount() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(vcfContourAmountPREV, vcfContourAmount100, "Filter Contour Amnt");
-    showCurrentParameterPage("Filt Cont Amt", String(vcfContourAmountstr) + " %");
+    showPotParameterCenti("Filt Cont Amt", vcfContourAmountstr, " %", vcfContourAmountPREV, vcfContourAmount100, "Filter Contour Amnt");
   }
   midiCCOut(CCvcfContourAmount, vcfContourAmount);
 }
@@ -789,8 +689,7 @@ void updatevcfContourAmount() {
 void updatekbTrack() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(kbTrackPREV, kbTrack100, " Keyboard Tracking");
-    showCurrentParameterPage("Key Track", String(kbTrackstr) + " %");
+    showPotParameterCenti("Key Track", kbTrackstr, " %", kbTrackPREV, kbTrack100, " Keyboard Tracking");
   }
   midiCCOut(CCkbTrack, kbTrack);
 }
@@ -798,8 +697,7 @@ void updatekbTrack() {
 void updatevcaAttack() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(vcaAttackPREV, vcaAttack100, "     Amp Attack");
-    showCurrentParameterPage("Amp Attack", String(vcaAttackstr) + " mS");
+    showPotParameterCenti("Amp Attack", vcaAttackstr, " mS", vcaAttackPREV, vcaAttack100, "     Amp Attack");
   }
   midiCCOut(CCvcaAttack, vcaAttack);
 }
@@ -807,8 +705,7 @@ void updatevcaAttack() {
 void updatevcaDecay() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(vcaDecayPREV, vcaDecay100, "     Amp Decay");
-    showCurrentParameterPage("Amp Decay", String(vcaDecaystr) + " mS");
+    showPotParameterCenti("Amp Decay", vcaDecaystr, " mS", vcaDecayPREV, vcaDecay100, "     Amp Decay");
   }
   midiCCOut(CCvcaDecay, vcaDecay);
 }
@@ -816,8 +713,7 @@ void updatevcaDecay() {
 void updatevcaSustain() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(vcaSustainPREV, vcaSustain100, "    Amp Sustain");
-    showCurrentParameterPage("Amp Sustain", String(vcaSustainstr) + " %");
+    showPotParameterCenti("Amp Sustain", vcaSustainstr, " %", vcaSustainPREV, vcaSustain100, "    Amp Sustain");
   }
   midiCCOut(CCvcaSustain, vcaSustain);
 }
@@ -825,8 +721,7 @@ void updatevcaSustain() {
 void updatevcaRelease() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(vcaReleasePREV, vcaRelease100, "    Amp Release");
-    showCurrentParameterPage("Amp Release", String(vcaReleasestr) + " mS");
+    showPotParameterCenti("Amp Release", vcaReleasestr, " mS", vcaReleasePREV, vcaRelease100, "    Amp Release");
   }
   midiCCOut(CCvcaRelease, vcaRelease);
 }
@@ -834,8 +729,7 @@ void updatevcaRelease() {
 void updatevcaVelocity() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(vcaVelocityPREV, vcaVelocity100, "   Amp Velocity");
-    showCurrentParameterPage("Amp Velocity", String(vcaVelocitystr) + " %");
+    showPotParameterCenti("Amp Velocity", vcaVelocitystr, " %", vcaVelocityPREV, vcaVelocity100, "   Amp Velocity");
   }
   midiCCOut(CCvcaVelocity, vcaVelocity);
 }
@@ -843,8 +737,7 @@ void updatevcaVelocity() {
 void updatevcfVelocity() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(vcfVelocityPREV, vcfVelocity100, "  Filter Velocity");
-    showCurrentParameterPage("Filter Velocity", String(vcfVelocitystr) + " %");
+    showPotParameterCenti("Filter Velocity", vcfVelocitystr, " %", vcfVelocityPREV, vcfVelocity100, "  Filter Velocity");
   }
   midiCCOut(CCvcfVelocity, vcfVelocity);
 }
@@ -852,8 +745,7 @@ void updatevcfVelocity() {
 void updatereverbDecay() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(reverbDecayPREV, reverbDecay100, "   Reverb Decay");
-    showCurrentParameterPage("Reverb Decay", String(reverbDecaystr) + " %");
+    showPotParameterCenti("Reverb Decay", reverbDecaystr, " %", reverbDecayPREV, reverbDecay100, "   Reverb Decay");
   }
   midiCCOut(CCreverbDecay, reverbDecay);
 }
@@ -861,8 +753,7 @@ void updatereverbDecay() {
 void updatereverbDamp() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(reverbDampPREV, reverbDamp100, "    Reverb Damp");
-    showCurrentParameterPage("Reverb Damp", String(reverbDampstr) + " %");
+    showPotParameterCenti("Reverb Damp", reverbDampstr, " %", reverbDampPREV, reverbDamp100, "    Reverb Damp");
   }
   midiCCOut(CCreverbDamp, reverbDamp);
 }
@@ -870,8 +761,7 @@ void updatereverbDamp() {
 void updatereverbLevel() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(reverbLevelPREV, reverbLevel100, "     Reverb Mix");
-    showCurrentParameterPage("Reverb Mix", String(reverbLevelstr) + " %");
+    showPotParameterCenti("Reverb Mix", reverbLevelstr, " %", reverbLevelPREV, reverbLevel100, "     Reverb Mix");
   }
   midiCCOut(CCreverbLevel, reverbLevel);
 }
@@ -879,8 +769,7 @@ void updatereverbLevel() {
 void updatedriftAmount() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(driftAmountPREV, driftAmount100, "    Drift Amount");
-    showCurrentParameterPage("Drift Amount", String(driftAmountstr) + " %");
+    showPotParameterCenti("Drift Amount", driftAmountstr, " %", driftAmountPREV, driftAmount100, "    Drift Amount");
   }
   midiCCOut(CCdriftAmount, driftAmount);
 }
@@ -888,8 +777,7 @@ void updatedriftAmount() {
 void updatearpSpeed() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(arpSpeedPREV, arpSpeed100, "     Arp Rate");
-    showCurrentParameterPage("Arp Rate", String(arpSpeedstr) + " Hz");
+    showPotParameterCenti("Arp Rate", arpSpeedstr, " Hz", arpSpeedPREV, arpSpeed100, "     Arp Rate");
   }
   midiCCOut(CCarpSpeed, arpSpeed);
 }
@@ -897,8 +785,7 @@ void updatearpSpeed() {
 void updatemasterTune() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(masterTunePREV, masterTune100, "    Master Tune");
-    showCurrentParameterPage("Master Tune", String(masterTunestr) + " Semi");
+    showPotParameterCenti("Master Tune", masterTunestr, " Semi", masterTunePREV, masterTune100, "    Master Tune");
   }
   midiCCOut(CCmasterTune, masterTune);
 }
@@ -906,8 +793,7 @@ void updatemasterTune() {
 void updatemasterVolume() {
   pot = true;
   if (!recallPatchFlag) {
-    updateMOOGstyle(masterVolumePREV, masterVolume100, "    Master Volume");
-    showCurrentParameterPage("Master Volume", String(masterVolumestr) + " %");
+    showPotParameterCenti("Master Volume", masterVolumestr, " %", masterVolumePREV, masterVolume100, "    Master Volume");
   }
   midiCCOut(CCmasterVolume, masterVolume);
 }
@@ -919,11 +805,9 @@ void updatelfoInvert() {
     if (!recallPatchFlag) {
       updateLoadingMessages("       INVERT", "");
     }
-    sr.writePin(LFO_INVERT_LED, HIGH);
     midiCCOut(CClfoInvert, 127);
     midiCCOut(CClfoInvert, 0);
   } else {
-    sr.writePin(LFO_INVERT_LED, LOW);
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CClfoInvert, 127);
@@ -938,11 +822,9 @@ void updatecontourOsc3Amt() {
     if (!recallPatchFlag) {
       updateLoadingMessages("   CONTOURED OSC", "      3 AMOUNT");
     }
-    sr.writePin(CONT_OSC3_AMOUNT_LED, HIGH);
     midiCCOut(CCcontourOsc3Amt, 127);
     midiCCOut(CCcontourOsc3Amt, 0);
   } else {
-    sr.writePin(CONT_OSC3_AMOUNT_LED, LOW);
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCcontourOsc3Amt, 127);
@@ -957,11 +839,9 @@ void updatevoiceModToFilter() {
     if (!recallPatchFlag) {
       updateLoadingMessages("VOICE MOD TO FILTER", "");
     }
-    sr.writePin(VOICE_MOD_DEST_FILTER_LED, HIGH);
     midiCCOut(CCvoiceModToFilter, 127);
     midiCCOut(CCvoiceModToFilter, 0);
   } else {
-    sr.writePin(VOICE_MOD_DEST_FILTER_LED, LOW);
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCvoiceModToFilter, 127);
@@ -976,11 +856,9 @@ void updatevoiceModToPW2() {
     if (!recallPatchFlag) {
       updateLoadingMessages("  VOICE MOD TO PW2", "");
     }
-    sr.writePin(VOICE_MOD_DEST_PW2_LED, HIGH);
     midiCCOut(CCvoiceModToPW2, 127);
     midiCCOut(CCvoiceModToPW2, 0);
   } else {
-    sr.writePin(VOICE_MOD_DEST_PW2_LED, LOW);
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCvoiceModToPW2, 127);
@@ -995,11 +873,9 @@ void updatevoiceModToPW1() {
     if (!recallPatchFlag) {
       updateLoadingMessages("  VOICE MOD TO PW1", "");
     }
-    sr.writePin(VOICE_MOD_DEST_PW1_LED, HIGH);
     midiCCOut(CCvoiceModToPW1, 127);
     midiCCOut(CCvoiceModToPW1, 0);
   } else {
-    sr.writePin(VOICE_MOD_DEST_PW1_LED, LOW);
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCvoiceModToPW1, 127);
@@ -1014,11 +890,9 @@ void updatevoiceModToOsc2() {
     if (!recallPatchFlag) {
       updateLoadingMessages(" VOICE MOD TO OSC2", "");
     }
-    sr.writePin(VOICE_MOD_DEST_OSC2_LED, HIGH);
     midiCCOut(CCvoiceModToOsc2, CC_ON);
     midiCCOut(CCvoiceModToOsc2, 0);
   } else {
-    sr.writePin(VOICE_MOD_DEST_OSC2_LED, LOW);
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCvoiceModToOsc2, 127);
@@ -1033,11 +907,9 @@ void updatevoiceModToOsc1() {
     if (!recallPatchFlag) {
       updateLoadingMessages(" VOICE MOD TO OSC1", "");
     }
-    sr.writePin(VOICE_MOD_DEST_OSC1_LED, HIGH);  // LED on
     midiCCOut(CCvoiceModToOsc1, CC_ON);
     midiCCOut(CCvoiceModToOsc1, 0);
   } else {
-    sr.writePin(VOICE_MOD_DEST_OSC1_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCvoiceModToOsc1, 127);
@@ -1052,11 +924,9 @@ void updatearpOnSW() {
     if (!recallPatchFlag) {
       updateLoadingMessages("   ARPEGGIATOR ON", "");
     }
-    sr.writePin(ARP_ON_OFF_LED, HIGH);  // LED on
     midiCCOut(CCarpOnSW, 127);
     midiCCOut(CCarpOnSW, 0);
   } else {
-    sr.writePin(ARP_ON_OFF_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCarpOnSW, 127);
@@ -1071,11 +941,9 @@ void updatearpHold() {
     if (!recallPatchFlag) {
       updateLoadingMessages("  ARPEGGIATOR HOLD", "");
     }
-    sr.writePin(ARP_HOLD_LED, HIGH);  // LED on
     midiCCOut(CCarpHold, 127);
     midiCCOut(CCarpHold, 0);
   } else {
-    sr.writePin(ARP_HOLD_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCarpHold, 127);
@@ -1090,11 +958,9 @@ void updatearpSync() {
     if (!recallPatchFlag) {
       updateLoadingMessages("  ARPEGGIATOR SYNC", "");
     }
-    sr.writePin(ARP_SYNC_LED, HIGH);  // LED on
     midiCCOut(CCarpSync, 127);
     midiCCOut(CCarpSync, 0);
   } else {
-    sr.writePin(ARP_SYNC_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCarpSync, 127);
@@ -1104,7 +970,6 @@ void updatearpSync() {
 }
 
 void updatemultTrig() {
-  sr.writePin(MULT_TRIG_LED, HIGH);  // LED on
   midiCCOut(CCmultTrig, 127);
   midiCCOut(CCmultTrig, 0);
 }
@@ -1116,12 +981,10 @@ void updatemultTrigSW() {
       if (!recallPatchFlag) {
         updateLoadingMessages("  MULTIPLE TRIGGER", "");
       }
-      sr.writePin(MULT_TRIG_LED, HIGH);  // LED on
       midiCCOut(CCmultTrig, 127);
       midiCCOut(CCmultTrig, 0);
     }
     if (!multTrig) {
-      sr.writePin(MULT_TRIG_LED, LOW);  // LED off
       if (!recallPatchFlag) {
         updateLoadingMessages("", "");
       }
@@ -1129,9 +992,6 @@ void updatemultTrigSW() {
       midiCCOut(CCmultTrig, 0);
     }
   }
-  if (polyMode) {
-    sr.writePin(MULT_TRIG_LED, LOW);  // LED off#
-  }
 }
 
 void updatenumberOfVoicesSetting() {
@@ -1162,15 +1022,12 @@ void updatenumberOfVoicesSetting() {
 
 void updatenumberOfVoices() {
   pot = false;
-  String myString = "      ";
+  TextBuffer<21> voicesText;
   if (maxVoicesSW && !maxVoicesFirstPress) {
-    sr.writePin(NUM_OF_VOICES_LED, HIGH);  // LED on
     maxVoices_timer = millis();
     maxVoices = 2;
-    myString += String(maxVoices);
-    myString = myString + " VOICES";
-    const char* myChar = myString.c_str();
-    updateLoadingMessages(myChar, "");
+    voicesText.add("      ").addInt(maxVoices).add(" VOICES");
+    updateLoadingMessages(voicesText.c_str(), "");
     midi6CCOut(MIDImaxVoicesSW, 127);
     midi6CCOut(MIDIDownArrow, 127);
     maxVoicesFirstPress++;
@@ -1179,10 +1036,8 @@ void updatenumberOfVoices() {
     if (maxVoices > 16) {
       maxVoices = 2;
     }
-    myString += String(maxVoices);
-    myString = myString + " VOICES";
-    const char* myChar = myString.c_str();
-    updateLoadingMessages(myChar, "");
+    voicesText.add("      ").addInt(maxVoices).add(" VOICES");
+    updateLoadingMessages(voicesText.c_str(), "");
     midi6CCOut(MIDIDownArrow, 127);
     maxVoicesFirstPress++;
     maxVoices_timer = millis();
@@ -1191,27 +1046,22 @@ void updatenumberOfVoices() {
 
 void updatemaxVoicesExitSW() {
   pot = false;
-  String myString = "      ";
+  TextBuffer<21> voicesText;
   if (maxVoicesExitSW) {
 
-    myString += String(maxVoices);
-    myString = myString + " VOICES";
-    const char* myChar = myString.c_str();
-    updateLoadingMessages(myChar, "");
+    voicesText.add("      ").addInt(maxVoices).add(" VOICES");
+    updateLoadingMessages(voicesText.c_str(), "");
 
     midi6CCOut(MIDIEnter, 127);
     maxVoicesFirstPress = 0;
     maxVoicesSW = 0;
     maxVoicesExitSW = 0;
     maxVoices_timer = 0;
-    sr.writePin(NUM_OF_VOICES_LED, LOW);  // LED on
   }
 }
 
 void updateMonoSetting() {
   if (monoMode) {
-    sr.writePin(MONO_LED, HIGH);  // LED on
-    sr.writePin(POLY_LED, LOW);   // LED off
     if (!recallPatchFlag) {
       setMonoModeDisplay();
     }
@@ -1246,9 +1096,6 @@ void updateMonoSetting() {
 
 void updatePolySetting() {
   if (polyMode) {
-    sr.writePin(POLY_LED, HIGH);  // LED on
-    sr.writePin(MONO_LED, LOW);   // LED off
-    sr.writePin(MULT_TRIG_LED, LOW);
     if (!recallPatchFlag) {
       setPolyModeDisplay();
     }
@@ -1315,8 +1162,6 @@ void updatemonoExitSW() {
       setMonoModeDisplay();
     }
     midi6CCOut(MIDIEnter, 127);
-    sr.writePin(MONO_LED, HIGH);  // LED on
-    sr.writePin(POLY_LED, LOW);   // LED on
     monoMode = 1;
     polyMode = 0;
     monoFirstPress = 0;
@@ -1361,8 +1206,6 @@ void updatepolyExitSW() {
       setPolyModeDisplay();
     }
     midi6CCOut(MIDIEnter, 127);
-    sr.writePin(POLY_LED, HIGH);  // LED on
-    sr.writePin(MONO_LED, LOW);   // LED on
     monoMode = 0;
     polyMode = 1;
     polyFirstPress = 0;
@@ -1415,7 +1258,6 @@ void sendEscapeKey() {
     midi6CCOut(MIDIEscape, 127);
     maxVoices_timer = 0;
     maxVoicesFirstPress = 0;
-    sr.writePin(NUM_OF_VOICES_LED, LOW);  // LED on
   }
 
   if ((poly_timer > 0) && (millis() - poly_timer > 3000)) {
@@ -1452,27 +1294,23 @@ void sendEscapeKey() {
     midi6CCOut(MIDIEscape, 127);
     arpRange_timer = 0;
     arpRangeFirstPress = 0;
-    sr.writePin(ARP_RANGE_LED, LOW);  // LED on
   }
 
   if ((arpMode_timer > 0) && (millis() - arpMode_timer > 3000)) {
     midi6CCOut(MIDIEscape, 127);
     arpMode_timer = 0;
     arpModeFirstPress = 0;
-    sr.writePin(ARP_MODE_LED, LOW);  // LED on
   }
 
   if ((reverbType_timer > 0) && (millis() - reverbType_timer > 3000)) {
     midi6CCOut(MIDIEscape, 127);
     reverbType_timer = 0;
     reverbTypeFirstPress = 0;
-    sr.writePin(REVERB_TYPE_LED, LOW);  // LED on
   }
 
   if ((LCD_timer > 0) && (millis() - LCD_timer > 10000)) {
     LCD_timer = 0;
-    LCD.PCF8574_LCDClearLine(LCD.LCDLineNumberOne);
-    LCD.PCF8574_LCDClearLine(LCD.LCDLineNumberTwo);
+    lcdClear();
   }
 }
 
@@ -1482,11 +1320,9 @@ void updateglideSW() {
     if (!recallPatchFlag) {
       updateLoadingMessages("      GLIDE ON", "");
     }
-    sr.writePin(GLIDE_LED, HIGH);  // LED on
     midiCCOut(CCglideSW, 127);
     midiCCOut(CCglideSW, 0);
   } else {
-    sr.writePin(GLIDE_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCglideSW, 127);
@@ -1497,9 +1333,6 @@ void updateglideSW() {
 
 void updateoctaveDown() {
   if (octaveDown) {
-    sr.writePin(OCTAVE_PLUS_LED, LOW);
-    sr.writePin(OCTAVE_ZERO_LED, LOW);
-    sr.writePin(OCTAVE_MINUS_LED, HIGH);
     octaveNormal = 0;
     octaveUp = 0;
     midiCCOut(CCoctaveDown, 127);
@@ -1508,9 +1341,6 @@ void updateoctaveDown() {
 
 void updateoctaveNormal() {
   if (octaveNormal) {
-    sr.writePin(OCTAVE_PLUS_LED, LOW);
-    sr.writePin(OCTAVE_ZERO_LED, HIGH);
-    sr.writePin(OCTAVE_MINUS_LED, LOW);
     octaveDown = 0;
     octaveUp = 0;
     midiCCOut(CCoctaveNormal, 127);
@@ -1519,9 +1349,6 @@ void updateoctaveNormal() {
 
 void updateoctaveUp() {
   if (octaveUp) {
-    sr.writePin(OCTAVE_PLUS_LED, HIGH);
-    sr.writePin(OCTAVE_ZERO_LED, LOW);
-    sr.writePin(OCTAVE_MINUS_LED, LOW);
     octaveDown = 0;
     octaveNormal = 0;
     midiCCOut(CCoctaveUp, 127);
@@ -1536,11 +1363,9 @@ void updatechordMode() {
       chordMemoryWait = true;
       learn_timer = millis();
     }
-    sr.writePin(CHORD_MODE_LED, HIGH);  // LED on
     midiCCOut(CCchordMode, 127);
     midiCCOut(CCchordMode, 0);
   } else {
-    sr.writePin(CHORD_MODE_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("   CHORD MODE OFF", "");
       midiCCOut(CCchordMode, 127);
@@ -1556,11 +1381,6 @@ void updatelfoSaw() {
     if (!recallPatchFlag) {
       updateLoadingMessages("      LFO SAW", "");
     }
-    sr.writePin(LFO_TRIANGLE_LED, LOW);
-    sr.writePin(LFO_SAW_LED, HIGH);
-    sr.writePin(LFO_RAMP_LED, LOW);
-    sr.writePin(LFO_SQUARE_LED, LOW);
-    sr.writePin(LFO_SAMPLE_HOLD_LED, LOW);
     lfoTriangle = 0;
     lfoRamp = 0;
     lfoSquare = 0;
@@ -1575,11 +1395,6 @@ void updatelfoTriangle() {
     if (!recallPatchFlag) {
       updateLoadingMessages("    LFO TRIANGLE", "");
     }
-    sr.writePin(LFO_TRIANGLE_LED, HIGH);
-    sr.writePin(LFO_SAW_LED, LOW);
-    sr.writePin(LFO_RAMP_LED, LOW);
-    sr.writePin(LFO_SQUARE_LED, LOW);
-    sr.writePin(LFO_SAMPLE_HOLD_LED, LOW);
     lfoSaw = 0;
     lfoRamp = 0;
     lfoSquare = 0;
@@ -1594,11 +1409,6 @@ void updatelfoRamp() {
     if (!recallPatchFlag) {
       updateLoadingMessages("      LFO RAMP", "");
     }
-    sr.writePin(LFO_TRIANGLE_LED, LOW);
-    sr.writePin(LFO_SAW_LED, LOW);
-    sr.writePin(LFO_RAMP_LED, HIGH);
-    sr.writePin(LFO_SQUARE_LED, LOW);
-    sr.writePin(LFO_SAMPLE_HOLD_LED, LOW);
     lfoSaw = 0;
     lfoTriangle = 0;
     lfoSquare = 0;
@@ -1613,11 +1423,6 @@ void updatelfoSquare() {
     if (!recallPatchFlag) {
       updateLoadingMessages("     LFO SQUARE", "");
     }
-    sr.writePin(LFO_TRIANGLE_LED, LOW);
-    sr.writePin(LFO_SAW_LED, LOW);
-    sr.writePin(LFO_RAMP_LED, LOW);
-    sr.writePin(LFO_SQUARE_LED, HIGH);
-    sr.writePin(LFO_SAMPLE_HOLD_LED, LOW);
     lfoSaw = 0;
     lfoTriangle = 0;
     lfoRamp = 0;
@@ -1632,11 +1437,6 @@ void updatelfoSampleHold() {
     if (!recallPatchFlag) {
       updateLoadingMessages("      LFO S&H", "");
     }
-    sr.writePin(LFO_TRIANGLE_LED, LOW);
-    sr.writePin(LFO_SAW_LED, LOW);
-    sr.writePin(LFO_RAMP_LED, LOW);
-    sr.writePin(LFO_SQUARE_LED, LOW);
-    sr.writePin(LFO_SAMPLE_HOLD_LED, HIGH);
     lfoSaw = 0;
     lfoTriangle = 0;
     lfoRamp = 0;
@@ -1651,11 +1451,9 @@ void updatelfoSyncSW() {
     if (!recallPatchFlag) {
       updateLoadingMessages("      LFO SYNC", "");
     }
-    sr.writePin(LFO_SYNC_LED, HIGH);  // LED on
     midiCCOut(CClfoSyncSW, 127);
     midiCCOut(CClfoSyncSW, 0);
   } else {
-    sr.writePin(LFO_SYNC_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CClfoSyncSW, 127);
@@ -1670,11 +1468,9 @@ void updatelfoKeybReset() {
     if (!recallPatchFlag) {
       updateLoadingMessages(" LFO KEYBOARD RESET", "");
     }
-    sr.writePin(LFO_KEYB_RESET_LED, HIGH);  // LED on
     midiCCOut(CClfoKeybReset, 127);
     midiCCOut(CClfoKeybReset, 0);
   } else {
-    sr.writePin(LFO_KEYB_RESET_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CClfoKeybReset, 127);
@@ -1684,8 +1480,7 @@ void updatelfoKeybReset() {
 }
 
 void clearLCD() {
-  LCD.PCF8574_LCDClearLine(LCD.LCDLineNumberOne);
-  LCD.PCF8574_LCDClearLine(LCD.LCDLineNumberTwo);
+  lcdClear();
 }
 
 void updatewheelDC() {
@@ -1694,11 +1489,9 @@ void updatewheelDC() {
     if (!recallPatchFlag) {
       updateLoadingMessages(" MOD WHEEL SENDS DC", "");
     }
-    sr.writePin(DC_LED, HIGH);  // LED on
     midiCCOut(CCwheelDC, 127);
     midiCCOut(CCwheelDC, 0);
   } else {
-    sr.writePin(DC_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCwheelDC, 127);
@@ -1713,11 +1506,9 @@ void updatelfoDestOsc1() {
     if (!recallPatchFlag) {
       updateLoadingMessages("     LFO TO OSC1", "");
     }
-    sr.writePin(LFO_DEST_OSC1_LED, HIGH);  // LED on
     midiCCOut(CClfoDestOsc1, 127);
     midiCCOut(CClfoDestOsc1, 0);
   } else {
-    sr.writePin(LFO_DEST_OSC1_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CClfoDestOsc1, 127);
@@ -1732,11 +1523,9 @@ void updatelfoDestOsc2() {
     if (!recallPatchFlag) {
       updateLoadingMessages("     LFO TO OSC2", "");
     }
-    sr.writePin(LFO_DEST_OSC2_LED, HIGH);  // LED on
     midiCCOut(CClfoDestOsc2, 127);
     midiCCOut(CClfoDestOsc2, 0);
   } else {
-    sr.writePin(LFO_DEST_OSC2_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CClfoDestOsc2, 127);
@@ -1751,11 +1540,9 @@ void updatelfoDestOsc3() {
     if (!recallPatchFlag) {
       updateLoadingMessages("     LFO TO OSC3", "");
     }
-    sr.writePin(LFO_DEST_OSC3_LED, HIGH);  // LED on
     midiCCOut(CClfoDestOsc3, 127);
     midiCCOut(CClfoDestOsc3, 0);
   } else {
-    sr.writePin(LFO_DEST_OSC3_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CClfoDestOsc3, 127);
@@ -1770,11 +1557,9 @@ void updatelfoDestVCA() {
     if (!recallPatchFlag) {
       updateLoadingMessages("     LFO TO VCA", "");
     }
-    sr.writePin(LFO_DEST_VCA_LED, HIGH);  // LED on
     midiCCOut(CClfoDestVCA, 127);
     midiCCOut(CClfoDestVCA, 0);
   } else {
-    sr.writePin(LFO_DEST_VCA_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CClfoDestVCA, 127);
@@ -1789,11 +1574,9 @@ void updatelfoDestPW1() {
     if (!recallPatchFlag) {
       updateLoadingMessages("     LFO TO PW1", "");
     }
-    sr.writePin(LFO_DEST_PW1_LED, HIGH);  // LED on
     midiCCOut(CClfoDestPW1, 127);
     midiCCOut(CClfoDestPW1, 0);
   } else {
-    sr.writePin(LFO_DEST_PW1_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CClfoDestPW1, 127);
@@ -1808,11 +1591,9 @@ void updatelfoDestPW2() {
     if (!recallPatchFlag) {
       updateLoadingMessages("     LFO TO PW2", "");
     }
-    sr.writePin(LFO_DEST_PW2_LED, HIGH);  // LED on
     midiCCOut(CClfoDestPW2, 127);
     midiCCOut(CClfoDestPW2, 0);
   } else {
-    sr.writePin(LFO_DEST_PW2_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CClfoDestPW2, 127);
@@ -1823,10 +1604,6 @@ void updatelfoDestPW2() {
 
 void updateosc1_2() {
   if (osc1_2) {
-    sr.writePin(OSC1_2_LED, HIGH);
-    sr.writePin(OSC1_4_LED, LOW);
-    sr.writePin(OSC1_8_LED, LOW);
-    sr.writePin(OSC1_16_LED, LOW);
     osc1_4 = 0;
     osc1_8 = 0;
     osc1_16 = 0;
@@ -1836,10 +1613,6 @@ void updateosc1_2() {
 
 void updateosc1_4() {
   if (osc1_4) {
-    sr.writePin(OSC1_2_LED, LOW);
-    sr.writePin(OSC1_4_LED, HIGH);
-    sr.writePin(OSC1_8_LED, LOW);
-    sr.writePin(OSC1_16_LED, LOW);
     osc1_2 = 0;
     osc1_8 = 0;
     osc1_16 = 0;
@@ -1849,10 +1622,6 @@ void updateosc1_4() {
 
 void updateosc1_8() {
   if (osc1_8) {
-    sr.writePin(OSC1_2_LED, LOW);
-    sr.writePin(OSC1_4_LED, LOW);
-    sr.writePin(OSC1_8_LED, HIGH);
-    sr.writePin(OSC1_16_LED, LOW);
     osc1_2 = 0;
     osc1_4 = 0;
     osc1_16 = 0;
@@ -1862,10 +1631,6 @@ void updateosc1_8() {
 
 void updateosc1_16() {
   if (osc1_16) {
-    sr.writePin(OSC1_2_LED, LOW);
-    sr.writePin(OSC1_4_LED, LOW);
-    sr.writePin(OSC1_8_LED, LOW);
-    sr.writePin(OSC1_16_LED, HIGH);
     osc1_2 = 0;
     osc1_4 = 0;
     osc1_8 = 0;
@@ -1875,10 +1640,6 @@ void updateosc1_16() {
 
 void updateosc2_16() {
   if (osc2_16) {
-    sr.writePin(OSC2_2_LED, LOW);
-    sr.writePin(OSC2_4_LED, LOW);
-    sr.writePin(OSC2_8_LED, LOW);
-    sr.writePin(OSC2_16_LED, HIGH);
     osc2_2 = 0;
     osc2_4 = 0;
     osc2_8 = 0;
@@ -1888,10 +1649,6 @@ void updateosc2_16() {
 
 void updateosc2_8() {
   if (osc2_8) {
-    sr.writePin(OSC2_2_LED, LOW);
-    sr.writePin(OSC2_4_LED, LOW);
-    sr.writePin(OSC2_8_LED, HIGH);
-    sr.writePin(OSC2_16_LED, LOW);
     osc2_2 = 0;
     osc2_4 = 0;
     osc2_16 = 0;
@@ -1901,10 +1658,6 @@ void updateosc2_8() {
 
 void updateosc2_4() {
   if (osc2_4) {
-    sr.writePin(OSC2_2_LED, LOW);
-    sr.writePin(OSC2_4_LED, HIGH);
-    sr.writePin(OSC2_8_LED, LOW);
-    sr.writePin(OSC2_16_LED, LOW);
     osc2_2 = 0;
     osc2_8 = 0;
     osc2_16 = 0;
@@ -1914,10 +1667,6 @@ void updateosc2_4() {
 
 void updateosc2_2() {
   if (osc2_2) {
-    sr.writePin(OSC2_2_LED, HIGH);
-    sr.writePin(OSC2_4_LED, LOW);
-    sr.writePin(OSC2_8_LED, LOW);
-    sr.writePin(OSC2_16_LED, LOW);
     osc2_4 = 0;
     osc2_8 = 0;
     osc2_16 = 0;
@@ -1927,11 +1676,9 @@ void updateosc2_2() {
 
 void updateosc2Saw() {
   if (osc2Saw) {
-    sr.writePin(OSC2_SAW_LED, HIGH);
     midiCCOut(CCosc2Saw, 127);
     midiCCOut(CCosc2Saw, 0);
   } else {
-    sr.writePin(OSC2_SAW_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       midiCCOut(CCosc2Saw, 127);
       midiCCOut(CCosc2Saw, 0);
@@ -1941,11 +1688,9 @@ void updateosc2Saw() {
 
 void updateosc2Square() {
   if (osc2Square) {
-    sr.writePin(OSC2_SQUARE_LED, HIGH);
     midiCCOut(CCosc2Square, 127);
     midiCCOut(CCosc2Square, 0);
   } else {
-    sr.writePin(OSC2_SQUARE_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       midiCCOut(CCosc2Square, 127);
       midiCCOut(CCosc2Square, 0);
@@ -1955,11 +1700,9 @@ void updateosc2Square() {
 
 void updateosc2Triangle() {
   if (osc2Triangle) {
-    sr.writePin(OSC2_TRIANGLE_LED, HIGH);
     midiCCOut(CCosc2Triangle, 127);
     midiCCOut(CCosc2Triangle, 0);
   } else {
-    sr.writePin(OSC2_TRIANGLE_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       midiCCOut(CCosc2Triangle, 127);
       midiCCOut(CCosc2Triangle, 0);
@@ -1969,11 +1712,9 @@ void updateosc2Triangle() {
 
 void updateosc1Saw() {
   if (osc1Saw) {
-    sr.writePin(OSC1_SAW_LED, HIGH);
     midiCCOut(CCosc1Saw, 127);
     midiCCOut(CCosc1Saw, 0);
   } else {
-    sr.writePin(OSC1_SAW_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       midiCCOut(CCosc1Saw, 127);
       midiCCOut(CCosc1Saw, 0);
@@ -1983,11 +1724,9 @@ void updateosc1Saw() {
 
 void updateosc1Square() {
   if (osc1Square) {
-    sr.writePin(OSC1_SQUARE_LED, HIGH);
     midiCCOut(CCosc1Square, 127);
     midiCCOut(CCosc1Square, 0);
   } else {
-    sr.writePin(OSC1_SQUARE_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       midiCCOut(CCosc1Square, 127);
       midiCCOut(CCosc1Square, 0);
@@ -1997,11 +1736,9 @@ void updateosc1Square() {
 
 void updateosc1Triangle() {
   if (osc1Triangle) {
-    sr.writePin(OSC1_TRIANGLE_LED, HIGH);
     midiCCOut(CCosc1Triangle, 127);
     midiCCOut(CCosc1Triangle, 0);
   } else {
-    sr.writePin(OSC1_TRIANGLE_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       midiCCOut(CCosc1Triangle, 127);
       midiCCOut(CCosc1Triangle, 0);
@@ -2011,11 +1748,9 @@ void updateosc1Triangle() {
 
 void updateosc3Saw() {
   if (osc3Saw) {
-    sr.writePin(OSC3_SAW_LED, HIGH);
     midiCCOut(CCosc3Saw, 127);
     midiCCOut(CCosc3Saw, 0);
   } else {
-    sr.writePin(OSC3_SAW_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       midiCCOut(CCosc3Saw, 127);
       midiCCOut(CCosc3Saw, 0);
@@ -2025,11 +1760,9 @@ void updateosc3Saw() {
 
 void updateosc3Square() {
   if (osc3Square) {
-    sr.writePin(OSC3_SQUARE_LED, HIGH);
     midiCCOut(CCosc3Square, 127);
     midiCCOut(CCosc3Square, 0);
   } else {
-    sr.writePin(OSC3_SQUARE_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       midiCCOut(CCosc3Square, 127);
       midiCCOut(CCosc3Square, 0);
@@ -2039,11 +1772,9 @@ void updateosc3Square() {
 
 void updateosc3Triangle() {
   if (osc3Triangle) {
-    sr.writePin(OSC3_TRIANGLE_LED, HIGH);
     midiCCOut(CCosc3Triangle, 127);
     midiCCOut(CCosc3Triangle, 0);
   } else {
-    sr.writePin(OSC3_TRIANGLE_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       midiCCOut(CCosc3Triangle, 127);
       midiCCOut(CCosc3Triangle, 0);
@@ -2057,13 +1788,9 @@ void updateslopeSW() {
     if (!recallPatchFlag) {
       updateLoadingMessages("FOUR POLE (24DB/OCT)", "");
     }
-    sr.writePin(SLOPE_GREEN_LED, LOW);  // LED on
-    sr.writePin(SLOPE_RED_LED, HIGH);   // LED on
     midiCCOut(CCslopeSW, 127);
     midiCCOut(CCslopeSW, 0);
   } else {
-    sr.writePin(SLOPE_GREEN_LED, HIGH);  // LED on
-    sr.writePin(SLOPE_RED_LED, LOW);     // LED on
     if (!recallPatchFlag) {
       updateLoadingMessages("TWO POLE (12DB/OCT)", "");
       midiCCOut(CCslopeSW, 127);
@@ -2078,11 +1805,9 @@ void updateechoSW() {
     if (!recallPatchFlag) {
       updateLoadingMessages("      ECHO ON", "");
     }
-    sr.writePin(ECHO_ON_OFF_LED, HIGH);  // LED on
     midiCCOut(CCechoSW, 127);
     midiCCOut(CCechoSW, 0);
   } else {
-    sr.writePin(ECHO_ON_OFF_LED, LOW);  // LED on
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCechoSW, 127);
@@ -2097,11 +1822,9 @@ void updateechoSyncSW() {
     if (!recallPatchFlag) {
       updateLoadingMessages("    ECHO SYNC ON", "");
     }
-    sr.writePin(ECHO_SYNC_LED, HIGH);  // LED on
     midiCCOut(CCechoSyncSW, 127);
     midiCCOut(CCechoSyncSW, 0);
   } else {
-    sr.writePin(ECHO_SYNC_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCechoSyncSW, 127);
@@ -2116,10 +1839,8 @@ void updatereleaseSW() {
     if (!recallPatchFlag) {
       updateLoadingMessages("     RELEASE ON", "");
     }
-    sr.writePin(RELEASE_LED, HIGH);  // LED on
     midiCCOut(CCreleaseSW, 127);
   } else {
-    sr.writePin(RELEASE_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCreleaseSW, 127);
@@ -2133,10 +1854,8 @@ void updatekeyboardFollowSW() {
     if (!recallPatchFlag) {
       updateLoadingMessages("   KEYBOARD FOLLOW", "");
     }
-    sr.writePin(KEYBOARD_FOLLOW_LED, HIGH);  // LED on
     midiCCOut(CCkeyboardFollowSW, 127);
   } else {
-    sr.writePin(KEYBOARD_FOLLOW_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCkeyboardFollowSW, 127);
@@ -2150,10 +1869,8 @@ void updateunconditionalContourSW() {
     if (!recallPatchFlag) {
       updateLoadingMessages("   UNCONDITIONAL", "    CONTOUR ON");
     }
-    sr.writePin(UNCONDITIONAL_CONTOUR_LED, HIGH);  // LED on
     midiCCOut(CCunconditionalContourSW, 127);
   } else {
-    sr.writePin(UNCONDITIONAL_CONTOUR_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCunconditionalContourSW, 127);
@@ -2167,10 +1884,8 @@ void updatereturnSW() {
     if (!recallPatchFlag) {
       updateLoadingMessages(" RETURN TO ZERO ON", "");
     }
-    sr.writePin(RETURN_TO_ZERO_LED, HIGH);  // LED on
     midiCCOut(CCreturnSW, 127);
   } else {
-    sr.writePin(RETURN_TO_ZERO_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCreturnSW, 127);
@@ -2184,11 +1899,9 @@ void updatereverbSW() {
     if (!recallPatchFlag) {
       updateLoadingMessages("    REVERB ON", "");
     }
-    sr.writePin(REVERB_ON_OFF_LED, HIGH);  // LED on
     midiCCOut(CCreverbSW, 127);
     midiCCOut(CCreverbSW, 0);
   } else {
-    sr.writePin(REVERB_ON_OFF_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCreverbSW, 127);
@@ -2217,7 +1930,6 @@ void updatereverbTypeSW() {
   if (reverbTypeSW && !reverbTypeFirstPress) {
     reverbType_timer = millis();
     reverbType = 1;
-    sr.writePin(REVERB_TYPE_LED, HIGH);  // LED on
     if (!recallPatchFlag) {
       if (reverbType == 1) {
         updateLoadingMessages("     ROOM REVERB", "");
@@ -2273,7 +1985,6 @@ void updatereverbTypeExitSW() {
     reverbTypeSW = 0;
     reverbTypeExitSW = 0;
     reverbType_timer = 0;
-    sr.writePin(REVERB_TYPE_LED, LOW);  // LED on
   }
 }
 
@@ -2283,11 +1994,9 @@ void updatelimitSW() {
     if (!recallPatchFlag) {
       updateLoadingMessages("        LIMIT", "");
     }
-    sr.writePin(LIMIT_LED, HIGH);  // LED on
     midiCCOut(CClimitSW, 127);
     midiCCOut(CClimitSW, 0);
   } else {
-    sr.writePin(LIMIT_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CClimitSW, 127);
@@ -2302,11 +2011,9 @@ void updatemodernSW() {
     if (!recallPatchFlag) {
       updateLoadingMessages("    MODERN MODE", "");
     }
-    sr.writePin(MODERN_LED, HIGH);  // LED on
     midiCCOut(CCmodernSW, 127);
     midiCCOut(CCmodernSW, 0);
   } else {
-    sr.writePin(MODERN_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("    VINTAGE MODE", "");
       midiCCOut(CCmodernSW, 127);
@@ -2317,10 +2024,6 @@ void updatemodernSW() {
 
 void updateosc3_2() {
   if (osc3_2) {
-    sr.writePin(OSC3_2_LED, HIGH);
-    sr.writePin(OSC3_4_LED, LOW);
-    sr.writePin(OSC3_8_LED, LOW);
-    sr.writePin(OSC3_16_LED, LOW);
     osc3_4 = 0;
     osc3_8 = 0;
     osc3_16 = 0;
@@ -2330,10 +2033,6 @@ void updateosc3_2() {
 
 void updateosc3_4() {
   if (osc3_4) {
-    sr.writePin(OSC3_2_LED, LOW);
-    sr.writePin(OSC3_4_LED, HIGH);
-    sr.writePin(OSC3_8_LED, LOW);
-    sr.writePin(OSC3_16_LED, LOW);
     osc3_2 = 0;
     osc3_8 = 0;
     osc3_16 = 0;
@@ -2343,10 +2042,6 @@ void updateosc3_4() {
 
 void updateosc3_8() {
   if (osc3_8) {
-    sr.writePin(OSC3_2_LED, LOW);
-    sr.writePin(OSC3_4_LED, LOW);
-    sr.writePin(OSC3_8_LED, HIGH);
-    sr.writePin(OSC3_16_LED, LOW);
     osc3_2 = 0;
     osc3_4 = 0;
     osc3_16 = 0;
@@ -2356,10 +2051,6 @@ void updateosc3_8() {
 
 void updateosc3_16() {
   if (osc3_16) {
-    sr.writePin(OSC3_2_LED, LOW);
-    sr.writePin(OSC3_4_LED, LOW);
-    sr.writePin(OSC3_8_LED, LOW);
-    sr.writePin(OSC3_16_LED, HIGH);
     osc3_2 = 0;
     osc3_4 = 0;
     osc3_8 = 0;
@@ -2373,11 +2064,9 @@ void updateensembleSW() {
     if (!recallPatchFlag) {
       updateLoadingMessages("     ENSEMBLE ON", "");
     }
-    sr.writePin(ENSEMBLE_LED, HIGH);  // LED on
     midiCCOut(CCensembleSW, 127);
     midiCCOut(CCensembleSW, 0);
   } else {
-    sr.writePin(ENSEMBLE_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCensembleSW, 127);
@@ -2392,11 +2081,9 @@ void updatelowSW() {
     if (!recallPatchFlag) {
       updateLoadingMessages("   OSC3 LOW FREQ", "");
     }
-    sr.writePin(LOW_LED, HIGH);  // LED on
     midiCCOut(CClowSW, 127);
     midiCCOut(CClowSW, 0);
   } else {
-    sr.writePin(LOW_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CClowSW, 127);
@@ -2411,11 +2098,9 @@ void updatekeyboardControlSW() {
     if (!recallPatchFlag) {
       updateLoadingMessages("OSC3 KEYBOARD CONTROL", "");
     }
-    sr.writePin(KEYBOARD_CONTROL_LED, HIGH);  // LED on
     midiCCOut(CCkeyboardControlSW, 127);
     midiCCOut(CCkeyboardControlSW, 0);
   } else {
-    sr.writePin(KEYBOARD_CONTROL_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCkeyboardControlSW, 127);
@@ -2430,11 +2115,9 @@ void updateoscSyncSW() {
     if (!recallPatchFlag) {
       updateLoadingMessages("  OSC SYNC 2 TO 1", "");
     }
-    sr.writePin(OSC_SYNC_LED, HIGH);  // LED on
     midiCCOut(CCoscSyncSW, 127);
     midiCCOut(CCoscSyncSW, 0);
   } else {
-    sr.writePin(OSC_SYNC_LED, LOW);  // LED off
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCoscSyncSW, 127);
@@ -2449,11 +2132,9 @@ void updatevoiceModDestVCA() {
     if (!recallPatchFlag) {
       updateLoadingMessages("  VOICE MOD TO AMP", "");
     }
-    sr.writePin(VOICE_MOD_DEST_VCA_LED, HIGH);
     midiCCOut(CCvoiceModDestVCA, 127);
     midiCCOut(CCvoiceModDestVCA, 0);
   } else {
-    sr.writePin(VOICE_MOD_DEST_VCA_LED, LOW);
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCvoiceModDestVCA, 127);
@@ -2468,11 +2149,9 @@ void updatephaserSW() {
     if (!recallPatchFlag) {
       updateLoadingMessages("      PHASER ON", "");
     }
-    sr.writePin(PHASER_LED, HIGH);
     midiCCOut(CCphaserSW, 127);
     midiCCOut(CCphaserSW, 0);
   } else {
-    sr.writePin(PHASER_LED, LOW);
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CCphaserSW, 127);
@@ -2487,11 +2166,9 @@ void updatelfoDestFilter() {
     if (!recallPatchFlag) {
       updateLoadingMessages("   LFO TO FILTER", "");
     }
-    sr.writePin(LFO_DEST_FILTER_LED, HIGH);
     midiCCOut(CClfoDestFilter, 127);
     midiCCOut(CClfoDestFilter, 0);
   } else {
-    sr.writePin(LFO_DEST_FILTER_LED, LOW);
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CClfoDestFilter, 127);
@@ -2506,11 +2183,9 @@ void updatelfoDestPW3() {
     if (!recallPatchFlag) {
       updateLoadingMessages("     LFO TO PW3", "");
     }
-    sr.writePin(LFO_DEST_PW3_LED, HIGH);
     midiCCOut(CClfoDestPW3, 127);
     midiCCOut(CClfoDestPW3, 0);
   } else {
-    sr.writePin(LFO_DEST_PW3_LED, LOW);
     if (!recallPatchFlag) {
       updateLoadingMessages("", "");
       midiCCOut(CClfoDestPW3, 127);
@@ -2527,22 +2202,25 @@ void myControlChange(byte channel, byte control, int value) {
   switch (control) {
 
     case CCmodWheelinput:
-      MIDI.sendControlChange(control, value, channel);
-      if (sendNotes) {
-        usbMIDI.sendControlChange(control, value, channel);
+      {
+        MidiOutGuard guard;
+        uint8_t to = midiRoute(midiRouteSource, ROUTE_NOTES);  //Played, like pitch bend
+        if (to & ROUTE_TO_DIN) dinSendContinuous(DIN_THIN_MOD_WHEEL, channel, value);
+        if (to & ROUTE_TO_USB) usbMidiQueue(0xB0, control, value, channel);
+        midiEchoSent(to, control, value);
       }
       break;
 
     case CCmodWheel:
       modWheel = value;
-      modWheelstr = MEMORYMODE100[value];  // for display
+      modWheelstr = MEMORYMODE100[value] / 100;  // for display
       modWheel100 = map(value, 0, 127, 0, 100);
       updatemodWheel();
       break;
 
     case CCglide:
       glide = value;
-      glidestr = MEMORYMODE100LOG[value];  // for display
+      glidestr = MEMORYMODE100LOG[value] / 100;  // for display
       glide100 = map(value, 0, 127, 0, 100);
       updateGlide();
       break;
@@ -2570,42 +2248,42 @@ void myControlChange(byte channel, byte control, int value) {
 
     case CCuniDetune:
       uniDetune = value;
-      uniDetunestr = MEMORYMODE100[value];  // for display
+      uniDetunestr = MEMORYMODE100[value] / 100;  // for display
       uniDetune100 = map(value, 0, 127, 0, 100);
       updateuniDetune();
       break;
 
     case CCbendDepth:
       bendDepth = value;
-      bendDepthstr = MEMORYMODEBENDDEPTH[value];  // for display
+      bendDepthstr = MEMORYMODEBENDDEPTH[value] / 100;  // for display
       bendDepth100 = map(value, 0, 127, 0, 100);
       updatebendDepth();
       break;
 
     case CClfoOsc3:
       lfoOsc3 = value;
-      lfoOsc3str = MEMORYMODE200[value];  // for display
+      lfoOsc3str = MEMORYMODE200[value] / 100;  // for display
       lfoOsc3100 = map(value, 0, 127, 0, 100);
       updatelfoOsc3();
       break;
 
     case CClfoFilterContour:
       lfoFilterContour = value;
-      lfoFilterContourstr = MEMORYMODE100LOG[value];  // for display
+      lfoFilterContourstr = MEMORYMODE100LOG[value] / 100;  // for display
       lfoFilterContour100 = map(value, 0, 127, 0, 100);
       updatelfoFilterContour();
       break;
 
     case CCphaserDepth:
       phaserDepth = value;
-      phaserDepthstr = MEMORYMODE100[value];  // for display
+      phaserDepthstr = MEMORYMODE100[value] / 100;  // for display
       phaserDepth100 = map(value, 0, 127, 0, 100);
       updatephaserDepth();
       break;
 
     case CClfoInitialAmount:
       lfoInitialAmount = value;
-      lfoInitialAmountstr = MEMORYMODE100LOG[value];
+      lfoInitialAmountstr = MEMORYMODE100LOG[value] / 100;
       lfoInitialAmount100 = map(value, 0, 127, 0, 100);
       updatelfoInitialAmount();
       break;
@@ -3300,9 +2978,16 @@ void myProgramChange(byte channel, byte program) {
 void recallPatch(int patchNo) {
   allNotesOff();
 
-  MIDI.sendProgramChange(0, midiOutCh);
-  //usbMIDI.sendProgramChange(0, midiOutCh);
+  {
+    MidiOutGuard guard;
+    MIDI.sendProgramChange(0, midiOutCh);
+    midiTrafficMessage(TRAFFIC_DIN_OUT, 0xC0, 0, 0);
+    //usbMIDI.sendProgramChange(0, midiOutCh);
+  }
   delay(100);
+#ifdef USB_MIDI_STATS
+  usbMidiRecallMark(true);
+#endif
   recallPatchFlag = true;
   File patchFile = SD.open(String(patchNo).c_str());
   if (!patchFile) {
@@ -3316,6 +3001,9 @@ void recallPatch(int patchNo) {
     updateLoadingMessages("Patch Loading", "Complete....");
   }
   recallPatchFlag = false;
+#ifdef USB_MIDI_STATS
+  usbMidiRecallMark(false);
+#endif
 }
 
 void setCurrentPatchData(String data[]) {
@@ -3618,7 +3306,9 @@ void setCurrentPatchData(String data[]) {
   updatelowSW();
   updatekeyboardControlSW();
   updateoscSyncSW();
-  
+  ledHidPending = true;
+  refreshPanelLEDs();  // all the LEDs for the new patch in one frame
+
 
   Serial.print("Poly Mode ");
   Serial.println(polyMode);
@@ -3644,6 +3334,7 @@ void setCurrentPatchData(String data[]) {
   updatearpRangePreset();
   delay(200);
   updatearpModePreset();
+  ledHidPending = false;
 
   //Patchname
   updatePatchname();
@@ -3673,664 +3364,16 @@ String getCurrentPatchData() {
          + "," + String(mono) + "," + String(arpMode);
 }
 
-void checkMux() {
-
-  mux1Read = adc->adc1->analogRead(MUX1_S);
-  mux2Read = adc->adc1->analogRead(MUX2_S);
-  mux3Read = adc->adc1->analogRead(MUX3_S);
-
-  if (mux1Read > (mux1ValuesPrev[muxInput] + QUANTISE_FACTOR) || mux1Read < (mux1ValuesPrev[muxInput] - QUANTISE_FACTOR)) {
-    mux1ValuesPrev[muxInput] = mux1Read;
-    mux1Read = (mux1Read >> resolutionFrig);  // Change range to 0-127
-
-    switch (muxInput) {
-      case MUX1_GLIDE:
-        myControlChange(midiChannel, CCglide, mux1Read);
-        break;
-      case MUX1_UNISON_DETUNE:
-        myControlChange(midiChannel, CCuniDetune, mux1Read);
-        break;
-      case MUX1_BEND_DEPTH:
-        myControlChange(midiChannel, CCbendDepth, mux1Read);
-        break;
-      case MUX1_LFO_OSC3:
-        myControlChange(midiChannel, CClfoOsc3, mux1Read);
-        break;
-      case MUX1_LFO_FILTER_CONTOUR:
-        myControlChange(midiChannel, CClfoFilterContour, mux1Read);
-        break;
-      case MUX1_ARP_RATE:
-        myControlChange(midiChannel, CCarpSpeed, mux1Read);
-        break;
-      case MUX1_PHASER_RATE:
-        myControlChange(midiChannel, CCphaserSpeed, mux1Read);
-        break;
-      case MUX1_PHASER_DEPTH:
-        myControlChange(midiChannel, CCphaserDepth, mux1Read);
-        break;
-      case MUX1_LFO_INITIAL_AMOUNT:
-        myControlChange(midiChannel, CClfoInitialAmount, mux1Read);
-        break;
-      case MUX1_LFO_MOD_WHEEL_AMOUNT:
-        myControlChange(midiChannel, CCmodWheel, mux1Read);
-        break;
-      case MUX1_LFO_RATE:
-        myControlChange(midiChannel, CClfoSpeed, mux1Read);
-        break;
-      case MUX1_OSC2_FREQUENCY:
-        myControlChange(midiChannel, CCosc2Frequency, mux1Read);
-        break;
-      case MUX1_OSC2_PW:
-        myControlChange(midiChannel, CCosc2PW, mux1Read);
-        break;
-      case MUX1_OSC1_PW:
-        myControlChange(midiChannel, CCosc1PW, mux1Read);
-        break;
-      case MUX1_OSC3_FREQUENCY:
-        myControlChange(midiChannel, CCosc3Frequency, mux1Read);
-        break;
-      case MUX1_OSC3_PW:
-        myControlChange(midiChannel, CCosc3PW, mux1Read);
-        break;
-    }
-  }
-
-  if (mux2Read > (mux2ValuesPrev[muxInput] + QUANTISE_FACTOR) || mux2Read < (mux2ValuesPrev[muxInput] - QUANTISE_FACTOR)) {
-    mux2ValuesPrev[muxInput] = mux2Read;
-    mux2Read = (mux2Read >> resolutionFrig);  // Change range to 0-127
-
-    switch (muxInput) {
-      case MUX2_ENSEMBLE_RATE:
-        myControlChange(midiChannel, CCensembleRate, mux2Read);
-        break;
-      case MUX2_ENSEMBLE_DEPTH:
-        myControlChange(midiChannel, CCensembleDepth, mux2Read);
-        break;
-      case MUX2_ECHO_TIME:
-        myControlChange(midiChannel, CCechoTime, mux2Read);
-        break;
-      case MUX2_ECHO_FEEDBACK:
-        myControlChange(midiChannel, CCechoRegen, mux2Read);
-        break;
-      case MUX2_ECHO_DAMP:
-        myControlChange(midiChannel, CCechoDamp, mux2Read);
-        break;
-      case MUX2_ECHO_SPREAD:
-        myControlChange(midiChannel, CCechoSpread, mux2Read);
-        break;
-      case MUX2_ECHO_MIX:
-        myControlChange(midiChannel, CCechoLevel, mux2Read);
-        break;
-      case MUX2_NOISE:
-        myControlChange(midiChannel, CCnoise, mux2Read);
-        break;
-      case MUX2_OSC3_LEVEL:
-        myControlChange(midiChannel, CCosc3Level, mux2Read);
-        break;
-      case MUX2_OSC2_LEVEL:
-        myControlChange(midiChannel, CCosc2Level, mux2Read);
-        break;
-      case MUX2_OSC1_LEVEL:
-        myControlChange(midiChannel, CCosc1Level, mux2Read);
-        break;
-      case MUX2_CUTOFF:
-        myControlChange(midiChannel, CCfilterCutoff, mux2Read);
-        break;
-      case MUX2_EMPHASIS:
-        myControlChange(midiChannel, CCemphasis, mux2Read);
-        break;
-      case MUX2_VCF_DECAY:
-        myControlChange(midiChannel, CCvcfDecay, mux2Read);
-        break;
-      case MUX2_VCF_ATTACK:
-        myControlChange(midiChannel, CCvcfAttack, mux2Read);
-        break;
-      case MUX2_VCA_ATTACK:
-        myControlChange(midiChannel, CCvcaAttack, mux2Read);
-        break;
-    }
-  }
-
-  if (mux3Read > (mux3ValuesPrev[muxInput] + QUANTISE_FACTOR) || mux3Read < (mux3ValuesPrev[muxInput] - QUANTISE_FACTOR)) {
-    mux3ValuesPrev[muxInput] = mux3Read;
-    mux3Read = (mux3Read >> resolutionFrig);  // Change range to 0-127
-
-    switch (muxInput) {
-      case MUX3_REVERB_MIX:
-        myControlChange(midiChannel, CCreverbLevel, mux3Read);
-        break;
-      case MUX3_REVERB_DAMP:
-        myControlChange(midiChannel, CCreverbDamp, mux3Read);
-        break;
-      case MUX3_REVERB_DECAY:
-        myControlChange(midiChannel, CCreverbDecay, mux3Read);
-        break;
-      case MUX3_DRIFT:
-        myControlChange(midiChannel, CCdriftAmount, mux3Read);
-        break;
-      case MUX3_VCA_VELOCITY:
-        myControlChange(midiChannel, CCvcaVelocity, mux3Read);
-        break;
-      case MUX3_VCA_RELEASE:
-        myControlChange(midiChannel, CCvcaRelease, mux3Read);
-        break;
-      case MUX3_VCA_SUSTAIN:
-        myControlChange(midiChannel, CCvcaSustain, mux3Read);
-        break;
-      case MUX3_VCA_DECAY:
-        myControlChange(midiChannel, CCvcaDecay, mux3Read);
-        break;
-      case MUX3_VCF_SUSTAIN:
-        myControlChange(midiChannel, CCvcfSustain, mux3Read);
-        break;
-      case MUX3_CONTOUR_AMOUNT:
-        myControlChange(midiChannel, CCvcfContourAmount, mux3Read);
-        break;
-      case MUX3_VCF_RELEASE:
-        myControlChange(midiChannel, CCvcfRelease, mux3Read);
-        break;
-      case MUX3_KB_TRACK:
-        myControlChange(midiChannel, CCkbTrack, mux3Read);
-        break;
-      case MUX3_MASTER_VOLUME:
-        myControlChange(midiChannel, CCmasterVolume, mux3Read);
-        break;
-      case MUX3_VCF_VELOCITY:
-        myControlChange(midiChannel, CCvcfVelocity, mux3Read);
-        break;
-      case MUX3_MASTER_TUNE:
-        myControlChange(midiChannel, CCmasterTune, mux3Read);
-        break;
-    }
-  }
-
-  muxInput++;
-  if (muxInput >= MUXCHANNELS) {
-    muxInput = 0;
-  }
-
-  digitalWriteFast(MUX_0, muxInput & B0001);
-  digitalWriteFast(MUX_1, muxInput & B0010);
-  digitalWriteFast(MUX_2, muxInput & B0100);
-  digitalWriteFast(MUX_3, muxInput & B1000);
-  delayMicroseconds(75);
-}
-
-void onButtonPress(uint16_t btnIndex, uint8_t btnType) {
-
-  // to check if a specific button was pressed
-
-  if (btnIndex == LFO_INVERT_SW && btnType == ROX_PRESSED) {
-    lfoInvert = !lfoInvert;
-    myControlChange(midiChannel, CClfoInvert, lfoInvert);
-  }
-
-  if (btnIndex == CONT_OSC3_AMOUNT_SW && btnType == ROX_PRESSED) {
-    contourOsc3Amt = !contourOsc3Amt;
-    myControlChange(midiChannel, CCcontourOsc3Amt, contourOsc3Amt);
-  }
-
-  if (btnIndex == VOICE_MOD_DEST_VCA_SW && btnType == ROX_PRESSED) {
-    voiceModDestVCA = !voiceModDestVCA;
-    myControlChange(midiChannel, CCvoiceModDestVCA, voiceModDestVCA);
-  }
-
-  if (btnIndex == ARP_MODE_SW && btnType == ROX_RELEASED) {
-    arpModeSW = 1;
-    myControlChange(midiChannel, CCarpModeSW, arpModeSW);
-  } else {
-    if (btnIndex == ARP_MODE_SW && btnType == ROX_HELD) {
-      arpModeExitSW = 1;
-      myControlChange(midiChannel, CCarpModeExitSW, arpModeExitSW);
-    }
-  }
-
-  if (btnIndex == ARP_RANGE_SW && btnType == ROX_RELEASED) {
-    arpRangeSW = 1;
-    myControlChange(midiChannel, CCarpRangeSW, arpRangeSW);
-  } else {
-    if (btnIndex == ARP_RANGE_SW && btnType == ROX_HELD) {
-      arpRangeExitSW = 1;
-      myControlChange(midiChannel, CCarpRangeExitSW, arpRangeExitSW);
-    }
-  }
-
-  if (btnIndex == PHASER_SW && btnType == ROX_PRESSED) {
-    phaserSW = !phaserSW;
-    myControlChange(midiChannel, CCphaserSW, phaserSW);
-  }
-
-  if (btnIndex == VOICE_MOD_DEST_FILTER_SW && btnType == ROX_PRESSED) {
-    voiceModToFilter = !voiceModToFilter;
-    myControlChange(midiChannel, CCvoiceModToFilter, voiceModToFilter);
-  }
-
-  if (btnIndex == VOICE_MOD_DEST_PW2_SW && btnType == ROX_PRESSED) {
-    voiceModToPW2 = !voiceModToPW2;
-    myControlChange(midiChannel, CCvoiceModToPW2, voiceModToPW2);
-  }
-
-  if (btnIndex == VOICE_MOD_DEST_PW1_SW && btnType == ROX_PRESSED) {
-    voiceModToPW1 = !voiceModToPW1;
-    myControlChange(midiChannel, CCvoiceModToPW1, voiceModToPW1);
-  }
-
-  if (btnIndex == VOICE_MOD_DEST_OSC2_SW && btnType == ROX_PRESSED) {
-    voiceModToOsc2 = !voiceModToOsc2;
-    myControlChange(midiChannel, CCvoiceModToOsc2, voiceModToOsc2);
-  }
-
-  if (btnIndex == VOICE_MOD_DEST_OSC1_SW && btnType == ROX_PRESSED) {
-    voiceModToOsc1 = !voiceModToOsc1;
-    myControlChange(midiChannel, CCvoiceModToOsc1, voiceModToOsc1);
-  }
-
-  if (btnIndex == ARP_ON_OFF_SW && btnType == ROX_PRESSED) {
-    arpOnSW = !arpOnSW;
-    myControlChange(midiChannel, CCarpOnSW, arpOnSW);
-  }
-
-  if (btnIndex == ARP_HOLD_SW && btnType == ROX_PRESSED) {
-    arpHold = !arpHold;
-    myControlChange(midiChannel, CCarpHold, arpHold);
-  }
-
-  if (btnIndex == ARP_SYNC_SW && btnType == ROX_PRESSED) {
-    arpSync = !arpSync;
-    myControlChange(midiChannel, CCarpSync, arpSync);
-  }
-
-  if (btnIndex == MULT_TRIG_SW && btnType == ROX_PRESSED) {
-    multTrig = !multTrig;
-    myControlChange(midiChannel, CCmultTrig, multTrig);
-  }
-
-  if (btnIndex == MONO_SW && btnType == ROX_RELEASED) {
-    monoSW = 1;
-    myControlChange(midiChannel, CCmonoSW, monoSW);
-  } else {
-    if (btnIndex == MONO_SW && btnType == ROX_HELD) {
-      monoExitSW = 1;
-      myControlChange(midiChannel, CCmonoExitSW, monoExitSW);
-    }
-  }
-
-  if (btnIndex == POLY_SW && btnType == ROX_RELEASED) {
-    polySW = 1;
-    myControlChange(midiChannel, CCpolySW, polySW);
-  } else {
-    if (btnIndex == POLY_SW && btnType == ROX_HELD) {
-      polyExitSW = 1;
-      myControlChange(midiChannel, CCpolyExitSW, polyExitSW);
-    }
-  }
-
-  if (btnIndex == GLIDE_SW && btnType == ROX_PRESSED) {
-    glideSW = !glideSW;
-    myControlChange(midiChannel, CCglideSW, glideSW);
-  }
-
-  if (btnIndex == NUM_OF_VOICES_SW && btnType == ROX_RELEASED) {
-    maxVoicesSW = 1;
-    myControlChange(midiChannel, CCnumberOfVoices, maxVoicesSW);
-  } else {
-    if (btnIndex == NUM_OF_VOICES_SW && btnType == ROX_HELD) {
-      maxVoicesExitSW = 1;
-      myControlChange(midiChannel, CCmaxVoicesExitSW, maxVoicesExitSW);
-    }
-  }
-
-  if (btnIndex == OCTAVE_MINUS_SW && btnType == ROX_PRESSED) {
-    octaveDown = 1;
-    myControlChange(midiChannel, CCoctaveDown, octaveDown);
-  }
-
-  if (btnIndex == OCTAVE_ZERO_SW && btnType == ROX_PRESSED) {
-    octaveNormal = 1;
-    myControlChange(midiChannel, CCoctaveNormal, octaveNormal);
-  }
-
-  if (btnIndex == OCTAVE_PLUS_SW && btnType == ROX_PRESSED) {
-    octaveUp = 1;
-    myControlChange(midiChannel, CCoctaveUp, octaveUp);
-  }
-
-  if (btnIndex == CHORD_MODE_SW && btnType == ROX_PRESSED) {
-    chordMode = !chordMode;
-    myControlChange(midiChannel, CCchordMode, chordMode);
-  }
-
-  if (btnIndex == LFO_SAW_SW && btnType == ROX_PRESSED) {
-    lfoSaw = 1;
-    myControlChange(midiChannel, CClfoSaw, lfoSaw);
-  }
-
-  if (btnIndex == LFO_TRIANGLE_SW && btnType == ROX_PRESSED) {
-    lfoTriangle = 1;
-    myControlChange(midiChannel, CClfoTriangle, lfoTriangle);
-  }
-
-  if (btnIndex == LFO_RAMP_SW && btnType == ROX_PRESSED) {
-    lfoRamp = 1;
-    myControlChange(midiChannel, CClfoRamp, lfoRamp);
-  }
-
-  if (btnIndex == LFO_SQUARE_SW && btnType == ROX_PRESSED) {
-    lfoSquare = 1;
-    myControlChange(midiChannel, CClfoSquare, lfoSquare);
-  }
-
-  if (btnIndex == LFO_SAMPLE_HOLD_SW && btnType == ROX_PRESSED) {
-    lfoSampleHold = 1;
-    myControlChange(midiChannel, CClfoSampleHold, lfoSampleHold);
-  }
-
-  if (btnIndex == LFO_SYNC_SW && btnType == ROX_PRESSED) {
-    lfoSyncSW = !lfoSyncSW;
-    myControlChange(midiChannel, CClfoSyncSW, lfoSyncSW);
-  }
-
-  if (btnIndex == LFO_KEYB_RESET_SW && btnType == ROX_PRESSED) {
-    lfoKeybReset = !lfoKeybReset;
-    myControlChange(midiChannel, CClfoKeybReset, lfoKeybReset);
-  }
-
-  if (btnIndex == DC_SW && btnType == ROX_PRESSED) {
-    wheelDC = !wheelDC;
-    myControlChange(midiChannel, CCwheelDC, wheelDC);
-  }
-
-  if (btnIndex == LFO_DEST_OSC1_SW && btnType == ROX_PRESSED) {
-    lfoDestOsc1 = !lfoDestOsc1;
-    myControlChange(midiChannel, CClfoDestOsc1, lfoDestOsc1);
-  }
-
-  if (btnIndex == LFO_DEST_OSC2_SW && btnType == ROX_PRESSED) {
-    lfoDestOsc2 = !lfoDestOsc2;
-    myControlChange(midiChannel, CClfoDestOsc2, lfoDestOsc2);
-  }
-
-  if (btnIndex == LFO_DEST_OSC3_SW && btnType == ROX_PRESSED) {
-    lfoDestOsc3 = !lfoDestOsc3;
-    myControlChange(midiChannel, CClfoDestOsc3, lfoDestOsc3);
-  }
-
-  if (btnIndex == LFO_DEST_VCA_SW && btnType == ROX_PRESSED) {
-    lfoDestVCA = !lfoDestVCA;
-    myControlChange(midiChannel, CClfoDestVCA, lfoDestVCA);
-  }
-
-  if (btnIndex == LFO_DEST_PW1_SW && btnType == ROX_PRESSED) {
-    lfoDestPW1 = !lfoDestPW1;
-    myControlChange(midiChannel, CClfoDestPW1, lfoDestPW1);
-  }
-
-  if (btnIndex == LFO_DEST_PW2_SW && btnType == ROX_PRESSED) {
-    lfoDestPW2 = !lfoDestPW2;
-    myControlChange(midiChannel, CClfoDestPW2, lfoDestPW2);
-  }
-
-  if (btnIndex == LFO_DEST_PW3_SW && btnType == ROX_PRESSED) {
-    lfoDestPW3 = !lfoDestPW3;
-    myControlChange(midiChannel, CClfoDestPW3, lfoDestPW3);
-  }
-
-  if (btnIndex == LFO_DEST_FILTER_SW && btnType == ROX_PRESSED) {
-    lfoDestFilter = !lfoDestFilter;
-    myControlChange(midiChannel, CClfoDestFilter, lfoDestFilter);
-  }
-
-  if (btnIndex == OSC1_2_SW && btnType == ROX_PRESSED) {
-    osc1_2 = 1;
-    myControlChange(midiChannel, CCosc1_2, osc1_2);
-  }
-
-  if (btnIndex == OSC1_4_SW && btnType == ROX_PRESSED) {
-    osc1_4 = 1;
-    myControlChange(midiChannel, CCosc1_4, osc1_4);
-  }
-
-  if (btnIndex == OSC1_8_SW && btnType == ROX_PRESSED) {
-    osc1_8 = 1;
-    myControlChange(midiChannel, CCosc1_8, osc1_8);
-  }
-
-  if (btnIndex == OSC1_16_SW && btnType == ROX_PRESSED) {
-    osc1_16 = 1;
-    myControlChange(midiChannel, CCosc1_16, osc1_16);
-  }
-
-  if (btnIndex == OSC2_16_SW && btnType == ROX_PRESSED) {
-    osc2_16 = 1;
-    myControlChange(midiChannel, CCosc2_16, osc2_16);
-  }
-
-  if (btnIndex == OSC2_8_SW && btnType == ROX_PRESSED) {
-    osc2_8 = 1;
-    myControlChange(midiChannel, CCosc2_8, osc2_8);
-  }
-
-  if (btnIndex == OSC2_4_SW && btnType == ROX_PRESSED) {
-    osc2_4 = 1;
-    myControlChange(midiChannel, CCosc2_4, osc2_4);
-  }
-
-  if (btnIndex == OSC2_2_SW && btnType == ROX_PRESSED) {
-    osc2_2 = 1;
-    myControlChange(midiChannel, CCosc2_2, osc2_2);
-  }
-
-  if (btnIndex == OSC2_SAW_SW && btnType == ROX_PRESSED) {
-    osc2Saw = !osc2Saw;
-    myControlChange(midiChannel, CCosc2Saw, osc2Saw);
-  }
-
-  if (btnIndex == OSC2_SQUARE_SW && btnType == ROX_PRESSED) {
-    osc2Square = !osc2Square;
-    myControlChange(midiChannel, CCosc2Square, osc2Square);
-  }
-
-  if (btnIndex == OSC2_TRIANGLE_SW && btnType == ROX_PRESSED) {
-    osc2Triangle = !osc2Triangle;
-    myControlChange(midiChannel, CCosc2Triangle, osc2Triangle);
-  }
-
-  if (btnIndex == OSC1_SAW_SW && btnType == ROX_PRESSED) {
-    osc1Saw = !osc1Saw;
-    myControlChange(midiChannel, CCosc1Saw, osc1Saw);
-  }
-
-  if (btnIndex == OSC1_SQUARE_SW && btnType == ROX_PRESSED) {
-    osc1Square = !osc1Square;
-    myControlChange(midiChannel, CCosc1Square, osc1Square);
-  }
-
-  if (btnIndex == OSC1_TRIANGLE_SW && btnType == ROX_PRESSED) {
-    osc1Triangle = !osc1Triangle;
-    myControlChange(midiChannel, CCosc1Triangle, osc1Triangle);
-  }
-
-  if (btnIndex == OSC3_SAW_SW && btnType == ROX_PRESSED) {
-    osc3Saw = !osc3Saw;
-    myControlChange(midiChannel, CCosc3Saw, osc3Saw);
-  }
-
-  if (btnIndex == OSC3_SQUARE_SW && btnType == ROX_PRESSED) {
-    osc3Square = !osc3Square;
-    myControlChange(midiChannel, CCosc3Square, osc3Square);
-  }
-
-  if (btnIndex == OSC3_TRIANGLE_SW && btnType == ROX_PRESSED) {
-    osc3Triangle = !osc3Triangle;
-    myControlChange(midiChannel, CCosc3Triangle, osc3Triangle);
-  }
-
-  if (btnIndex == SLOPE_SW && btnType == ROX_PRESSED) {
-    slopeSW = !slopeSW;
-    myControlChange(midiChannel, CCslopeSW, slopeSW);
-  }
-
-  if (btnIndex == ECHO_ON_OFF_SW && btnType == ROX_PRESSED) {
-    echoSW = !echoSW;
-    myControlChange(midiChannel, CCechoSW, echoSW);
-  }
-
-  if (btnIndex == ECHO_SYNC_SW && btnType == ROX_PRESSED) {
-    echoSyncSW = !echoSyncSW;
-    myControlChange(midiChannel, CCechoSyncSW, echoSyncSW);
-  }
-
-  if (btnIndex == RELEASE_SW && btnType == ROX_PRESSED) {
-    releaseSW = !releaseSW;
-    myControlChange(midiChannel, CCreleaseSW, releaseSW);
-  }
-
-  if (btnIndex == KEYBOARD_FOLLOW_SW && btnType == ROX_PRESSED) {
-    keyboardFollowSW = !keyboardFollowSW;
-    myControlChange(midiChannel, CCkeyboardFollowSW, keyboardFollowSW);
-  }
-
-  if (btnIndex == UNCONDITIONAL_CONTOUR_SW && btnType == ROX_PRESSED) {
-    unconditionalContourSW = !unconditionalContourSW;
-    myControlChange(midiChannel, CCunconditionalContourSW, unconditionalContourSW);
-  }
-
-  if (btnIndex == RETURN_TO_ZERO_SW && btnType == ROX_PRESSED) {
-    returnSW = !returnSW;
-    myControlChange(midiChannel, CCreturnSW, returnSW);
-  }
-
-  if (btnIndex == REVERB_ON_OFF_SW && btnType == ROX_PRESSED) {
-    reverbSW = !reverbSW;
-    myControlChange(midiChannel, CCreverbSW, reverbSW);
-  }
-
-  if (btnIndex == REVERB_TYPE_SW && btnType == ROX_RELEASED) {
-    reverbTypeSW = 1;
-    myControlChange(midiChannel, CCreverbTypeSW, reverbTypeSW);
-  } else {
-    if (btnIndex == REVERB_TYPE_SW && btnType == ROX_HELD) {
-      reverbTypeExitSW = 1;
-      myControlChange(midiChannel, CCreverbTypeExitSW, reverbTypeExitSW);
-    }
-  }
-
-  if (btnIndex == LIMIT_SW && btnType == ROX_PRESSED) {
-    limitSW = !limitSW;
-    myControlChange(midiChannel, CClimitSW, limitSW);
-  }
-
-  if (btnIndex == MODERN_SW && btnType == ROX_PRESSED) {
-    modernSW = !modernSW;
-    myControlChange(midiChannel, CCmodernSW, modernSW);
-  }
-
-  if (btnIndex == OSC3_2_SW && btnType == ROX_PRESSED) {
-    osc3_2 = 1;
-    myControlChange(midiChannel, CCosc3_2, osc3_2);
-  }
-
-  if (btnIndex == OSC3_4_SW && btnType == ROX_PRESSED) {
-    osc3_4 = 1;
-    myControlChange(midiChannel, CCosc3_4, osc3_4);
-  }
-
-  if (btnIndex == OSC3_8_SW && btnType == ROX_PRESSED) {
-    osc3_8 = 1;
-    myControlChange(midiChannel, CCosc3_8, osc3_8);
-  }
-
-  if (btnIndex == OSC3_16_SW && btnType == ROX_PRESSED) {
-    osc3_16 = 1;
-    myControlChange(midiChannel, CCosc3_16, osc3_16);
-  }
-
-  if (btnIndex == ENSEMBLE_SW && btnType == ROX_PRESSED) {
-    ensembleSW = !ensembleSW;
-    myControlChange(midiChannel, CCensembleSW, ensembleSW);
-  }
-
-  if (btnIndex == LOW_SW && btnType == ROX_PRESSED) {
-    lowSW = !lowSW;
-    myControlChange(midiChannel, CClowSW, lowSW);
-  }
-
-  if (btnIndex == KEYBOARD_CONTROL_SW && btnType == ROX_PRESSED) {
-    keyboardControlSW = !keyboardControlSW;
-    myControlChange(midiChannel, CCkeyboardControlSW, keyboardControlSW);
-  }
-
-  if (btnIndex == OSC_SYNC_SW && btnType == ROX_PRESSED) {
-    oscSyncSW = !oscSyncSW;
-    myControlChange(midiChannel, CCoscSyncSW, oscSyncSW);
-  }
-}
-
 void showSettingsPage() {
   showSettingsPage(settings::current_setting(), settings::current_setting_value(), state);
 }
 
-void midi6CCOut(byte cc, byte value) {
-  MIDI6.sendControlChange(cc, value, midiOutCh);  //MIDI DIN is set to Out
-  delay(1);
-}
-
-void midiCCOut(byte cc, byte value) {
-  if (midiOutCh > 0) {
-    switch (cc) {
-
-      case CCreleaseSW:
-        if (updateParams) {
-          usbMIDI.sendNoteOn(0, 127, midiOutCh);  //MIDI USB is set to Out
-          usbMIDI.sendNoteOff(0, 0, midiOutCh);   //MIDI USB is set to Out
-        }
-        MIDI.sendNoteOn(0, 127, midiOutCh);  //MIDI DIN is set to Out
-        MIDI.sendNoteOff(0, 0, midiOutCh);   //MIDI USB is set to Out
-        break;
-
-      case CCkeyboardFollowSW:
-        if (updateParams) {
-          usbMIDI.sendNoteOn(1, 127, midiOutCh);  //MIDI USB is set to Out
-          usbMIDI.sendNoteOff(1, 0, midiOutCh);   //MIDI USB is set to Out
-        }
-        MIDI.sendNoteOn(1, 127, midiOutCh);  //MIDI DIN is set to Out
-        MIDI.sendNoteOff(1, 0, midiOutCh);   //MIDI USB is set to Out
-        break;
-
-      case CCunconditionalContourSW:
-        if (updateParams) {
-          usbMIDI.sendNoteOn(2, 127, midiOutCh);  //MIDI USB is set to Out
-          usbMIDI.sendNoteOff(2, 0, midiOutCh);   //MIDI USB is set to Out
-        }
-        MIDI.sendNoteOn(2, 127, midiOutCh);  //MIDI DIN is set to Out
-        MIDI.sendNoteOff(2, 0, midiOutCh);   //MIDI USB is set to Out
-        break;
-
-      case CCreturnSW:
-        if (updateParams) {
-          usbMIDI.sendNoteOn(3, 127, midiOutCh);  //MIDI USB is set to Out
-          usbMIDI.sendNoteOff(3, 0, midiOutCh);   //MIDI USB is set to Out
-        }
-        MIDI.sendNoteOn(3, 127, midiOutCh);  //MIDI DIN is set to Out
-        MIDI.sendNoteOff(3, 0, midiOutCh);   //MIDI USB is set to Out
-        break;
-
-      default:
-        if (updateParams) {
-          usbMIDI.sendControlChange(cc, value, midiOutCh);  //MIDI DIN is set to Out
-        }
-        MIDI.sendControlChange(cc, value, midiOutCh);  //MIDI DIN is set to Out
-        break;
-    }
-    delay(2);
-  }
-}
-
 void reinitialiseToPanel() {
   //This sets the current patch to be the same as the current hardware panel state - all the pots
   //The four button controls stay the same state
   //This reinialises the previous hardware values to force a re-read
   muxInput = 0;
+  muxScanReset();
   for (int i = 0; i < MUXCHANNELS; i++) {
     mux1ValuesPrev[i] = RE_READ;
     mux2ValuesPrev[i] = RE_READ;
@@ -4341,6 +3384,7 @@ void reinitialiseToPanel() {
 }
 
 void checkSwitches() {
+  PROFILE_SCOPE(PROF_SWITCHES);
 
   saveButton.update();
   if (saveButton.held()) {
@@ -4512,6 +3556,7 @@ void checkEncoder() {
 
   long encRead = encoder.read();
   if ((encCW && encRead > encPrevious + 3) || (!encCW && encRead < encPrevious - 3)) {
+    byte step = encoderStep();
     switch (state) {
       case PARAMETER:
         state = PATCH;
@@ -4521,10 +3566,10 @@ void checkEncoder() {
         state = PARAMETER;
         break;
       case RECALL:
-        patches.push(patches.shift());
+        for (byte n = 0; n < step; n++) patches.push(patches.shift());
         break;
       case SAVE:
-        patches.push(patches.shift());
+        for (byte n = 0; n < step; n++) patches.push(patches.shift());
         break;
       case PATCHNAMING:
         if (charIndex == TOTALCHARS) charIndex = 0;  //Wrap around
@@ -4532,7 +3577,7 @@ void checkEncoder() {
         showRenamingPage(renamedPatch + currentCharacter);
         break;
       case DELETE:
-        patches.push(patches.shift());
+        for (byte n = 0; n < step; n++) patches.push(patches.shift());
         break;
       case SETTINGS:
         settings::increment_setting();
@@ -4543,8 +3588,10 @@ void checkEncoder() {
         showSettingsPage();
         break;
     }
+    requestDisplay();  //The lists scroll without a state change
     encPrevious = encRead;
   } else if ((encCW && encRead < encPrevious - 3) || (!encCW && encRead > encPrevious + 3)) {
+    byte step = encoderStep();
     switch (state) {
       case PARAMETER:
         state = PATCH;
@@ -4554,10 +3601,10 @@ void checkEncoder() {
         state = PARAMETER;
         break;
       case RECALL:
-        patches.unshift(patches.pop());
+        for (byte n = 0; n < step; n++) patches.unshift(patches.pop());
         break;
       case SAVE:
-        patches.unshift(patches.pop());
+        for (byte n = 0; n < step; n++) patches.unshift(patches.pop());
         break;
       case PATCHNAMING:
         if (charIndex == -1)
@@ -4566,7 +3613,7 @@ void checkEncoder() {
         showRenamingPage(renamedPatch + currentCharacter);
         break;
       case DELETE:
-        patches.unshift(patches.pop());
+        for (byte n = 0; n < step; n++) patches.unshift(patches.pop());
         break;
       case SETTINGS:
         settings::decrement_setting();
@@ -4577,42 +3624,173 @@ void checkEncoder() {
         showSettingsPage();
         break;
     }
+    requestDisplay();  //The lists scroll without a state change
     encPrevious = encRead;
   }
 }
 
-void stopLEDs() {
+void refreshPanelLEDs() {
+  PROFILE_SCOPE(PROF_LEDS);
+  buildLEDFrame(sr);
+  sr.update();
+}
 
-  unsigned long currentMillis = millis();
+//Uncomment to print the slowest loop() pass, e.g. while sweeping a pot
+//#define LOOP_TIME_STATS
 
-  if (chordMemoryWait) {
-    if (currentMillis - learn_timer >= interval) {
-      learn_timer = currentMillis;
-      if (sr.readPin(CHORD_MODE_LED) == HIGH) {
-        sr.writePin(CHORD_MODE_LED, LOW);
-      } else {
-        sr.writePin(CHORD_MODE_LED, HIGH);
-      }
-    }
+#ifdef LOOP_TIME_STATS
+static unsigned long loopTimeMax = 0;
+static unsigned long loopTimeTimer = 0;
+
+void checkLoopTime(unsigned long start) {
+  unsigned long elapsed = micros() - start;
+  if (elapsed > loopTimeMax) loopTimeMax = elapsed;
+  if (millis() - loopTimeTimer > 10000) {
+    loopTimeTimer = millis();
+    Serial.printf("Loop: slowest pass %lu uS\n", loopTimeMax);
+    loopTimeMax = 0;
   }
 }
+#endif
 
-void loop() {
-  checkMux();           // Read the sliders and switches
-  checkSwitches();      // Read the buttons for the program menus etc
-  checkEncoder();       // check the encoder status
-  octoswitch.update();  // read all the buttons for the Quadra
-  sr.update();          // update all the LEDs in the buttons
+#ifdef HEAP_SWEEP_TEST
+static unsigned long heapSweepTimer = 0;
+static int heapSweepValue = 0;
+static int heapSweepDir = 1;
 
-  // Read all the MIDI ports
+//Filter cutoff up and down as if the pot was swept, one step every 2mS
+void heapSweepStep() {
+  if (millis() - heapSweepTimer < 2) return;
+  heapSweepTimer = millis();
+  heapSweepValue += heapSweepDir;
+  if (heapSweepValue <= 0 || heapSweepValue >= 127) heapSweepDir = -heapSweepDir;
+  potControlChange(CCfilterCutoff, heapSweepValue);
+}
+#endif
+
+// The ports are read by midiPollISR(), this handles what they queued
+void midiInTask() {
+  PROFILE_SCOPE(PROF_MIDI_IN);  //Includes the handlers, and so any CC out they send
   myusb.Task();
-  midi1.read();  //USB HOST MIDI Class Compliant
-  MIDI.read(midiChannel);
-  usbMIDI.read(midiChannel);
+#ifdef MIDI_REPLAY
+  midiReplayPoll();
+#endif
+  midiQueueProcess();  //Notes first, then CCs within the time budget
+}
+
+void controlsTask() {
+  checkSwitches();  // Read the buttons for the program menus etc
+  checkEncoder();   // check the encoder status
+  processButtonFrame(sr.buttonFrame());  // dispatch panel buttons from the last scan
+}
 
-  //updateScreen();
+void displayTask() {
+  PROFILE_SCOPE(PROF_DISPLAY);
+  renderDisplayModel();    // latest pot value to the displays
+  checkDisplayRequests();  // page changes for the display thread, it never waits on SPI here
+}
 
-  stopLEDs();  // blink the wave LEDs once when pressed
+void timeoutsTask() {
   sendEscapeKey();
   convertIncomingNote();  // read a note when in learn mode and use it to set the values
 }
+
+//Single letter commands on the USB serial port
+void checkSerialCommands() {
+  while (Serial.available()) {
+    int c = Serial.read();
+    midiTrafficCommand(c);
+#ifdef LOOP_PROFILE
+    profileCommand(c);
+#endif
+  }
+}
+
+//Traffic rates, and the settings page when it shows them
+void trafficTask() {
+  midiTrafficTick();
+  if (state == SETTINGSVALUE && strcmp(settings::current_setting(), TRAFFIC_SETTING) == 0) showSettingsPage();
+}
+
+void setupScheduler() {
+  schedulerAdd("midi in", midiInTask, SCHED_EVERY_PASS, 0, MIDI_IN_DEADLINE_US);
+  schedulerAdd("pots", potsTask, POTS_PERIOD_US, 1);
+  schedulerAdd("controls", controlsTask, CONTROLS_PERIOD_US, 2);
+  schedulerAdd("leds", refreshPanelLEDs, LEDS_PERIOD_US, 3);  // LEDs from the patch state, only sent when they changed
+  schedulerAdd("display", displayTask, DISPLAY_PERIOD_US, 4);
+  schedulerAdd("lcd", lcdFlush, LCD_PERIOD_US, 5);  // a few changed LCD cells per run
+  schedulerAdd("timeouts", timeoutsTask, TIMEOUTS_PERIOD_US, 6);
+  schedulerAdd("traffic", trafficTask, TRAFFIC_TICK_US, 7);
+}
+
+#ifdef PASSTHROUGH_BENCH
+static unsigned long passthroughBenchTimer = 0;
+
+//Recall the current patch every PASSTHROUGH_BENCH_MS, the loop is held up for each one
+void passthroughBenchStep() {
+  if (millis() - passthroughBenchTimer < PASSTHROUGH_BENCH_MS) return;
+  passthroughBenchTimer = millis();
+  recallPatch(patchNo);
+}
+#endif
+
+void loop() {
+#ifdef LOOP_TIME_STATS
+  unsigned long loopStart = micros();
+#endif
+  schedulerRun();
+  usbMidiFlush();  //USB MIDI from this pass as one transaction
+
+#ifdef SCHED_STATS
+  checkSchedulerStats();
+#endif
+#ifdef MIDI_QUEUE_STATS
+  checkMidiQueueStats();
+#endif
+#ifdef MIDI_ROUTING_STATS
+  checkMidiRoutingStats();
+#endif
+#ifdef USB_MIDI_STATS
+  checkUsbMidiStats();
+#endif
+#ifdef DIN_THINNING_STATS
+  checkDinThinningStats();
+#endif
+  checkSerialCommands();
+#ifdef LATENCY_BENCH
+  latencyBenchStep();
+#endif
+#ifdef MIDI_REPLAY
+  midiReplayStep();
+#endif
+#ifdef PASSTHROUGH_BENCH
+  passthroughBenchStep();
+#endif
+#ifdef MUX_SCAN_STATS
+  checkMuxScanStats();
+#endif
+#ifdef POT_THINNING_STATS
+  checkPotThinningStats();
+#endif
+#ifdef PANEL_IO_STATS
+  sr.checkStats();
+#endif
+#ifdef DISPLAY_STATS
+  checkDisplayStats();
+#endif
+#ifdef TFT_STATS
+  checkTftStats();
+#endif
+#ifdef LIST_SCROLL_STATS
+  checkListScrollStats();
+#endif
+#ifdef HEAP_STATS
+#ifdef HEAP_SWEEP_TEST
+  heapSweepStep();
+#endif
+  checkHeapStats();
+#endif
+#ifdef LOOP_TIME_STATS
+  checkLoopTime(loopStart);
+#endif
+}
@@ -0,0 +1,95 @@
+// CC output to DIN, USB and the HID keystroke port
+//
+// midiCCOut() sends a parameter CC to the outputs the route of the CC's source
+// selects, the panel or the port the CC being handled came in on
+// (MidiRouting.h). A few switches go out as a note on and off instead. The
+// DIN and USB sends hold MidiOutGuard, so the poll interrupt leaves notes to
+// the queue until they are done. Every message is counted in the traffic stats.
+
+void midi6CCOut(byte cc, byte value) {
+  MIDI6.sendControlChange(cc, value, midiOutCh);  //MIDI DIN is set to Out
+  midiTrafficMessage(TRAFFIC_HID_OUT, 0xB0, cc, value);
+  delay(1);
+}
+
+//The sends only, the poll interrupt passes notes through again during the delay after them
+static void midiCCSend(byte cc, byte value) {
+  MidiOutGuard guard;
+  uint8_t to = midiRoute(midiRouteSource, ROUTE_CCS);
+  switch (cc) {
+
+    case CCreleaseSW:
+      if (to & ROUTE_TO_USB) {
+        usbMidiQueue(0x90, 0, 127, midiOutCh);  //MIDI USB is set to Out
+        usbMidiQueue(0x80, 0, 0, midiOutCh);    //MIDI USB is set to Out
+      }
+      if (to & ROUTE_TO_DIN) {
+        MIDI.sendNoteOn(0, 127, midiOutCh);  //MIDI DIN is set to Out
+        MIDI.sendNoteOff(0, 0, midiOutCh);   //MIDI USB is set to Out
+        midiTrafficMessage(TRAFFIC_DIN_OUT, 0x90, 0, 127);
+        midiTrafficMessage(TRAFFIC_DIN_OUT, 0x80, 0, 0);
+      }
+      break;
+
+    case CCkeyboardFollowSW:
+      if (to & ROUTE_TO_USB) {
+        usbMidiQueue(0x90, 1, 127, midiOutCh);  //MIDI USB is set to Out
+        usbMidiQueue(0x80, 1, 0, midiOutCh);    //MIDI USB is set to Out
+      }
+      if (to & ROUTE_TO_DIN) {
+        MIDI.sendNoteOn(1, 127, midiOutCh);  //MIDI DIN is set to Out
+        MIDI.sendNoteOff(1, 0, midiOutCh);   //MIDI USB is set to Out
+        midiTrafficMessage(TRAFFIC_DIN_OUT, 0x90, 1, 127);
+        midiTrafficMessage(TRAFFIC_DIN_OUT, 0x80, 1, 0);
+      }
+      break;
+
+    case CCunconditionalContourSW:
+      if (to & ROUTE_TO_USB) {
+        usbMidiQueue(0x90, 2, 127, midiOutCh);  //MIDI USB is set to Out
+        usbMidiQueue(0x80, 2, 0, midiOutCh);    //MIDI USB is set to Out
+      }
+      if (to & ROUTE_TO_DIN) {
+        MIDI.sendNoteOn(2, 127, midiOutCh);  //MIDI DIN is set to Out
+        MIDI.sendNoteOff(2, 0, midiOutCh);   //MIDI USB is set to Out
+        midiTrafficMessage(TRAFFIC_DIN_OUT, 0x90, 2, 127);
+        midiTrafficMessage(TRAFFIC_DIN_OUT, 0x80, 2, 0);
+      }
+      break;
+
+    case CCreturnSW:
+      if (to & ROUTE_TO_USB) {
+        usbMidiQueue(0x90, 3, 127, midiOutCh);  //MIDI USB is set to Out
+        usbMidiQueue(0x80, 3, 0, midiOutCh);    //MIDI USB is set to Out
+      }
+      if (to & ROUTE_TO_DIN) {
+        MIDI.sendNoteOn(3, 127, midiOutCh);  //MIDI DIN is set to Out
+        MIDI.sendNoteOff(3, 0, midiOutCh);   //MIDI USB is set to Out
+        midiTrafficMessage(TRAFFIC_DIN_OUT, 0x90, 3, 127);
+        midiTrafficMessage(TRAFFIC_DIN_OUT, 0x80, 3, 0);
+      }
+      break;
+
+    default:
+      if (to & ROUTE_TO_USB) {
+        usbMidiQueue(0xB0, cc, value, midiOutCh);  //MIDI USB is set to Out
+      }
+      if (to & ROUTE_TO_DIN) {
+        MIDI.sendControlChange(cc, value, midiOutCh);  //MIDI DIN is set to Out
+        midiTrafficMessage(TRAFFIC_DIN_OUT, 0xB0, cc, value);
+      }
+      midiEchoSent(to, cc, value);
+      break;
+  }
+}
+
+void midiCCOut(byte cc, byte value) {
+  PROFILE_SCOPE(PROF_CC_OUT);
+  if (midiOutCh > 0) {
+    midiCCSend(cc, value);
+#ifdef LATENCY_BENCH
+    latencyBenchOutput(cc);
+#endif
+    delay(2);
+  }
+}
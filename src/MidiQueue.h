@@ -0,0 +1,333 @@
+// Timestamped MIDI input queue for the DIN, USB device and USB host ports
+//
+// The ports are read from a timer interrupt every MIDI_POLL_US, whatever the
+// main loop is doing. The read callbacks stamp each message with micros() and
+// push it into one of two rings. Notes, pitch bend, aftertouch and the mod
+// wheel are also forwarded to the DIN and USB outputs right there, the passthrough fast path.
+// While loop() is itself sending (MidiOutGuard) the interrupt leaves the
+// message for the queue instead, the serial and USB transmit code is not
+// reentrant. Until loop() has sent what was left in the performance ring the
+// interrupt leaves everything after it there too, so notes keep their order.
+//
+// midiQueueProcess() then handles the performance ring (notes, pitch bend,
+// aftertouch, mod wheel) in full, in arrival order, before the control ring (CCs,
+// program changes), which gets MIDI_QUEUE_BUDGET_US per call. One CC that runs
+// the whole update path can no longer hold up notes arriving on another port.
+//
+// The rings are single producer (the poll interrupt), single consumer (loop())
+// and need no locks.
+
+#define MIDI_QUEUE_SIZE 64  //Per ring, a power of two
+#define MIDI_QUEUE_BUDGET_US 500
+#define MIDI_POLL_US 250
+#define MIDI_POLL_PRIORITY 144  //Below USB, which must be able to interrupt the reads
+#define MIDI_POLL_READS 8       //Messages per port per poll
+
+//Uncomment to print per port message counts, drops, queue and passthrough latency
+//#define MIDI_QUEUE_STATS
+#define MIDI_QUEUE_STATS_INTERVAL 10000
+//Uncomment as well to recall the current patch every PASSTHROUGH_BENCH_MS, play notes and
+//the stats show their latency while a recall blocks the loop
+//#define PASSTHROUGH_BENCH
+#define PASSTHROUGH_BENCH_MS 2000
+
+enum { MIDI_Q_NOTE_ON, MIDI_Q_NOTE_OFF, MIDI_Q_PITCH_BEND, MIDI_Q_AFTERTOUCH, MIDI_Q_MOD_WHEEL, MIDI_Q_CONTROL, MIDI_Q_PROGRAM, MIDI_Q_TRAFFIC_QUERY };
+static const uint8_t midiQueueStatus[] = { 0x90, 0x80, 0xE0, 0xD0, 0xB0, 0xB0, 0xC0, 0xF0 };
+
+void myNoteOn(byte channel, byte note, byte velocity);
+void myConvertControlChange(byte channel, byte number, byte value);
+void myProgramChange(byte channel, byte program);
+void midiReplayHandled(uint32_t arrival);
+
+struct MidiQueueEvent {
+  uint32_t time;
+  uint8_t port;
+  uint8_t type;
+  uint8_t channel;
+  uint8_t data1;
+  int16_t data2;  //Pitch bend is signed
+  bool forwarded;  //Already sent by the passthrough
+  bool replayed;   //From the replay benchmark
+};
+
+struct MidiQueueRing {
+  MidiQueueEvent events[MIDI_QUEUE_SIZE];
+  volatile uint16_t head;  //Written by the producer only
+  volatile uint16_t tail;  //Written by the consumer only
+};
+
+static MidiQueueRing midiPerformanceRing;
+static MidiQueueRing midiControlRing;
+static uint32_t midiQueueDrops[MIDI_PORTS] = {};
+static volatile uint16_t passthroughDeferredIn = 0;   //Left for loop() to send, written by the producer only
+static volatile uint16_t passthroughDeferredOut = 0;  //Sent by loop(), written by the consumer only
+static IntervalTimer midiPollTimer;
+
+#ifdef MIDI_QUEUE_STATS
+static const char *const midiPortNames[MIDI_PORTS] = { "din", "usb device", "usb host" };
+static uint32_t midiQueueIn[MIDI_PORTS] = {};
+static uint32_t midiQueueLatencyTotal[MIDI_PORTS] = {};
+static uint32_t midiQueueLatencyMax[MIDI_PORTS] = {};
+static uint16_t midiQueueDepthMax = 0;
+static volatile uint32_t passthroughFast = 0;
+static volatile uint32_t passthroughFastMax = 0;
+static uint32_t passthroughDeferred = 0;
+static uint32_t passthroughDeferredTotal = 0;
+static uint32_t passthroughDeferredMax = 0;
+static uint32_t passthroughRecallMax = 0;  //Deferred while a patch recall held up the loop
+static unsigned long midiQueueStatsTimer = 0;
+#endif
+
+//To the outputs the port's note route goes to
+static void passthroughSend(uint8_t port, uint8_t type, byte channel, byte data1, int data2) {
+  uint8_t to = midiRoute(port, ROUTE_NOTES);
+  switch (type) {
+    case MIDI_Q_NOTE_ON:
+      if (!learning) {
+        if (to & ROUTE_TO_DIN) {
+          dinBeforeNote();
+          MIDI.sendNoteOn(data1, data2, channel);
+          midiTrafficMessage(TRAFFIC_DIN_OUT, 0x90, data1, data2);
+        }
+        if (to & ROUTE_TO_USB) usbMIDI.sendNoteOn(data1, data2, channel);
+      }
+      break;
+    case MIDI_Q_NOTE_OFF:
+      if (!learning) {
+        if (to & ROUTE_TO_DIN) {
+          dinBeforeNote();
+          MIDI.sendNoteOff(data1, data2, channel);
+          midiTrafficMessage(TRAFFIC_DIN_OUT, 0x80, data1, data2);
+        }
+        if (to & ROUTE_TO_USB) usbMIDI.sendNoteOff(data1, data2, channel);
+      }
+      break;
+    case MIDI_Q_PITCH_BEND:
+      if (to & ROUTE_TO_DIN) dinSendContinuous(DIN_THIN_PITCH_BEND, channel, data2);
+      if (to & ROUTE_TO_USB) usbMIDI.sendPitchBend(data2, channel);
+      break;
+    case MIDI_Q_AFTERTOUCH:
+      if (to & ROUTE_TO_DIN) dinSendContinuous(DIN_THIN_AFTERTOUCH, channel, data1);
+      if (to & ROUTE_TO_USB) usbMIDI.sendAfterTouch(data1, channel);
+      break;
+    case MIDI_Q_MOD_WHEEL:
+      if (to & ROUTE_TO_DIN) dinSendContinuous(DIN_THIN_MOD_WHEEL, channel, data2);
+      if (to & ROUTE_TO_USB) usbMIDI.sendControlChange(CCmodWheelinput, data2, channel);
+      break;
+  }
+  if (to & ROUTE_TO_USB) {
+    if (!learning || type > MIDI_Q_NOTE_OFF) midiTrafficMessage(TRAFFIC_USB_OUT, midiQueueStatus[type], data1, data2);
+    usbMidiSendNow();
+  }
+}
+
+//From the poll interrupt, false when loop() is sending, or has yet to send earlier ones, and the queue has to forward it
+static bool passthroughForward(uint8_t port, uint8_t type, byte channel, byte data1, int data2) {
+  if (midiOutBusy || passthroughDeferredIn != passthroughDeferredOut) return false;
+#ifdef MIDI_QUEUE_STATS
+  uint32_t start = micros();
+#endif
+  passthroughSend(port, type, channel, data1, data2);
+#ifdef MIDI_QUEUE_STATS
+  uint32_t elapsed = micros() - start;
+  passthroughFast++;
+  if (elapsed > passthroughFastMax) passthroughFastMax = elapsed;
+#endif
+  return true;
+}
+
+static bool midiQueuePushAt(uint32_t time, uint8_t port, uint8_t type, uint8_t channel, uint8_t data1, int16_t data2, bool forwarded, bool replayed) {
+  MidiQueueRing &ring = type < MIDI_Q_CONTROL ? midiPerformanceRing : midiControlRing;
+  if (type != MIDI_Q_TRAFFIC_QUERY) midiTrafficMessage(port, midiQueueStatus[type], data1, data2);
+  uint16_t head = ring.head;
+  if ((uint16_t)(head - ring.tail) >= MIDI_QUEUE_SIZE) {
+    midiQueueDrops[port]++;
+    midiTrafficDropped(port);
+    return false;
+  }
+  ring.events[head & (MIDI_QUEUE_SIZE - 1)] = { time, port, type, channel, data1, data2, forwarded, replayed };
+  __sync_synchronize();  //The event is written before it is published
+  ring.head = head + 1;
+  if (type < MIDI_Q_CONTROL && !forwarded) passthroughDeferredIn++;
+#ifdef MIDI_QUEUE_STATS
+  if ((uint16_t)(head + 1 - ring.tail) > midiQueueDepthMax) midiQueueDepthMax = head + 1 - ring.tail;
+#endif
+  return true;
+}
+
+void midiQueuePush(uint8_t port, uint8_t type, uint8_t channel, uint8_t data1, int16_t data2, bool forwarded) {
+  midiQueuePushAt(micros(), port, type, channel, data1, data2, forwarded, false);
+}
+
+//For the replay benchmark in loop(), time is when the message reached the modelled port. False when the ring was full.
+bool midiQueuePushReplay(uint32_t time, uint8_t port, uint8_t type, uint8_t channel, uint8_t data1, int16_t data2) {
+  __disable_irq();
+  bool queued = midiQueuePushAt(time, port, type, channel, data1, data2, false, true);
+  __enable_irq();
+  return queued;
+}
+
+//Port callbacks, one set per port, called from the poll interrupt
+template<uint8_t port> void queueNoteOn(byte channel, byte note, byte velocity) {
+  midiQueuePush(port, MIDI_Q_NOTE_ON, channel, note, velocity, passthroughForward(port, MIDI_Q_NOTE_ON, channel, note, velocity));
+}
+template<uint8_t port> void queueNoteOff(byte channel, byte note, byte velocity) {
+  midiQueuePush(port, MIDI_Q_NOTE_OFF, channel, note, velocity, passthroughForward(port, MIDI_Q_NOTE_OFF, channel, note, velocity));
+}
+template<uint8_t port> void queuePitchBend(byte channel, int bend) {
+  midiQueuePush(port, MIDI_Q_PITCH_BEND, channel, 0, bend, passthroughForward(port, MIDI_Q_PITCH_BEND, channel, 0, bend));
+}
+template<uint8_t port> void queueAfterTouch(byte channel, byte pressure) {
+  midiQueuePush(port, MIDI_Q_AFTERTOUCH, channel, pressure, 0, passthroughForward(port, MIDI_Q_AFTERTOUCH, channel, pressure, 0));
+}
+template<uint8_t port> void queueControlChange(byte channel, byte number, byte value) {
+  if (number == CCmodWheelinput) {  //A performance control, passed through like pitch bend
+    midiQueuePush(port, MIDI_Q_MOD_WHEEL, channel, number, value, passthroughForward(port, MIDI_Q_MOD_WHEEL, channel, number, value));
+    return;
+  }
+  midiQueuePush(port, MIDI_Q_CONTROL, channel, number, value, false);
+}
+template<uint8_t port> void queueProgramChange(byte channel, byte program) {
+  midiQueuePush(port, MIDI_Q_PROGRAM, channel, program, 0, false);
+}
+//SysEx is only counted, apart from traffic queries
+template<uint8_t port> void queueSysEx(const uint8_t *data, uint16_t length, bool complete) {
+  if (!complete) {
+    midiTraffic[port].bytes += length;
+    return;
+  }
+  midiTrafficCount(port, 0xF0, 0, 0, length);
+  if (midiTrafficIsQuery(data, length)) midiQueuePush(port, MIDI_Q_TRAFFIC_QUERY, 0, data[3], data[4], false);
+}
+template<uint8_t port> void queueSysExComplete(byte *data, unsigned length) {
+  queueSysEx<port>(data, length, true);
+}
+
+void midiPollISR() {
+  for (int i = 0; i < MIDI_POLL_READS && MIDI.read(midiChannel); i++) {}
+  for (int i = 0; i < MIDI_POLL_READS && usbMIDI.read(midiChannel); i++) {}
+  for (int i = 0; i < MIDI_POLL_READS && midi1.read(); i++) {}  //USB HOST MIDI Class Compliant
+  dinThinningPoll();
+  usbMidiPoll();
+}
+
+//The port handlers queue what arrives on each of the three ports
+void setupMidiInputs() {
+  midi1.setHandleControlChange(queueControlChange<MIDI_PORT_USB_HOST>);
+  midi1.setHandleProgramChange(queueProgramChange<MIDI_PORT_USB_HOST>);
+  midi1.setHandleNoteOff(queueNoteOff<MIDI_PORT_USB_HOST>);
+  midi1.setHandleNoteOn(queueNoteOn<MIDI_PORT_USB_HOST>);
+  midi1.setHandlePitchChange(queuePitchBend<MIDI_PORT_USB_HOST>);
+  midi1.setHandleAfterTouch(queueAfterTouch<MIDI_PORT_USB_HOST>);
+  midi1.setHandleSystemExclusive(queueSysEx<MIDI_PORT_USB_HOST>);
+
+  usbMIDI.setHandleControlChange(queueControlChange<MIDI_PORT_USB_DEVICE>);
+  usbMIDI.setHandleProgramChange(queueProgramChange<MIDI_PORT_USB_DEVICE>);
+  usbMIDI.setHandleNoteOff(queueNoteOff<MIDI_PORT_USB_DEVICE>);
+  usbMIDI.setHandleNoteOn(queueNoteOn<MIDI_PORT_USB_DEVICE>);
+  usbMIDI.setHandlePitchChange(queuePitchBend<MIDI_PORT_USB_DEVICE>);
+  usbMIDI.setHandleAfterTouch(queueAfterTouch<MIDI_PORT_USB_DEVICE>);
+  usbMIDI.setHandleSystemExclusive(queueSysEx<MIDI_PORT_USB_DEVICE>);
+
+  MIDI.setHandleControlChange(queueControlChange<MIDI_PORT_DIN>);
+  MIDI.setHandleProgramChange(queueProgramChange<MIDI_PORT_DIN>);
+  MIDI.setHandleNoteOn(queueNoteOn<MIDI_PORT_DIN>);
+  MIDI.setHandleNoteOff(queueNoteOff<MIDI_PORT_DIN>);
+  MIDI.setHandlePitchBend(queuePitchBend<MIDI_PORT_DIN>);
+  MIDI.setHandleAfterTouchChannel(queueAfterTouch<MIDI_PORT_DIN>);
+  MIDI.setHandleSystemExclusive(queueSysExComplete<MIDI_PORT_DIN>);
+}
+
+//After the port handlers are set, loop() no longer reads the ports itself
+void setupMidiPoll() {
+  midiTrafficClear();
+  dinThinningSetup();
+  midiPollTimer.priority(MIDI_POLL_PRIORITY);
+  midiPollTimer.begin(midiPollISR, MIDI_POLL_US);
+}
+
+static bool midiQueueHandleNext(MidiQueueRing &ring) {
+  uint16_t tail = ring.tail;
+  if (tail == ring.head) return false;
+  MidiQueueEvent e = ring.events[tail & (MIDI_QUEUE_SIZE - 1)];
+  ring.tail = tail + 1;
+#ifdef MIDI_QUEUE_STATS
+  uint32_t latency = micros() - e.time;
+  midiQueueIn[e.port]++;
+  midiQueueLatencyTotal[e.port] += latency;
+  if (latency > midiQueueLatencyMax[e.port]) midiQueueLatencyMax[e.port] = latency;
+#endif
+  if (e.type < MIDI_Q_CONTROL && !e.forwarded) {
+    MidiOutGuard guard;
+    passthroughSend(e.port, e.type, e.channel, e.data1, e.data2);
+    passthroughDeferredOut++;  //Before the guard goes, the interrupt may forward again
+#ifdef MIDI_QUEUE_STATS
+    passthroughDeferred++;
+    passthroughDeferredTotal += latency;
+    if (latency > passthroughDeferredMax) passthroughDeferredMax = latency;
+    if (recallPatchFlag && latency > passthroughRecallMax) passthroughRecallMax = latency;
+#endif
+  }
+  if (e.type == MIDI_Q_CONTROL && midiEchoDrop(e.port, e.data1, e.data2, e.time)) {
+    midiTrafficEcho(e.port);
+#ifdef MIDI_REPLAY
+    if (e.replayed) midiReplayHandled(e.time);
+#endif
+    return true;
+  }
+  midiRouteSource = e.port;  //CCs sent while handling this follow the port's route
+  switch (e.type) {
+    case MIDI_Q_NOTE_ON:
+      myNoteOn(e.channel, e.data1, e.data2);
+      break;
+    case MIDI_Q_MOD_WHEEL:
+      midiEchoSent(midiRoute(e.port, ROUTE_NOTES), CCmodWheelinput, e.data2);
+      break;
+    case MIDI_Q_CONTROL:
+      myConvertControlChange(e.channel, e.data1, e.data2);
+      break;
+    case MIDI_Q_PROGRAM:
+      myProgramChange(e.channel, e.data1);
+      break;
+    case MIDI_Q_TRAFFIC_QUERY:
+      midiTrafficReply(e.port, e.data1, e.data2);
+      break;
+  }
+  midiRouteSource = ROUTE_PANEL;
+#ifdef MIDI_REPLAY
+  if (e.replayed) midiReplayHandled(e.time);
+#endif
+  return true;
+}
+
+//Called from the MIDI input task
+void midiQueueProcess() {
+  while (midiQueueHandleNext(midiPerformanceRing)) {}
+  uint32_t start = micros();
+  while (micros() - start < MIDI_QUEUE_BUDGET_US && midiQueueHandleNext(midiControlRing)) {}
+  if (midiTrafficReplyDue()) {
+    MidiOutGuard guard;
+    midiTrafficReplyStep();
+  }
+}
+
+#ifdef MIDI_QUEUE_STATS
+void checkMidiQueueStats() {
+  if (millis() - midiQueueStatsTimer > MIDI_QUEUE_STATS_INTERVAL) {
+    midiQueueStatsTimer = millis();
+    Serial.printf("MIDI queue: deepest %u\n", midiQueueDepthMax);
+    for (int i = 0; i < MIDI_PORTS; i++) {
+      Serial.printf("  %-10s in %lu dropped %lu | latency avg %lu max %lu uS\n", midiPortNames[i], midiQueueIn[i], midiQueueDrops[i],
+                    midiQueueIn[i] ? midiQueueLatencyTotal[i] / midiQueueIn[i] : 0, midiQueueLatencyMax[i]);
+      midiQueueIn[i] = midiQueueDrops[i] = midiQueueLatencyTotal[i] = midiQueueLatencyMax[i] = 0;
+    }
+    Serial.printf("Passthrough: fast %lu max %lu uS | deferred %lu avg %lu max %lu uS | during recall max %lu uS (+ up to %u uS poll wait)\n",
+                  passthroughFast, passthroughFastMax, passthroughDeferred,
+                  passthroughDeferred ? passthroughDeferredTotal / passthroughDeferred : 0, passthroughDeferredMax,
+                  passthroughRecallMax, MIDI_POLL_US);
+    midiQueueDepthMax = 0;
+    passthroughFast = passthroughFastMax = 0;
+    passthroughDeferred = passthroughDeferredTotal = passthroughDeferredMax = passthroughRecallMax = 0;
+  }
+}
+#endif
@@ -0,0 +1,331 @@
+// Recorded MIDI replay throughput benchmark
+//
+// With MIDI_REPLAY every file in /replay on the SD card is replayed into the
+// MIDI input handlers, once as each input port and at each REPLAY_SPEEDUPS
+// factor. Files ending in .mid are standard MIDI files (format 0, or the
+// first track of format 1). Anything else is a raw byte stream timed at the
+// DIN wire rate of 320uS a byte.
+//
+// The replay is polled from the MIDI input task and queues one message
+// per poll, as MIDI.read(), usbMIDI.read() and midi1.read() do. Messages
+// arrive into a model of the port's receive buffer: the 64 byte Serial1
+// buffer for DIN, the 80 packet queue of the USB host driver, and no limit
+// for the USB device (the host waits). A message that arrives at a full
+// buffer is dropped, as is one that finds the MIDI input queue full. Each run
+// prints one CSV line:
+//
+//   midi_replay,<file>,<port>,<speedup>,<messages>,<dropped>,<queue_dropped>,<msgs_per_s>,<avg_lag_us>,<max_lag_us>,<max_out_lag_us>
+//
+// Messages are those the queue has handled, passthrough and handler included.
+// Lag is from a message's arrival to the end of its handling. Out lag is the
+// worst backlog in the DIN out buffer, in uS at the wire rate.
+
+//Uncomment to replay the files in /replay after boot
+//#define MIDI_REPLAY
+#define REPLAY_START_MS 5000
+#define REPLAY_MAX_EVENTS 8192
+#define REPLAY_SPEEDUPS { 1, 4, 16 }
+#define REPLAY_DIN_RX_BYTES 64
+#define REPLAY_USB_HOST_RX_PACKETS 80
+#define REPLAY_BYTE_US 320  //31250 baud, 10 bits a byte
+
+#ifdef MIDI_REPLAY
+
+static const char *const replayPortNames[MIDI_PORTS] = { "din", "usb_device", "usb_host" };
+static const uint8_t replaySpeedups[] = REPLAY_SPEEDUPS;
+#define REPLAY_SPEEDUP_COUNT (sizeof(replaySpeedups) / sizeof(replaySpeedups[0]))
+
+struct ReplayEvent {
+  uint32_t timeUs;
+  uint8_t status;
+  uint8_t data1;
+  uint8_t data2;
+};
+
+DMAMEM static ReplayEvent replayEvents[REPLAY_MAX_EVENTS];
+static uint32_t replayDropped[REPLAY_MAX_EVENTS / 32];
+static uint16_t replayCount = 0;
+
+static File replayDir;
+static char replayName[16];
+static bool replayRunning = false;
+static bool replayDone = false;
+static uint8_t replayPort = 0;
+static uint8_t replaySpeedupIndex = 0;
+
+//Per run
+static uint32_t replayStartUs = 0;
+static uint32_t replayLastUs = 0;
+static uint16_t replayArrived = 0;
+static uint16_t replayNext = 0;
+static uint16_t replayBuffered = 0;  //Bytes for DIN, packets for USB host
+static uint16_t replayQueued = 0;
+static uint16_t replayHandled = 0;  //By midiQueueHandleNext()
+static uint16_t replayDrops = 0;
+static uint16_t replayQueueDrops = 0;
+static uint64_t replayLagTotal = 0;
+static uint32_t replayLagMax = 0;
+static int replayOutIdle = 0;
+static int replayOutMax = 0;
+
+static uint8_t replayDataBytes(uint8_t status) {
+  uint8_t type = status & 0xF0;
+  return type == 0xC0 || type == 0xD0 ? 1 : 2;
+}
+
+static void replayAdd(uint32_t timeUs, uint8_t status, uint8_t data1, uint8_t data2) {
+  if (replayCount < REPLAY_MAX_EVENTS) replayEvents[replayCount++] = { timeUs, status, data1, data2 };
+}
+
+static bool replayReadVlq(File &f, uint32_t &v) {
+  v = 0;
+  for (int i = 0; i < 4; i++) {
+    int b = f.read();
+    if (b < 0) return false;
+    v = (v << 7) | (b & 0x7F);
+    if (!(b & 0x80)) return true;
+  }
+  return false;
+}
+
+static uint32_t replayBigEndian(const uint8_t *p, int n) {
+  uint32_t v = 0;
+  while (n--) v = (v << 8) | *p++;
+  return v;
+}
+
+static bool replayLoadSmf(File &f) {
+  uint8_t chunk[14];
+  if (f.read(chunk, 14) != 14 || memcmp(chunk, "MThd", 4) != 0) return false;
+  uint32_t division = replayBigEndian(chunk + 12, 2);
+  if (division == 0 || division & 0x8000) return false;  //SMPTE time is not supported
+  f.seek(8 + replayBigEndian(chunk + 4, 4));
+  uint32_t length = 0;
+  while (true) {
+    if (f.read(chunk, 8) != 8) return false;
+    length = replayBigEndian(chunk + 4, 4);
+    if (memcmp(chunk, "MTrk", 4) == 0) break;
+    f.seek(f.position() + length);
+  }
+  uint32_t end = f.position() + length;
+  uint32_t tempo = 500000;  //uS per quarter note until a tempo event
+  uint64_t timeUs = 0;
+  uint8_t status = 0;
+  while (f.position() < end) {
+    uint32_t delta, len;
+    if (!replayReadVlq(f, delta)) return false;
+    timeUs += (uint64_t)delta * tempo / division;
+    int b = f.read();
+    if (b < 0) return false;
+    if (b == 0xFF) {
+      int type = f.read();
+      if (!replayReadVlq(f, len)) return false;
+      if (type == 0x51 && len == 3) {
+        uint8_t t[3];
+        f.read(t, 3);
+        tempo = replayBigEndian(t, 3);
+      } else {
+        f.seek(f.position() + len);
+      }
+      continue;
+    }
+    if (b == 0xF0 || b == 0xF7) {
+      if (!replayReadVlq(f, len)) return false;
+      f.seek(f.position() + len);
+      continue;
+    }
+    uint8_t data1;
+    if (b & 0x80) {
+      status = b;
+      data1 = f.read();
+    } else {
+      if (!status) return false;
+      data1 = b;  //Running status
+    }
+    uint8_t data2 = replayDataBytes(status) == 2 ? f.read() : 0;
+    replayAdd(timeUs, status, data1, data2);
+  }
+  return true;
+}
+
+static bool replayLoadRaw(File &f) {
+  uint32_t byteCount = 0;
+  uint8_t status = 0;
+  uint8_t data[2];
+  uint8_t have = 0;
+  int b;
+  while ((b = f.read()) >= 0) {
+    byteCount++;
+    if (b >= 0xF8) continue;  //Real time
+    if (b & 0x80) {
+      status = b < 0xF0 ? b : 0;  //SysEx and system common data is skipped
+      have = 0;
+      continue;
+    }
+    if (!status) continue;
+    data[have++] = b;
+    if (have == replayDataBytes(status)) {
+      replayAdd(byteCount * REPLAY_BYTE_US, status, data[0], have == 2 ? data[1] : 0);
+      have = 0;
+    }
+  }
+  return true;
+}
+
+static bool replayIsDropped(uint16_t i) {
+  return replayDropped[i >> 5] & (1UL << (i & 31));
+}
+
+static uint32_t replayDue(uint16_t i) {
+  return replayStartUs + replayEvents[i].timeUs / replaySpeedups[replaySpeedupIndex];
+}
+
+static void replayStartRun() {
+  memset(replayDropped, 0, sizeof(replayDropped));
+  replayArrived = replayNext = replayBuffered = 0;
+  replayQueued = replayHandled = replayDrops = replayQueueDrops = 0;
+  replayLagTotal = 0;
+  replayLagMax = 0;
+  replayOutIdle = Serial1.availableForWrite();
+  replayOutMax = 0;
+  replayStartUs = replayLastUs = micros();
+}
+
+//Next file in /replay, false when there are no more
+static bool replayOpenNext() {
+  while (true) {
+    File f = replayDir.openNextFile();
+    if (!f) return false;
+    if (f.isDirectory()) {
+      f.close();
+      continue;
+    }
+    strncpy(replayName, f.name(), sizeof(replayName) - 1);
+    replayName[sizeof(replayName) - 1] = '\0';
+    size_t n = strlen(replayName);
+    bool smf = n > 4 && strcasecmp(replayName + n - 4, ".mid") == 0;
+    replayCount = 0;
+    bool ok = smf ? replayLoadSmf(f) : replayLoadRaw(f);
+    f.close();
+    if (ok && replayCount > 0) return true;
+    Serial.printf("midi_replay,%s,unreadable\n", replayName);
+  }
+}
+
+static void replayReport() {
+  uint32_t elapsed = replayLastUs - replayStartUs;
+  Serial.printf("midi_replay,%s,%s,%u,%u,%u,%u,%lu,%lu,%lu,%lu\n", replayName, replayPortNames[replayPort],
+                replaySpeedups[replaySpeedupIndex], replayHandled, replayDrops, replayQueueDrops,
+                elapsed ? (uint32_t)((uint64_t)replayHandled * 1000000 / elapsed) : 0,
+                replayHandled ? (uint32_t)(replayLagTotal / replayHandled) : 0, replayLagMax,
+                (uint32_t)replayOutMax * REPLAY_BYTE_US);
+}
+
+static void replayPush(uint32_t arrival, uint8_t type, byte channel, uint8_t data1, int16_t data2) {
+  if (midiQueuePushReplay(arrival, replayPort, type, channel, data1, data2)) {
+    replayQueued++;
+  } else {
+    replayQueueDrops++;
+  }
+}
+
+static void replayDispatch(const ReplayEvent &e, uint32_t arrival) {
+  byte channel = (e.status & 0x0F) + 1;
+  //DIN and USB device are read with MIDI.read(midiChannel), the USB host takes every channel
+  if (replayPort != MIDI_PORT_USB_HOST && midiChannel != MIDI_CHANNEL_OMNI && channel != midiChannel) return;
+  switch (e.status & 0xF0) {
+    case 0x80:
+      replayPush(arrival, MIDI_Q_NOTE_OFF, channel, e.data1, e.data2);
+      break;
+    case 0x90:
+      replayPush(arrival, e.data2 ? MIDI_Q_NOTE_ON : MIDI_Q_NOTE_OFF, channel, e.data1, e.data2);
+      break;
+    case 0xB0:
+      replayPush(arrival, e.data1 == CCmodWheelinput ? MIDI_Q_MOD_WHEEL : MIDI_Q_CONTROL, channel, e.data1, e.data2);
+      break;
+    case 0xC0:
+      replayPush(arrival, MIDI_Q_PROGRAM, channel, e.data1, 0);
+      break;
+    case 0xD0:
+      replayPush(arrival, MIDI_Q_AFTERTOUCH, channel, e.data1, 0);
+      break;
+    case 0xE0:
+      replayPush(arrival, MIDI_Q_PITCH_BEND, channel, 0, ((e.data2 << 7) | e.data1) - 8192);
+      break;
+  }
+}
+
+//Called with the MIDI port reads, one message per call
+void midiReplayPoll() {
+  if (!replayRunning) return;
+  uint32_t now = micros();
+  //Arrivals since the last poll, into the modelled receive buffer
+  while (replayArrived < replayCount && (int32_t)(now - replayDue(replayArrived)) >= 0) {
+    uint16_t cost = replayPort == MIDI_PORT_DIN ? 1 + replayDataBytes(replayEvents[replayArrived].status) : 1;
+    uint16_t limit = replayPort == MIDI_PORT_DIN ? REPLAY_DIN_RX_BYTES : replayPort == MIDI_PORT_USB_HOST ? REPLAY_USB_HOST_RX_PACKETS : 0xFFFF;
+    if (replayBuffered + cost > limit) {
+      replayDropped[replayArrived >> 5] |= 1UL << (replayArrived & 31);
+      replayDrops++;
+    } else {
+      replayBuffered += cost;
+    }
+    replayArrived++;
+  }
+  while (replayNext < replayArrived && replayIsDropped(replayNext)) replayNext++;
+  if (replayNext < replayArrived) {
+    const ReplayEvent &e = replayEvents[replayNext];
+    replayBuffered -= replayPort == MIDI_PORT_DIN ? 1 + replayDataBytes(e.status) : 1;
+    replayDispatch(e, replayDue(replayNext));
+    replayNext++;
+  }
+  int out = replayOutIdle - Serial1.availableForWrite();
+  if (out > replayOutMax) replayOutMax = out;
+}
+
+//From midiQueueHandleNext() once a replayed message has been handled
+void midiReplayHandled(uint32_t arrival) {
+  uint32_t now = micros();
+  uint32_t lag = now - arrival;
+  replayHandled++;
+  replayLagTotal += lag;
+  if (lag > replayLagMax) replayLagMax = lag;
+  replayLastUs = now;
+}
+
+//Called every loop() pass, starts each run and reports the last one
+void midiReplayStep() {
+  if (replayDone) return;
+  if (!replayRunning) {
+    if (millis() < REPLAY_START_MS) return;
+    replayDir = SD.open("/replay");
+    if (!replayDir || !replayOpenNext()) {
+      Serial.println("midi_replay,no files in /replay");
+      replayDone = true;
+      return;
+    }
+    Serial.println("midi_replay,file,port,speedup,messages,dropped,queue_dropped,msgs_per_s,avg_lag_us,max_lag_us,max_out_lag_us");
+    replayPort = 0;
+    replaySpeedupIndex = 0;
+    replayStartRun();
+    replayRunning = true;
+    return;
+  }
+  if (replayNext < replayCount || replayArrived < replayCount || replayHandled < replayQueued) return;
+  replayReport();
+  if (++replaySpeedupIndex >= REPLAY_SPEEDUP_COUNT) {
+    replaySpeedupIndex = 0;
+    if (++replayPort >= MIDI_PORTS) {
+      replayPort = 0;
+      if (!replayOpenNext()) {
+        replayDir.close();
+        replayRunning = false;
+        replayDone = true;
+        Serial.println("midi_replay,done");
+        return;
+      }
+    }
+  }
+  replayStartRun();
+}
+
+#endif
@@ -0,0 +1,125 @@
+// MIDI routing matrix and CC echo suppression
+//
+// Each source, the three input ports and the panel, has a destination mask
+// (DIN out, USB out) per message class: notes, with pitch bend, aftertouch
+// and the mod wheel, and CCs, with program changes. CCs that midiCCOut() sends while
+// an incoming CC is handled follow the route of the port it came in on, so a
+// CC from the VST only goes back to USB when that route says so. 2 bits a
+// route, the matrix is stored in two EEPROM bytes.
+//
+// A CC arriving on DIN or USB with the value that was sent out of the same
+// port less than the echo window ago is dropped as an echo. The last value per
+// CC is kept, and the last few sends per port, so an echo that comes back
+// after a later value of a pot being swept is still caught.
+
+enum { MIDI_PORT_DIN, MIDI_PORT_USB_DEVICE, MIDI_PORT_USB_HOST, MIDI_PORTS };
+#define ROUTE_PANEL MIDI_PORTS
+#define ROUTE_SOURCES (MIDI_PORTS + 1)
+enum { ROUTE_NOTES, ROUTE_CCS, ROUTE_CLASSES };
+
+#define ROUTE_TO_DIN 1
+#define ROUTE_TO_USB 2
+#define ROUTE_NONE 0xFF  //No echo value sent yet
+
+//Uncomment to print CCs in, echoes dropped and CCs sent per port
+//#define MIDI_ROUTING_STATS
+#define MIDI_ROUTING_STATS_INTERVAL 10000
+
+static uint16_t midiRoutes = 0;
+static uint8_t midiRouteSource = ROUTE_PANEL;  //Whose CC is being handled, loop() only
+
+static const uint8_t routeEchoWindowsMs[] = { 0, 10, 30, 100 };  //Settings values "Off", "10mS", "30mS", "100mS"
+static uint8_t routeEchoWindow = 2;
+static uint8_t routeEchoValue[2][128];  //Last value sent per CC, DIN and USB out
+static uint32_t routeEchoTime[2][128];
+
+#define ROUTE_ECHO_RECENT 16  //Sends kept per port, more than a sweep has in flight to the VST and back
+
+struct RouteEchoSent {
+  uint32_t time;
+  uint8_t cc;
+  uint8_t value;
+};
+
+static RouteEchoSent routeEchoRecent[2][ROUTE_ECHO_RECENT];
+static uint8_t routeEchoRecentNext[2] = {};
+
+#ifdef MIDI_ROUTING_STATS
+static uint32_t routeCCIn[MIDI_PORTS] = {};
+static uint32_t routeEchoes[MIDI_PORTS] = {};
+static uint32_t routeCCOut[2] = {};
+static unsigned long routeStatsTimer = 0;
+#endif
+
+uint8_t midiRoute(uint8_t source, uint8_t messageClass) {
+  return (midiRoutes >> ((source * ROUTE_CLASSES + messageClass) * 2)) & 3;
+}
+
+void setMidiRoute(uint8_t source, uint8_t messageClass, uint8_t to) {
+  uint8_t shift = (source * ROUTE_CLASSES + messageClass) * 2;
+  midiRoutes = (midiRoutes & ~(3 << shift)) | ((to & 3) << shift);
+}
+
+void setupMidiRouting() {
+  //Until the matrix is first stored the old USB Notes and USB Params settings decide
+  uint16_t defaults = 0;
+  uint8_t notes = ROUTE_TO_DIN | (getSendNotes() ? ROUTE_TO_USB : 0);
+  uint8_t ccs = ROUTE_TO_DIN | (getUpdateParams() ? ROUTE_TO_USB : 0);
+  for (int source = 0; source < ROUTE_SOURCES; source++) {
+    uint8_t shift = source * ROUTE_CLASSES * 2;
+    defaults |= (notes << (shift + ROUTE_NOTES * 2)) | (ccs << (shift + ROUTE_CCS * 2));
+  }
+  midiRoutes = getMidiRoutes(defaults);
+  routeEchoWindow = getEchoWindow();
+  memset(routeEchoValue, ROUTE_NONE, sizeof(routeEchoValue));
+  memset(routeEchoRecent, ROUTE_NONE, sizeof(routeEchoRecent));
+}
+
+//midiCCOut() and the CC forwards record what went out of which port
+void midiEchoSent(uint8_t to, byte cc, byte value) {
+  uint32_t now = micros();
+  for (int out = 0; out < 2; out++) {
+    if (!(to & (1 << out))) continue;
+    routeEchoValue[out][cc] = value;
+    routeEchoTime[out][cc] = now;
+    routeEchoRecent[out][routeEchoRecentNext[out]] = { now, cc, value };
+    routeEchoRecentNext[out] = (routeEchoRecentNext[out] + 1) % ROUTE_ECHO_RECENT;
+#ifdef MIDI_ROUTING_STATS
+    routeCCOut[out]++;
+#endif
+  }
+}
+
+//An incoming CC, true when it is the echo of one just sent out of that port
+bool midiEchoDrop(uint8_t port, byte cc, byte value, uint32_t arrival) {
+#ifdef MIDI_ROUTING_STATS
+  routeCCIn[port]++;
+#endif
+  if (port > MIDI_PORT_USB_DEVICE || routeEchoWindowsMs[routeEchoWindow] == 0) return false;  //Nothing is sent to the USB host
+  uint32_t window = routeEchoWindowsMs[routeEchoWindow] * 1000UL;
+  bool echo = routeEchoValue[port][cc] == value && arrival - routeEchoTime[port][cc] <= window;
+  for (int i = 0; i < ROUTE_ECHO_RECENT && !echo; i++) {
+    const RouteEchoSent &sent = routeEchoRecent[port][i];
+    echo = sent.cc == cc && sent.value == value && arrival - sent.time <= window;
+  }
+  if (!echo) return false;
+#ifdef MIDI_ROUTING_STATS
+  routeEchoes[port]++;
+#endif
+  return true;
+}
+
+#ifdef MIDI_ROUTING_STATS
+void checkMidiRoutingStats() {
+  if (millis() - routeStatsTimer > MIDI_ROUTING_STATS_INTERVAL) {
+    routeStatsTimer = millis();
+    static const char *const names[MIDI_PORTS] = { "din", "usb device", "usb host" };
+    for (int i = 0; i < MIDI_PORTS; i++) {
+      Serial.printf("Routing %-10s CCs in %lu echoes dropped %lu (%lu%%) | sent %lu\n", names[i], routeCCIn[i], routeEchoes[i],
+                    routeCCIn[i] ? routeEchoes[i] * 100 / routeCCIn[i] : 0, i < 2 ? routeCCOut[i] : 0);
+      routeCCIn[i] = routeEchoes[i] = 0;
+    }
+    routeCCOut[0] = routeCCOut[1] = 0;
+  }
+}
+#endif
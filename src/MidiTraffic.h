@@ -0,0 +1,247 @@
+// MIDI traffic counters per port
+//
+// Always on. Every message read from the three input ports and every message
+// sent to DIN, USB and the HID keystroke port (MIDI6) is counted per message
+// type and, for CCs, per controller number. The USB host port only gets the
+// traffic replies, they are counted as "Host out". Also kept per port: bytes,
+// messages and bytes per second, CCs repeating the previous value,
+// messages coalesced or dropped on the way, and the peak burst, the most
+// messages within TRAFFIC_BURST_US.
+//
+// Fixed arrays and plain counters. Each counter is written from one context at
+// a time (the poll interrupt, or loop() under MidiOutGuard), readers may see a
+// count one message old. Clearing them masks the interrupt. Input ports count ring overflows in the interrupt and
+// echoes in loop(), so those two are kept apart.
+//
+// Reading the counters:
+// - "MIDI Traffic" in settings, messages per second per port, pressing the
+//   encoder on a port logs its counters over Serial
+// - Serial command 't' logs all ports, 'c' clears the counters
+// - SysEx F0 7D 4D 01 <port> F7 replies F0 7D 4D 02 <port> <values> F7 on the
+//   port asked, <port> 7F for one reply per port, one port per scheduler
+//   pass. On DIN the next port waits until the last reply is on the wire, so
+//   notes wait behind one reply (28mS) at most. Values are msgs, bytes,
+//   msgs/s, bytes/s, duplicates, coalesced, dropped (overflows and echoes),
+//   peak burst and the eight per type counts (note off, note on, poly
+//   aftertouch, CC, program, aftertouch, bend, sysex), each 32 bits as five
+//   7 bit bytes, low first.
+//   F0 7D 4D 03 <port> F7 replies F0 7D 4D 04 <port> <128 CC counts> F7,
+//   over USB only. At 646 bytes a reply would hold DIN out for 200mS, a CC
+//   query arriving on DIN is not answered.
+
+#define TRAFFIC_BURST_US 10000
+#define TRAFFIC_TICK_US 1000000  //Rates are messages in the last second
+#define TRAFFIC_NO_VALUE 0xFF
+#define TRAFFIC_TYPES 8  //By status nibble, 0x80 note off .. 0xF0 sysex
+#define TRAFFIC_SETTING "MIDI Traffic"
+
+#define TRAFFIC_SYSEX_ID 0x7D  //Non commercial
+#define TRAFFIC_SYSEX_SUB 0x4D
+#define TRAFFIC_QUERY 0x01
+#define TRAFFIC_REPLY 0x02
+#define TRAFFIC_QUERY_CCS 0x03
+#define TRAFFIC_REPLY_CCS 0x04
+#define TRAFFIC_ALL_PORTS 0x7F
+#define TRAFFIC_DIN_BYTE_US 320  //31250 baud
+
+//The input ports keep their MIDI_PORT_* numbers
+enum { TRAFFIC_DIN_OUT = MIDI_PORTS, TRAFFIC_USB_OUT, TRAFFIC_HID_OUT, TRAFFIC_HOST_OUT, TRAFFIC_PORTS };
+
+struct MidiTrafficPort {
+  uint32_t msgs;
+  uint32_t bytes;
+  uint32_t duplicates;
+  uint32_t coalesced;
+  uint32_t dropped;
+  uint32_t echoes;  //Dropped by the echo filter, loop() only
+  uint32_t types[TRAFFIC_TYPES];
+  uint32_t ccs[128];
+  uint8_t ccLast[128];
+  uint32_t burstStart;
+  uint16_t burstCount;
+  uint16_t burstPeak;
+  uint32_t msgsPerSecond;  //Written by midiTrafficTick() only
+  uint32_t bytesPerSecond;
+  uint32_t msgsLastTick;
+  uint32_t bytesLastTick;
+};
+
+static MidiTrafficPort midiTraffic[TRAFFIC_PORTS];
+static const char *const trafficPortNames[TRAFFIC_PORTS] = { "DIN in", "USB in", "Host in", "DIN out", "USB out", "HID keys", "Host out" };
+static const char *const trafficTypeNames[TRAFFIC_TYPES] = { "note off", "note on", "poly at", "cc", "program", "aftertouch", "bend", "sysex" };
+static char trafficPageText[TRAFFIC_PORTS][20];  //Settings values, one per port
+static uint8_t trafficReply[5 + 128 * 5 + 1];
+static uint8_t trafficReplyTo;
+static uint8_t trafficReplyCommand;
+static uint8_t trafficReplyNext = TRAFFIC_PORTS;  //TRAFFIC_PORTS when there is none to send
+static uint8_t trafficReplyLast;
+static uint32_t trafficReplyDinFree;  //micros() the last DIN reply is on the wire
+
+//The poll interrupt counts what it reads and forwards, it must not see a half cleared port
+void midiTrafficClear() {
+  __disable_irq();
+  memset(midiTraffic, 0, sizeof(midiTraffic));
+  for (int p = 0; p < TRAFFIC_PORTS; p++) memset(midiTraffic[p].ccLast, TRAFFIC_NO_VALUE, 128);
+  __enable_irq();
+}
+
+void midiTrafficCount(uint8_t port, uint8_t status, uint8_t data1, uint8_t data2, uint16_t bytes) {
+  MidiTrafficPort &t = midiTraffic[port];
+  uint32_t now = micros();
+  t.msgs++;
+  t.bytes += bytes;
+  t.types[(status >> 4) & 7]++;
+  if ((status & 0xF0) == 0xB0) {
+    t.ccs[data1 & 0x7F]++;
+    if (t.ccLast[data1 & 0x7F] == data2) t.duplicates++;
+    t.ccLast[data1 & 0x7F] = data2;
+  }
+  if (now - t.burstStart > TRAFFIC_BURST_US) {
+    t.burstStart = now;
+    t.burstCount = 0;
+  }
+  if (++t.burstCount > t.burstPeak) t.burstPeak = t.burstCount;
+}
+
+//A channel message, two bytes for program change and aftertouch
+void midiTrafficMessage(uint8_t port, uint8_t status, uint8_t data1, uint8_t data2) {
+  uint8_t type = status & 0xF0;
+  midiTrafficCount(port, status, data1, data2, type == 0xC0 || type == 0xD0 ? 2 : 3);
+}
+
+void midiTrafficCoalesced(uint8_t port) {
+  midiTraffic[port].coalesced++;
+}
+
+void midiTrafficDropped(uint8_t port) {
+  midiTraffic[port].dropped++;
+}
+
+void midiTrafficEcho(uint8_t port) {
+  midiTraffic[port].echoes++;
+}
+
+//Once a second from the scheduler
+void midiTrafficTick() {
+  for (int p = 0; p < TRAFFIC_PORTS; p++) {
+    MidiTrafficPort &t = midiTraffic[p];
+    uint32_t msgs = t.msgs, bytes = t.bytes;
+    t.msgsPerSecond = msgs - t.msgsLastTick;
+    t.bytesPerSecond = bytes - t.bytesLastTick;
+    t.msgsLastTick = msgs;
+    t.bytesLastTick = bytes;
+    snprintf(trafficPageText[p], sizeof(trafficPageText[p]), "%s %lu/s", trafficPortNames[p], (unsigned long)t.msgsPerSecond);
+  }
+}
+
+void midiTrafficPrint(uint8_t port) {
+  const MidiTrafficPort &t = midiTraffic[port];
+  Serial.printf("%-8s %lu msgs %lu bytes | %lu/s %lu B/s | dup %lu coalesced %lu dropped %lu echoes %lu | peak burst %u\n",
+                trafficPortNames[port], t.msgs, t.bytes, t.msgsPerSecond, t.bytesPerSecond,
+                t.duplicates, t.coalesced, t.dropped, t.echoes, t.burstPeak);
+  Serial.print("        ");
+  for (int i = 0; i < TRAFFIC_TYPES; i++) {
+    if (t.types[i]) Serial.printf(" %s %lu", trafficTypeNames[i], t.types[i]);
+  }
+  Serial.println();
+  if (t.types[3]) {
+    Serial.print("         cc:");
+    for (int cc = 0; cc < 128; cc++) {
+      if (t.ccs[cc]) Serial.printf(" %d=%lu", cc, t.ccs[cc]);
+    }
+    Serial.println();
+  }
+}
+
+void midiTrafficPrintAll() {
+  Serial.printf("MIDI traffic, peak burst within %u uS\n", TRAFFIC_BURST_US);
+  for (int p = 0; p < TRAFFIC_PORTS; p++) midiTrafficPrint(p);
+}
+
+//Serial commands, called from loop()
+void midiTrafficCommand(int c) {
+  if (c == 't') midiTrafficPrintAll();
+  if (c == 'c') midiTrafficClear();
+}
+
+//Settings page, the encoder press on a port logs it
+void settingsTraffic(int index, const char *value) {
+  midiTrafficPrint(index);
+}
+
+int currentIndexTraffic() {
+  return 0;
+}
+
+//A query for the poll interrupt to queue, F0 and F7 included
+bool midiTrafficIsQuery(const uint8_t *data, unsigned length) {
+  return length == 6 && data[1] == TRAFFIC_SYSEX_ID && data[2] == TRAFFIC_SYSEX_SUB
+         && (data[3] == TRAFFIC_QUERY || data[3] == TRAFFIC_QUERY_CCS)
+         && (data[4] < TRAFFIC_PORTS || data[4] == TRAFFIC_ALL_PORTS);
+}
+
+static uint16_t trafficPut(uint16_t at, uint32_t value) {
+  for (int i = 0; i < 5; i++, value >>= 7) trafficReply[at++] = value & 0x7F;
+  return at;
+}
+
+static void trafficSendSysEx(uint8_t to, uint16_t length) {
+  switch (to) {
+    case MIDI_PORT_DIN:
+      MIDI.sendSysEx(length, trafficReply, true);
+      midiTrafficCount(TRAFFIC_DIN_OUT, 0xF0, 0, 0, length);
+      break;
+    case MIDI_PORT_USB_DEVICE:
+      usbMIDI.sendSysEx(length, trafficReply, true);
+      usbMIDI.send_now();
+      midiTrafficCount(TRAFFIC_USB_OUT, 0xF0, 0, 0, length);
+      break;
+    case MIDI_PORT_USB_HOST:
+      midi1.sendSysEx(length, trafficReply, true);
+      midiTrafficCount(TRAFFIC_HOST_OUT, 0xF0, 0, 0, length);
+      break;
+  }
+}
+
+static uint16_t trafficReplyPort(uint8_t to, uint8_t command, uint8_t port) {
+  const MidiTrafficPort &t = midiTraffic[port];
+  uint16_t at = 0;
+  trafficReply[at++] = 0xF0;
+  trafficReply[at++] = TRAFFIC_SYSEX_ID;
+  trafficReply[at++] = TRAFFIC_SYSEX_SUB;
+  trafficReply[at++] = command == TRAFFIC_QUERY ? TRAFFIC_REPLY : TRAFFIC_REPLY_CCS;
+  trafficReply[at++] = port;
+  if (command == TRAFFIC_QUERY) {
+    const uint32_t values[] = { t.msgs, t.bytes, t.msgsPerSecond, t.bytesPerSecond, t.duplicates, t.coalesced, t.dropped + t.echoes, t.burstPeak };
+    for (uint32_t v : values) at = trafficPut(at, v);
+    for (int i = 0; i < TRAFFIC_TYPES; i++) at = trafficPut(at, t.types[i]);
+  } else {
+    for (int cc = 0; cc < 128; cc++) at = trafficPut(at, t.ccs[cc]);
+  }
+  trafficReply[at++] = 0xF7;
+  trafficSendSysEx(to, at);
+  return at;
+}
+
+//From the queue in loop(), the reply goes back to the port that asked. A new query replaces one still being sent.
+void midiTrafficReply(uint8_t to, uint8_t command, uint8_t port) {
+  if (to == MIDI_PORT_DIN && command == TRAFFIC_QUERY_CCS) return;
+  trafficReplyTo = to;
+  trafficReplyCommand = command;
+  trafficReplyNext = port == TRAFFIC_ALL_PORTS ? 0 : port;
+  trafficReplyLast = port == TRAFFIC_ALL_PORTS ? TRAFFIC_PORTS - 1 : port;
+}
+
+//A port's reply can go now, on DIN once the last one has left
+bool midiTrafficReplyDue() {
+  if (trafficReplyNext >= TRAFFIC_PORTS) return false;
+  return trafficReplyTo != MIDI_PORT_DIN || (int32_t)(micros() - trafficReplyDinFree) >= 0;
+}
+
+//One port's reply per call, the caller holds MidiOutGuard
+void midiTrafficReplyStep() {
+  uint32_t start = micros();
+  uint16_t length = trafficReplyPort(trafficReplyTo, trafficReplyCommand, trafficReplyNext);
+  trafficReplyDinFree = start + length * TRAFFIC_DIN_BYTE_US;
+  trafficReplyNext = trafficReplyNext == trafficReplyLast ? TRAFFIC_PORTS : trafficReplyNext + 1;
+}
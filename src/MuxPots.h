@@ -0,0 +1,199 @@
+// Pot reads from the three 4067 muxes
+//
+// checkMux() reads the three pots on the selected mux address, one per mux,
+// and hands each that moved more than QUANTISE_FACTOR to the pot thinning as
+// a CC. It then selects the next address in the order MuxScan.h picks. The
+// pots task runs it together with flushPotThinning().
+
+void checkMux() {
+  PROFILE_SCOPE(PROF_MUX);
+
+  mux1Read = adc->adc1->analogRead(MUX1_S);
+  mux2Read = adc->adc1->analogRead(MUX2_S);
+  mux3Read = adc->adc1->analogRead(MUX3_S);
+#ifdef LATENCY_BENCH
+  latencyBenchReads(muxInput, mux1Read, mux2Read, mux3Read);
+#endif
+  muxRecordRead(muxInput);
+
+  if (mux1Read > (mux1ValuesPrev[muxInput] + QUANTISE_FACTOR) || mux1Read < (mux1ValuesPrev[muxInput] - QUANTISE_FACTOR)) {
+    mux1ValuesPrev[muxInput] = mux1Read;
+    muxMarkActive(muxInput);
+    mux1Read = (mux1Read >> resolutionFrig);  // Change range to 0-127
+
+    switch (muxInput) {
+      case MUX1_GLIDE:
+        potControlChange(CCglide, mux1Read);
+        break;
+      case MUX1_UNISON_DETUNE:
+        potControlChange(CCuniDetune, mux1Read);
+        break;
+      case MUX1_BEND_DEPTH:
+        potControlChange(CCbendDepth, mux1Read);
+        break;
+      case MUX1_LFO_OSC3:
+        potControlChange(CClfoOsc3, mux1Read);
+        break;
+      case MUX1_LFO_FILTER_CONTOUR:
+        potControlChange(CClfoFilterContour, mux1Read);
+        break;
+      case MUX1_ARP_RATE:
+        potControlChange(CCarpSpeed, mux1Read);
+        break;
+      case MUX1_PHASER_RATE:
+        potControlChange(CCphaserSpeed, mux1Read);
+        break;
+      case MUX1_PHASER_DEPTH:
+        potControlChange(CCphaserDepth, mux1Read);
+        break;
+      case MUX1_LFO_INITIAL_AMOUNT:
+        potControlChange(CClfoInitialAmount, mux1Read);
+        break;
+      case MUX1_LFO_MOD_WHEEL_AMOUNT:
+        potControlChange(CCmodWheel, mux1Read);
+        break;
+      case MUX1_LFO_RATE:
+        potControlChange(CClfoSpeed, mux1Read);
+        break;
+      case MUX1_OSC2_FREQUENCY:
+        potControlChange(CCosc2Frequency, mux1Read);
+        break;
+      case MUX1_OSC2_PW:
+        potControlChange(CCosc2PW, mux1Read);
+        break;
+      case MUX1_OSC1_PW:
+        potControlChange(CCosc1PW, mux1Read);
+        break;
+      case MUX1_OSC3_FREQUENCY:
+        potControlChange(CCosc3Frequency, mux1Read);
+        break;
+      case MUX1_OSC3_PW:
+        potControlChange(CCosc3PW, mux1Read);
+        break;
+    }
+  }
+
+  if (mux2Read > (mux2ValuesPrev[muxInput] + QUANTISE_FACTOR) || mux2Read < (mux2ValuesPrev[muxInput] - QUANTISE_FACTOR)) {
+    mux2ValuesPrev[muxInput] = mux2Read;
+    muxMarkActive(muxInput);
+    mux2Read = (mux2Read >> resolutionFrig);  // Change range to 0-127
+
+    switch (muxInput) {
+      case MUX2_ENSEMBLE_RATE:
+        potControlChange(CCensembleRate, mux2Read);
+        break;
+      case MUX2_ENSEMBLE_DEPTH:
+        potControlChange(CCensembleDepth, mux2Read);
+        break;
+      case MUX2_ECHO_TIME:
+        potControlChange(CCechoTime, mux2Read);
+        break;
+      case MUX2_ECHO_FEEDBACK:
+        potControlChange(CCechoRegen, mux2Read);
+        break;
+      case MUX2_ECHO_DAMP:
+        potControlChange(CCechoDamp, mux2Read);
+        break;
+      case MUX2_ECHO_SPREAD:
+        potControlChange(CCechoSpread, mux2Read);
+        break;
+      case MUX2_ECHO_MIX:
+        potControlChange(CCechoLevel, mux2Read);
+        break;
+      case MUX2_NOISE:
+        potControlChange(CCnoise, mux2Read);
+        break;
+      case MUX2_OSC3_LEVEL:
+        potControlChange(CCosc3Level, mux2Read);
+        break;
+      case MUX2_OSC2_LEVEL:
+        potControlChange(CCosc2Level, mux2Read);
+        break;
+      case MUX2_OSC1_LEVEL:
+        potControlChange(CCosc1Level, mux2Read);
+        break;
+      case MUX2_CUTOFF:
+        potControlChange(CCfilterCutoff, mux2Read);
+        break;
+      case MUX2_EMPHASIS:
+        potControlChange(CCemphasis, mux2Read);
+        break;
+      case MUX2_VCF_DECAY:
+        potControlChange(CCvcfDecay, mux2Read);
+        break;
+      case MUX2_VCF_ATTACK:
+        potControlChange(CCvcfAttack, mux2Read);
+        break;
+      case MUX2_VCA_ATTACK:
+        potControlChange(CCvcaAttack, mux2Read);
+        break;
+    }
+  }
+
+  if (mux3Read > (mux3ValuesPrev[muxInput] + QUANTISE_FACTOR) || mux3Read < (mux3ValuesPrev[muxInput] - QUANTISE_FACTOR)) {
+    mux3ValuesPrev[muxInput] = mux3Read;
+    muxMarkActive(muxInput);
+    mux3Read = (mux3Read >> resolutionFrig);  // Change range to 0-127
+
+    switch (muxInput) {
+      case MUX3_REVERB_MIX:
+        potControlChange(CCreverbLevel, mux3Read);
+        break;
+      case MUX3_REVERB_DAMP:
+        potControlChange(CCreverbDamp, mux3Read);
+        break;
+      case MUX3_REVERB_DECAY:
+        potControlChange(CCreverbDecay, mux3Read);
+        break;
+      case MUX3_DRIFT:
+        potControlChange(CCdriftAmount, mux3Read);
+        break;
+      case MUX3_VCA_VELOCITY:
+        potControlChange(CCvcaVelocity, mux3Read);
+        break;
+      case MUX3_VCA_RELEASE:
+        potControlChange(CCvcaRelease, mux3Read);
+        break;
+      case MUX3_VCA_SUSTAIN:
+        potControlChange(CCvcaSustain, mux3Read);
+        break;
+      case MUX3_VCA_DECAY:
+        potControlChange(CCvcaDecay, mux3Read);
+        break;
+      case MUX3_VCF_SUSTAIN:
+        potControlChange(CCvcfSustain, mux3Read);
+        break;
+      case MUX3_CONTOUR_AMOUNT:
+        potControlChange(CCvcfContourAmount, mux3Read);
+        break;
+      case MUX3_VCF_RELEASE:
+        potControlChange(CCvcfRelease, mux3Read);
+        break;
+      case MUX3_KB_TRACK:
+        potControlChange(CCkbTrack, mux3Read);
+        break;
+      case MUX3_MASTER_VOLUME:
+        potControlChange(CCmasterVolume, mux3Read);
+        break;
+      case MUX3_VCF_VELOCITY:
+        potControlChange(CCvcfVelocity, mux3Read);
+        break;
+      case MUX3_MASTER_TUNE:
+        potControlChange(CCmasterTune, mux3Read);
+        break;
+    }
+  }
+
+  muxInput = muxNextInput();
+
+  digitalWriteFast(MUX_0, muxInput & B0001);
+  digitalWriteFast(MUX_1, muxInput & B0010);
+  digitalWriteFast(MUX_2, muxInput & B0100);
+  digitalWriteFast(MUX_3, muxInput & B1000);
+  delayMicroseconds(75);
+}
+
+void potsTask() {
+  checkMux();          // Read the sliders and switches
+  flushPotThinning();  // send the final value of pots that have stopped moving
+}
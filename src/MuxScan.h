@@ -0,0 +1,127 @@
+// Activity weighted mux scan order
+//
+// checkMux() reads one mux address (three pots, one per mux) per loop pass.
+// A plain 0..15 round robin means the pot being turned is only read once every
+// 16 passes. Here every other pass is given to the most recently moved address
+// while it is still "hot", the other passes keep walking the round robin.
+// The number of ADC reads per pass is unchanged and an idle address is never
+// more than 2 * MUXCHANNELS passes stale.
+
+#define MUX_ACTIVE_WINDOW 300  //ms an address stays hot after its last change
+#define MUX_HOT_SLOTS 2        //Two hands, two knobs
+#define MUX_NONE 0xFF
+
+//Uncomment to collect per address sample counts and read interval histograms
+//#define MUX_SCAN_STATS
+#define MUX_STATS_BUCKETS 16  //log2 buckets of the read interval in uS
+#define MUX_STATS_INTERVAL 10000
+
+static byte muxHot[MUX_HOT_SLOTS] = { MUX_NONE, MUX_NONE };
+static unsigned long muxHotTime[MUX_HOT_SLOTS] = {};
+static byte muxRoundRobin = 0;
+static byte muxSlot = 0;
+static bool muxScanBoost = true;  //Cleared for a plain round robin, to compare
+
+#ifdef MUX_SCAN_STATS
+static unsigned long muxSamples[MUXCHANNELS] = {};
+static unsigned long muxLastRead[MUXCHANNELS] = {};
+static unsigned long muxIntervalHist[MUXCHANNELS][MUX_STATS_BUCKETS] = {};
+static unsigned long muxStatsTimer = 0;
+static unsigned long muxStatsStart = 0;
+#endif
+
+void muxScanReset() {
+  for (int i = 0; i < MUX_HOT_SLOTS; i++) {
+    muxHot[i] = MUX_NONE;
+    muxHotTime[i] = 0;
+  }
+  muxRoundRobin = 0;
+  muxSlot = 0;
+}
+
+//Called by checkMux() when any of the three pots on this address moved
+void muxMarkActive(byte input) {
+  unsigned long now = millis();
+  for (int i = 0; i < MUX_HOT_SLOTS; i++) {
+    if (muxHot[i] == input) {
+      muxHotTime[i] = now;
+      return;
+    }
+  }
+  int oldest = 0;  //A free slot, else the one moved longest ago
+  for (int i = 0; i < MUX_HOT_SLOTS; i++) {
+    if (muxHot[i] == MUX_NONE) {
+      oldest = i;
+      break;
+    }
+    if (muxHotTime[i] < muxHotTime[oldest]) oldest = i;
+  }
+  muxHot[oldest] = input;
+  muxHotTime[oldest] = now;
+}
+
+//Called by checkMux() for every read, only does anything with MUX_SCAN_STATS
+void muxRecordRead(byte input) {
+#ifdef MUX_SCAN_STATS
+  unsigned long now = micros();
+  if (muxSamples[input] > 0) {
+    unsigned long interval = now - muxLastRead[input];
+    byte bucket = 0;
+    while (interval > 1 && bucket < MUX_STATS_BUCKETS - 1) {
+      interval >>= 1;
+      bucket++;
+    }
+    muxIntervalHist[input][bucket]++;
+  }
+  muxLastRead[input] = now;
+  muxSamples[input]++;
+#endif
+}
+
+//Next address to select, hot addresses get the odd slots
+byte muxNextInput() {
+  muxSlot++;
+  if (muxScanBoost && (muxSlot & 1)) {
+    unsigned long now = millis();
+    for (int n = 0; n < MUX_HOT_SLOTS; n++) {
+      byte i = ((muxSlot >> 1) + n) % MUX_HOT_SLOTS;  //Share the boost between hot addresses
+      if (muxHot[i] != MUX_NONE) {
+        if (now - muxHotTime[i] < MUX_ACTIVE_WINDOW) return muxHot[i];
+        muxHot[i] = MUX_NONE;  //Gone cold
+      }
+    }
+  }
+  muxRoundRobin++;
+  if (muxRoundRobin >= MUXCHANNELS) {
+    muxRoundRobin = 0;
+  }
+  return muxRoundRobin;
+}
+
+#ifdef MUX_SCAN_STATS
+void muxScanStatsReset() {
+  memset(muxSamples, 0, sizeof(muxSamples));
+  memset(muxIntervalHist, 0, sizeof(muxIntervalHist));
+  muxStatsStart = millis();
+}
+
+void printMuxScanStats() {
+  unsigned long elapsed = millis() - muxStatsStart;
+  if (elapsed == 0) return;
+  Serial.println("Mux scan: addr reads/s | read interval histogram (2^n uS)");
+  for (int i = 0; i < MUXCHANNELS; i++) {
+    Serial.printf("%2d %6lu |", i, (muxSamples[i] * 1000UL) / elapsed);
+    for (int b = 0; b < MUX_STATS_BUCKETS; b++) {
+      Serial.printf(" %lu", muxIntervalHist[i][b]);
+    }
+    Serial.println();
+  }
+}
+
+void checkMuxScanStats() {
+  if (millis() - muxStatsTimer > MUX_STATS_INTERVAL) {
+    muxStatsTimer = millis();
+    printMuxScanStats();
+  }
+}
+#endif
@@ -0,0 +1,210 @@
+// Front panel buttons on the 74HC165 chain
+//
+// PanelIO reads the ten shift registers as one 80 bit frame. After debouncing,
+// the frame is XORed with the previous one and only the changed bits are
+// visited (count trailing zeros), each one dispatched through a table
+// indexed by button number. The cost per scan is fixed plus the number of
+// buttons that actually changed, the table replaces a chain of 80 tests.
+//
+// Events follow the old RoxOctoswitch ones, PRESSED, RELEASED and HELD. Menu
+// buttons act on release and on hold, and a release after a hold is ignored.
+
+#define BUTTON_TOTAL 80
+#define BUTTON_WORDS PANEL_IO_WORDS
+#define BUTTON_PRESSED 0
+#define BUTTON_RELEASED 1
+#define BUTTON_HELD 2
+
+void myControlChange(byte channel, byte control, int value);
+
+enum ButtonKind : uint8_t {
+  BUTTON_NONE,
+  BUTTON_TOGGLES,  //Press flips the value
+  BUTTON_SELECTS,  //Press sets the value, the update clears the others in its group
+  BUTTON_MENUS     //Release steps the menu, hold confirms
+};
+
+struct ButtonAction {
+  ButtonKind kind;
+  uint8_t cc;
+  uint8_t exitCC;
+  int *value;
+  int *exitValue;
+};
+
+#define BUTTON_UNUSED { BUTTON_NONE, 0, 0, nullptr, nullptr }
+#define BUTTON_TOGGLE(v, cc) { BUTTON_TOGGLES, cc, 0, &v, nullptr }
+#define BUTTON_SELECT(v, cc) { BUTTON_SELECTS, cc, 0, &v, nullptr }
+#define BUTTON_MENU(v, cc, exitV, exitCC) { BUTTON_MENUS, cc, exitCC, &v, &exitV }
+
+constexpr ButtonAction buttonActions[BUTTON_TOTAL] = {
+  BUTTON_UNUSED,                                                 // SPARE_0_SW
+  BUTTON_TOGGLE(lfoInvert, CClfoInvert),                         // LFO_INVERT_SW
+  BUTTON_TOGGLE(contourOsc3Amt, CCcontourOsc3Amt),               // CONT_OSC3_AMOUNT_SW
+  BUTTON_TOGGLE(voiceModDestVCA, CCvoiceModDestVCA),             // VOICE_MOD_DEST_VCA_SW
+  BUTTON_MENU(arpModeSW, CCarpModeSW, arpModeExitSW, CCarpModeExitSW), // ARP_MODE_SW
+  BUTTON_MENU(arpRangeSW, CCarpRangeSW, arpRangeExitSW, CCarpRangeExitSW), // ARP_RANGE_SW
+  BUTTON_TOGGLE(phaserSW, CCphaserSW),                           // PHASER_SW
+  BUTTON_TOGGLE(voiceModToFilter, CCvoiceModToFilter),           // VOICE_MOD_DEST_FILTER_SW
+  BUTTON_TOGGLE(voiceModToPW2, CCvoiceModToPW2),                 // VOICE_MOD_DEST_PW2_SW
+  BUTTON_TOGGLE(voiceModToPW1, CCvoiceModToPW1),                 // VOICE_MOD_DEST_PW1_SW
+  BUTTON_TOGGLE(voiceModToOsc2, CCvoiceModToOsc2),               // VOICE_MOD_DEST_OSC2_SW
+  BUTTON_TOGGLE(voiceModToOsc1, CCvoiceModToOsc1),               // VOICE_MOD_DEST_OSC1_SW
+  BUTTON_TOGGLE(arpOnSW, CCarpOnSW),                             // ARP_ON_OFF_SW
+  BUTTON_TOGGLE(arpHold, CCarpHold),                             // ARP_HOLD_SW
+  BUTTON_TOGGLE(arpSync, CCarpSync),                             // ARP_SYNC_SW
+  BUTTON_TOGGLE(multTrig, CCmultTrig),                           // MULT_TRIG_SW
+  BUTTON_MENU(monoSW, CCmonoSW, monoExitSW, CCmonoExitSW),       // MONO_SW
+  BUTTON_MENU(polySW, CCpolySW, polyExitSW, CCpolyExitSW),       // POLY_SW
+  BUTTON_TOGGLE(glideSW, CCglideSW),                             // GLIDE_SW
+  BUTTON_MENU(maxVoicesSW, CCnumberOfVoices, maxVoicesExitSW, CCmaxVoicesExitSW), // NUM_OF_VOICES_SW
+  BUTTON_SELECT(octaveDown, CCoctaveDown),                       // OCTAVE_MINUS_SW
+  BUTTON_SELECT(octaveNormal, CCoctaveNormal),                   // OCTAVE_ZERO_SW
+  BUTTON_SELECT(octaveUp, CCoctaveUp),                           // OCTAVE_PLUS_SW
+  BUTTON_TOGGLE(chordMode, CCchordMode),                         // CHORD_MODE_SW
+  BUTTON_SELECT(lfoSaw, CClfoSaw),                               // LFO_SAW_SW
+  BUTTON_SELECT(lfoTriangle, CClfoTriangle),                     // LFO_TRIANGLE_SW
+  BUTTON_TOGGLE(lfoSyncSW, CClfoSyncSW),                         // LFO_SYNC_SW
+  BUTTON_TOGGLE(lfoKeybReset, CClfoKeybReset),                   // LFO_KEYB_RESET_SW
+  BUTTON_TOGGLE(wheelDC, CCwheelDC),                             // DC_SW
+  BUTTON_TOGGLE(lfoDestOsc1, CClfoDestOsc1),                     // LFO_DEST_OSC1_SW
+  BUTTON_TOGGLE(lfoDestOsc2, CClfoDestOsc2),                     // LFO_DEST_OSC2_SW
+  BUTTON_TOGGLE(lfoDestOsc3, CClfoDestOsc3),                     // LFO_DEST_OSC3_SW
+  BUTTON_TOGGLE(lfoDestVCA, CClfoDestVCA),                       // LFO_DEST_VCA_SW
+  BUTTON_SELECT(lfoSampleHold, CClfoSampleHold),                 // LFO_SAMPLE_HOLD_SW
+  BUTTON_SELECT(lfoSquare, CClfoSquare),                         // LFO_SQUARE_SW
+  BUTTON_SELECT(lfoRamp, CClfoRamp),                             // LFO_RAMP_SW
+  BUTTON_TOGGLE(lfoDestPW1, CClfoDestPW1),                       // LFO_DEST_PW1_SW
+  BUTTON_TOGGLE(lfoDestPW2, CClfoDestPW2),                       // LFO_DEST_PW2_SW
+  BUTTON_TOGGLE(lfoDestPW3, CClfoDestPW3),                       // LFO_DEST_PW3_SW
+  BUTTON_TOGGLE(lfoDestFilter, CClfoDestFilter),                 // LFO_DEST_FILTER_SW
+  BUTTON_SELECT(osc1_2, CCosc1_2),                               // OSC1_2_SW
+  BUTTON_SELECT(osc1_4, CCosc1_4),                               // OSC1_4_SW
+  BUTTON_SELECT(osc1_8, CCosc1_8),                               // OSC1_8_SW
+  BUTTON_SELECT(osc1_16, CCosc1_16),                             // OSC1_16_SW
+  BUTTON_SELECT(osc2_16, CCosc2_16),                             // OSC2_16_SW
+  BUTTON_SELECT(osc2_8, CCosc2_8),                               // OSC2_8_SW
+  BUTTON_SELECT(osc2_4, CCosc2_4),                               // OSC2_4_SW
+  BUTTON_SELECT(osc2_2, CCosc2_2),                               // OSC2_2_SW
+  BUTTON_TOGGLE(osc2Saw, CCosc2Saw),                             // OSC2_SAW_SW
+  BUTTON_TOGGLE(osc1Saw, CCosc1Saw),                             // OSC1_SAW_SW
+  BUTTON_TOGGLE(osc2Square, CCosc2Square),                       // OSC2_SQUARE_SW
+  BUTTON_TOGGLE(osc1Square, CCosc1Square),                       // OSC1_SQUARE_SW
+  BUTTON_TOGGLE(osc3Square, CCosc3Square),                       // OSC3_SQUARE_SW
+  BUTTON_TOGGLE(osc3Saw, CCosc3Saw),                             // OSC3_SAW_SW
+  BUTTON_TOGGLE(osc1Triangle, CCosc1Triangle),                   // OSC1_TRIANGLE_SW
+  BUTTON_TOGGLE(osc2Triangle, CCosc2Triangle),                   // OSC2_TRIANGLE_SW
+  BUTTON_TOGGLE(osc3Triangle, CCosc3Triangle),                   // OSC3_TRIANGLE_SW
+  BUTTON_TOGGLE(slopeSW, CCslopeSW),                             // SLOPE_SW
+  BUTTON_UNUSED,                                                 // SPARE_58_SW
+  BUTTON_UNUSED,                                                 // SPARE_59_SW
+  BUTTON_TOGGLE(echoSW, CCechoSW),                               // ECHO_ON_OFF_SW
+  BUTTON_TOGGLE(echoSyncSW, CCechoSyncSW),                       // ECHO_SYNC_SW
+  BUTTON_UNUSED,                                                 // SPARE_62_SW
+  BUTTON_UNUSED,                                                 // SPARE_63_SW
+  BUTTON_TOGGLE(releaseSW, CCreleaseSW),                         // RELEASE_SW
+  BUTTON_TOGGLE(keyboardFollowSW, CCkeyboardFollowSW),           // KEYBOARD_FOLLOW_SW
+  BUTTON_TOGGLE(unconditionalContourSW, CCunconditionalContourSW), // UNCONDITIONAL_CONTOUR_SW
+  BUTTON_TOGGLE(returnSW, CCreturnSW),                           // RETURN_TO_ZERO_SW
+  BUTTON_TOGGLE(reverbSW, CCreverbSW),                           // REVERB_ON_OFF_SW
+  BUTTON_MENU(reverbTypeSW, CCreverbTypeSW, reverbTypeExitSW, CCreverbTypeExitSW), // REVERB_TYPE_SW
+  BUTTON_TOGGLE(limitSW, CClimitSW),                             // LIMIT_SW
+  BUTTON_TOGGLE(modernSW, CCmodernSW),                           // MODERN_SW
+  BUTTON_SELECT(osc3_2, CCosc3_2),                               // OSC3_2_SW
+  BUTTON_SELECT(osc3_4, CCosc3_4),                               // OSC3_4_SW
+  BUTTON_SELECT(osc3_8, CCosc3_8),                               // OSC3_8_SW
+  BUTTON_SELECT(osc3_16, CCosc3_16),                             // OSC3_16_SW
+  BUTTON_TOGGLE(ensembleSW, CCensembleSW),                       // ENSEMBLE_SW
+  BUTTON_TOGGLE(lowSW, CClowSW),                                 // LOW_SW
+  BUTTON_TOGGLE(keyboardControlSW, CCkeyboardControlSW),         // KEYBOARD_CONTROL_SW
+  BUTTON_TOGGLE(oscSyncSW, CCoscSyncSW)                          // OSC_SYNC_SW
+};
+
+static ButtonFrame buttonRaw = {};
+static ButtonFrame buttonStable = {};
+static ButtonFrame buttonMenuMask = {};  //Buttons that report HELD
+static ButtonFrame buttonHoldPending = {};
+static unsigned long buttonRawTime = 0;
+static unsigned long buttonPressTime[BUTTON_TOTAL] = {};
+static uint16_t buttonDebounce = 50;
+
+void dispatchButton(uint8_t index, uint8_t type) {
+  const ButtonAction &action = buttonActions[index];
+  switch (action.kind) {
+    case BUTTON_TOGGLES:
+      if (type != BUTTON_PRESSED) return;
+      *action.value = !*action.value;
+      myControlChange(midiChannel, action.cc, *action.value);
+      break;
+    case BUTTON_SELECTS:
+      if (type != BUTTON_PRESSED) return;
+      *action.value = 1;
+      myControlChange(midiChannel, action.cc, *action.value);
+      break;
+    case BUTTON_MENUS:
+      if (type == BUTTON_RELEASED) {
+        *action.value = 1;
+        myControlChange(midiChannel, action.cc, *action.value);
+      } else if (type == BUTTON_HELD) {
+        *action.exitValue = 1;
+        myControlChange(midiChannel, action.exitCC, *action.exitValue);
+      }
+      break;
+    case BUTTON_NONE:
+      break;
+  }
+}
+
+void setupButtons(uint16_t debounce) {
+  buttonDebounce = debounce;
+  for (int i = 0; i < BUTTON_TOTAL; i++) {
+    if (buttonActions[i].kind == BUTTON_MENUS) {
+      buttonMenuMask.bits[i >> 5] |= 1UL << (i & 31);
+    }
+  }
+}
+
+//Debounce the frame and dispatch the buttons that changed, called every loop pass
+void processButtonFrame(const ButtonFrame &raw) {
+  unsigned long now = millis();
+  if (raw != buttonRaw) {
+    buttonRaw = raw;
+    buttonRawTime = now;
+  } else if (raw != buttonStable && now - buttonRawTime >= buttonDebounce) {
+    for (int w = 0; w < BUTTON_WORDS; w++) {
+      uint32_t changed = raw.bits[w] ^ buttonStable.bits[w];
+      while (changed) {
+        uint8_t bit = __builtin_ctz(changed);
+        uint32_t mask = 1UL << bit;
+        uint8_t index = (w << 5) + bit;
+        changed &= changed - 1;
+        if (raw.bits[w] & mask) {
+          buttonPressTime[index] = now;
+          buttonHoldPending.bits[w] |= mask & buttonMenuMask.bits[w];
+          dispatchButton(index, BUTTON_PRESSED);
+        } else {
+          //A menu button that has reported HELD ignores its release
+          if (!(buttonMenuMask.bits[w] & mask) || (buttonHoldPending.bits[w] & mask)) {
+            dispatchButton(index, BUTTON_RELEASED);
+          }
+          buttonHoldPending.bits[w] &= ~mask;
+        }
+      }
+    }
+    buttonStable = raw;
+  }
+
+  //Only menu buttons that are down and not yet held are looked at
+  for (int w = 0; w < BUTTON_WORDS; w++) {
+    uint32_t pending = buttonHoldPending.bits[w];
+    while (pending) {
+      uint8_t bit = __builtin_ctz(pending);
+      uint8_t index = (w << 5) + bit;
+      pending &= pending - 1;
+      if (now - buttonPressTime[index] >= HOLD_DURATION) {
+        buttonHoldPending.bits[w] &= ~(1UL << bit);
+        dispatchButton(index, BUTTON_HELD);
+      }
+    }
+  }
+}
@@ -0,0 +1,309 @@
+// Front panel shift register driver
+//
+// The 74HC595 LED chain and the 74HC165 button chain are refreshed from an
+// IntervalTimer instead of being bit banged from loop(). Both frames are
+// buffered:
+//  - writePin()/readPin() work on a back LED state, update() compiles it and
+//    the timer picks up the new frame at the start of its next frame. There
+//    are three LED frames, the one being shown, the latest published and one
+//    to compile into, so update() always publishes.
+//  - The timer fills the spare button frame and then flips the index, so
+//    buttonFrame() always returns a complete scan.
+//
+// LED brightness is bit angle modulation. Each LED level (0-15) is split into
+// four bit planes and plane n is latched for 2^n timer ticks, so a frame is
+// four interrupts whatever the LEDs are doing. Blinking is a mask per blink
+// pattern applied once per frame, nothing is polled from loop().
+//
+// The chains are on plain GPIO pins (21-23, 33-35), not on a SPI port, so the
+// timer bit bangs them. Clocking them over SPI with DMA needs the panel rewired.
+
+#define PANEL_IO_BYTES 10
+#define PANEL_IO_BITS (PANEL_IO_BYTES * 8)
+#define PANEL_IO_WORDS 3            //80 bits in 32 bit words
+#define PANEL_BUTTONS_ACTIVE_LOW 1  //Buttons pull the 74HC165 inputs to ground
+
+#define PANEL_BAM_PLANES 4
+#define PANEL_BAM_TICK 64    //uS plane 0 is shown for, a frame is 15 ticks (~1kHz)
+#define LED_LEVEL_FULL 15
+#define PANEL_BLINK_STEP 32  //Frames per blink pattern step (~30mS)
+
+//Uncomment to report the time spent in the refresh interrupt
+//#define PANEL_IO_STATS
+#define PANEL_IO_STATS_INTERVAL 10000
+
+//Blink patterns, one bit per step, 32 steps is about a second
+enum LedBlink : uint8_t {
+  LED_STEADY,
+  LED_BLINK,       //250mS on, 250mS off
+  LED_BLINK_FAST,  //Waiting on a HID sequence
+  LED_BLINK_PATTERNS
+};
+
+constexpr uint32_t ledBlinkPatterns[LED_BLINK_PATTERNS] = {
+  0xFFFFFFFF,
+  0xFF00FF00,
+  0xF0F0F0F0
+};
+
+struct ButtonFrame {
+  uint32_t bits[PANEL_IO_WORDS];
+
+  bool operator==(const ButtonFrame &f) const {
+    return bits[0] == f.bits[0] && bits[1] == f.bits[1] && bits[2] == f.bits[2];
+  }
+  bool operator!=(const ButtonFrame &f) const {
+    return !(*this == f);
+  }
+};
+
+//What the timer clocks out, built by update()
+struct LedPlanes {
+  uint8_t plane[PANEL_BAM_PLANES][PANEL_IO_BYTES];
+  uint8_t blink[LED_BLINK_PATTERNS][PANEL_IO_BYTES];  //LEDs using each pattern
+};
+
+class PanelIO {
+public:
+  void begin(uint8_t ledData, uint8_t ledLatch, uint8_t ledClk, int8_t ledPwm) {
+    _ledData = ledData;
+    _ledLatch = ledLatch;
+    _ledClk = ledClk;
+    pinMode(_ledData, OUTPUT);
+    pinMode(_ledLatch, OUTPUT);
+    pinMode(_ledClk, OUTPUT);
+    if (ledPwm >= 0) {
+      pinMode(ledPwm, OUTPUT);
+      digitalWrite(ledPwm, LOW);  //Outputs enabled
+    }
+    memset(_ledOn, 0, sizeof(_ledOn));
+    memset(_ledLevel, LED_LEVEL_FULL, sizeof(_ledLevel));
+    memset(_ledBlink, LED_STEADY, sizeof(_ledBlink));
+    memset(_ledFront, 0, sizeof(_ledFront));
+  }
+
+  void beginButtons(uint8_t data, uint8_t load, uint8_t clk) {
+    _btnData = data;
+    _btnLoad = load;
+    _btnClk = clk;
+    pinMode(_btnData, INPUT);
+    pinMode(_btnLoad, OUTPUT);
+    pinMode(_btnClk, OUTPUT);
+    digitalWrite(_btnLoad, HIGH);
+    digitalWrite(_btnClk, LOW);
+    memset(_buttons, 0, sizeof(_buttons));
+    _instance = this;
+    _timer.begin(refreshISR, PANEL_BAM_TICK);
+  }
+
+  void writePin(uint16_t pin, bool state) {
+    if (pin >= PANEL_IO_BITS || readPin(pin) == state) return;
+    _ledOn[pin >> 3] ^= 1 << (pin & 7);
+    _dirty = true;
+  }
+
+  bool readPin(uint16_t pin) {
+    if (pin >= PANEL_IO_BITS) return false;
+    return _ledOn[pin >> 3] & (1 << (pin & 7));
+  }
+
+  //Replace the on/off state of every LED
+  void writeFrame(const uint8_t *frame) {
+    if (memcmp(_ledOn, frame, PANEL_IO_BYTES) == 0) return;
+    memcpy(_ledOn, frame, PANEL_IO_BYTES);
+    _dirty = true;
+  }
+
+  //Brightness of a LED while it is on, 0-15
+  void setLevel(uint16_t pin, uint8_t level) {
+    if (pin >= PANEL_IO_BITS || _ledLevel[pin] == level) return;
+    _ledLevel[pin] = level;
+    _dirty = true;
+  }
+
+  void setBlink(uint16_t pin, LedBlink blink) {
+    if (pin >= PANEL_IO_BITS || _ledBlink[pin] == blink) return;
+    _ledBlink[pin] = blink;
+    _dirty = true;
+  }
+
+  //Brightness of the LEDs that are off, anything above 0 leaves a faint glow
+  void setInactiveLevel(uint8_t level) {
+    if (_inactiveLevel == level) return;
+    _inactiveLevel = level;
+    _dirty = true;
+  }
+
+  //Compile the back LED state into bit planes, the next frame shows them
+  void update() {
+    if (!_dirty) return;
+    //Neither the latest published nor the one being shown. The timer only
+    //moves _frameLedIndex to _ledIndex, so this one stays free while we write.
+    uint8_t shown = _frameLedIndex;
+    uint8_t spare = 0;
+    while (spare == _ledIndex || spare == shown) spare++;
+    LedPlanes &f = _ledFront[spare];
+    memset(&f, 0, sizeof(f));
+    for (int pin = 0; pin < PANEL_IO_BITS; pin++) {
+      uint8_t mask = 1 << (pin & 7);
+      bool on = _ledOn[pin >> 3] & mask;
+      uint8_t level = on ? _ledLevel[pin] : _inactiveLevel;
+      for (int b = 0; b < PANEL_BAM_PLANES; b++) {
+        if (level & (1 << b)) f.plane[b][pin >> 3] |= mask;
+      }
+      if (on) f.blink[_ledBlink[pin]][pin >> 3] |= mask;
+    }
+    _ledIndex = spare;
+    _dirty = false;
+  }
+
+  //Latest complete button scan, bit n set when button n is down
+  ButtonFrame buttonFrame() {
+    ButtonFrame frame;
+    uint8_t index;
+    do {
+      index = _btnIndex;
+      frame = _buttons[index];
+    } while (index != _btnIndex);  //A refresh landed while copying
+    return frame;
+  }
+
+  uint32_t frameCount() {
+    return _frameCount;
+  }
+
+#ifdef PANEL_IO_STATS
+  void checkStats() {
+    if (millis() - _statTimer <= PANEL_IO_STATS_INTERVAL) return;
+    _statTimer = millis();
+    uint32_t frames = _statFrames;
+    uint32_t total = _statCycles;
+    uint32_t worst = _statMax;
+    _statFrames = _statCycles = _statMax = 0;
+    uint32_t perUs = F_CPU_ACTUAL / 1000000;
+    Serial.printf("Panel IO: %lu frames, ISR per frame avg %lu max %lu uS\n",
+                  frames, frames ? total / frames / perUs : 0, worst / perUs);
+  }
+#endif
+
+private:
+  //One bit plane, runs from the timer interrupt
+  void refresh() {
+#ifdef PANEL_IO_STATS
+    uint32_t start = ARM_DWT_CYCCNT;
+#endif
+    uint8_t plane = _plane;
+    _plane = (plane + 1) % PANEL_BAM_PLANES;
+    //The interval running now was set last time, this one sets the one after
+    _timer.update(PANEL_BAM_TICK << _plane);
+
+    if (plane == 0) {
+      startFrame();
+    }
+    const LedPlanes &f = _ledFront[_frameLedIndex];
+    _scanning = plane == 0;  //Buttons are read once per frame
+    if (_scanning) {
+      digitalWriteFast(_btnLoad, LOW);
+      delayNanoseconds(100);
+      digitalWriteFast(_btnLoad, HIGH);
+    }
+
+    uint8_t rx[PANEL_IO_BYTES];
+    digitalWriteFast(_ledLatch, LOW);
+    for (int i = 0; i < PANEL_IO_BYTES; i++) {
+      uint8_t out = f.plane[plane][PANEL_IO_BYTES - 1 - i] & _visible[PANEL_IO_BYTES - 1 - i];
+      uint8_t in = 0;
+      for (int bit = 7; bit >= 0; bit--) {
+        digitalWriteFast(_ledData, (out >> bit) & 1);
+        if (_scanning) {
+          in |= digitalReadFast(_btnData) << bit;
+          digitalWriteFast(_btnClk, HIGH);
+          digitalWriteFast(_btnClk, LOW);
+        }
+        digitalWriteFast(_ledClk, HIGH);
+        digitalWriteFast(_ledClk, LOW);
+      }
+      rx[i] = in;
+    }
+    digitalWriteFast(_ledLatch, HIGH);
+    if (_scanning) publishButtons(rx);
+#ifdef PANEL_IO_STATS
+    _frameCycles += ARM_DWT_CYCCNT - start;
+#endif
+  }
+
+  //Pick up the latest LED planes and work out which blinking LEDs are lit
+  void startFrame() {
+#ifdef PANEL_IO_STATS
+    if (_frameCount > 0) {
+      _statFrames++;
+      _statCycles += _frameCycles;
+      if (_frameCycles > _statMax) _statMax = _frameCycles;
+    }
+    _frameCycles = 0;
+#endif
+    _frameLedIndex = _ledIndex;
+    _frameCount++;
+    const LedPlanes &f = _ledFront[_frameLedIndex];
+    uint8_t step = (_frameCount / PANEL_BLINK_STEP) & 31;
+    memset(_visible, 0xFF, sizeof(_visible));
+    for (int p = 0; p < LED_BLINK_PATTERNS; p++) {
+      if (ledBlinkPatterns[p] & (1UL << step)) continue;
+      for (int i = 0; i < PANEL_IO_BYTES; i++) {
+        _visible[i] &= ~f.blink[p][i];
+      }
+    }
+  }
+
+  void publishButtons(const uint8_t *rx) {
+    uint8_t spare = _btnIndex ^ 1;
+    ButtonFrame &frame = _buttons[spare];
+    frame.bits[0] = frame.bits[1] = frame.bits[2] = 0;
+    for (int i = 0; i < PANEL_IO_BYTES; i++) {
+      frame.bits[i >> 2] |= (uint32_t)rx[i] << ((i & 3) * 8);
+    }
+    if (PANEL_BUTTONS_ACTIVE_LOW) {
+      frame.bits[0] = ~frame.bits[0];
+      frame.bits[1] = ~frame.bits[1];
+      frame.bits[2] = ~frame.bits[2] & 0xFFFF;
+    }
+    _btnIndex = spare;
+  }
+
+  static void refreshISR() {
+    _instance->refresh();
+  }
+
+  static PanelIO *_instance;
+  IntervalTimer _timer;
+  uint8_t _ledData, _ledLatch, _ledClk;
+  uint8_t _btnData, _btnLoad, _btnClk;
+
+  //Back LED state, main loop only
+  uint8_t _ledOn[PANEL_IO_BYTES];
+  uint8_t _ledLevel[PANEL_IO_BITS];
+  uint8_t _ledBlink[PANEL_IO_BITS];
+  uint8_t _inactiveLevel = 0;
+  bool _dirty = true;
+
+  LedPlanes _ledFront[3];
+  volatile uint8_t _ledIndex = 0;
+  volatile uint8_t _frameLedIndex = 0;
+  uint8_t _visible[PANEL_IO_BYTES];
+  uint8_t _plane = 0;
+  volatile uint32_t _frameCount = 0;
+  volatile bool _scanning = false;
+
+  ButtonFrame _buttons[2];
+  volatile uint8_t _btnIndex = 0;
+
+#ifdef PANEL_IO_STATS
+  uint32_t _frameCycles = 0;
+  volatile uint32_t _statFrames = 0;
+  volatile uint32_t _statCycles = 0;
+  volatile uint32_t _statMax = 0;
+  unsigned long _statTimer = 0;
+#endif
+};
+
+PanelIO *PanelIO::_instance = nullptr;
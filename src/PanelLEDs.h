@@ -0,0 +1,119 @@
+// Panel LEDs derived from the patch state
+//
+// Instead of every updateX() writing its own LED, the whole 80 LED frame is
+// built from the parameters in one pass through a table, so a LED can't
+// disagree with the value it shows. The frame goes to PanelIO, which only
+// passes it on to the chain when it differs from the one latched.
+//
+// Blinking is left to the PanelIO refresh, here a LED only gets a pattern.
+
+#define LED_INACTIVE_LEVEL 0  //1-3 gives the LEDs that are off a faint glow
+
+static bool ledHidPending = false;  //A patch recall is stepping the HID menus
+
+struct LedBinding {
+  uint8_t led;
+  const int *value;
+  bool lit;  //State of the LED while the value is non zero
+};
+
+#define LED_ON(l, v) { l, &v, true }
+#define LED_OFF(l, v) { l, &v, false }
+
+constexpr LedBinding ledBindings[] = {
+  LED_ON(LFO_INVERT_LED, lfoInvert),
+  LED_ON(CONT_OSC3_AMOUNT_LED, contourOsc3Amt),
+  LED_ON(VOICE_MOD_DEST_VCA_LED, voiceModDestVCA),
+  LED_ON(ARP_MODE_LED, arpModeFirstPress),  //Menu LEDs are lit while the menu is open
+  LED_ON(ARP_RANGE_LED, arpRangeFirstPress),
+  LED_ON(PHASER_LED, phaserSW),
+  LED_ON(VOICE_MOD_DEST_FILTER_LED, voiceModToFilter),
+  LED_ON(VOICE_MOD_DEST_PW2_LED, voiceModToPW2),
+  LED_ON(VOICE_MOD_DEST_PW1_LED, voiceModToPW1),
+  LED_ON(VOICE_MOD_DEST_OSC2_LED, voiceModToOsc2),
+  LED_ON(VOICE_MOD_DEST_OSC1_LED, voiceModToOsc1),
+  LED_ON(ARP_ON_OFF_LED, arpOnSW),
+  LED_ON(ARP_HOLD_LED, arpHold),
+  LED_ON(ARP_SYNC_LED, arpSync),
+  LED_ON(MONO_LED, monoMode),
+  LED_ON(POLY_LED, polyMode),
+  LED_ON(GLIDE_LED, glideSW),
+  LED_ON(NUM_OF_VOICES_LED, maxVoicesFirstPress),
+  LED_ON(OCTAVE_MINUS_LED, octaveDown),
+  LED_ON(OCTAVE_ZERO_LED, octaveNormal),
+  LED_ON(OCTAVE_PLUS_LED, octaveUp),
+  LED_ON(LFO_SAW_LED, lfoSaw),
+  LED_ON(LFO_TRIANGLE_LED, lfoTriangle),
+  LED_ON(LFO_SYNC_LED, lfoSyncSW),
+  LED_ON(LFO_KEYB_RESET_LED, lfoKeybReset),
+  LED_ON(DC_LED, wheelDC),
+  LED_ON(LFO_DEST_OSC1_LED, lfoDestOsc1),
+  LED_ON(LFO_DEST_OSC2_LED, lfoDestOsc2),
+  LED_ON(LFO_DEST_OSC3_LED, lfoDestOsc3),
+  LED_ON(LFO_DEST_VCA_LED, lfoDestVCA),
+  LED_ON(LFO_SAMPLE_HOLD_LED, lfoSampleHold),
+  LED_ON(LFO_SQUARE_LED, lfoSquare),
+  LED_ON(LFO_RAMP_LED, lfoRamp),
+  LED_ON(LFO_DEST_PW1_LED, lfoDestPW1),
+  LED_ON(LFO_DEST_PW2_LED, lfoDestPW2),
+  LED_ON(LFO_DEST_PW3_LED, lfoDestPW3),
+  LED_ON(LFO_DEST_FILTER_LED, lfoDestFilter),
+  LED_ON(OSC1_2_LED, osc1_2),
+  LED_ON(OSC1_4_LED, osc1_4),
+  LED_ON(OSC1_8_LED, osc1_8),
+  LED_ON(OSC1_16_LED, osc1_16),
+  LED_ON(OSC2_16_LED, osc2_16),
+  LED_ON(OSC2_8_LED, osc2_8),
+  LED_ON(OSC2_4_LED, osc2_4),
+  LED_ON(OSC2_2_LED, osc2_2),
+  LED_ON(OSC2_SAW_LED, osc2Saw),
+  LED_ON(OSC1_SAW_LED, osc1Saw),
+  LED_ON(OSC2_SQUARE_LED, osc2Square),
+  LED_ON(OSC1_SQUARE_LED, osc1Square),
+  LED_ON(OSC3_SAW_LED, osc3Saw),
+  LED_ON(OSC3_SQUARE_LED, osc3Square),
+  LED_ON(OSC2_TRIANGLE_LED, osc2Triangle),
+  LED_ON(OSC1_TRIANGLE_LED, osc1Triangle),
+  LED_ON(OSC3_TRIANGLE_LED, osc3Triangle),
+  LED_OFF(SLOPE_GREEN_LED, slopeSW),  //Green for two pole
+  LED_ON(SLOPE_RED_LED, slopeSW),     //Red for four pole
+  LED_ON(ECHO_ON_OFF_LED, echoSW),
+  LED_ON(ECHO_SYNC_LED, echoSyncSW),
+  LED_ON(RELEASE_LED, releaseSW),
+  LED_ON(KEYBOARD_FOLLOW_LED, keyboardFollowSW),
+  LED_ON(UNCONDITIONAL_CONTOUR_LED, unconditionalContourSW),
+  LED_ON(RETURN_TO_ZERO_LED, returnSW),
+  LED_ON(REVERB_ON_OFF_LED, reverbSW),
+  LED_ON(REVERB_TYPE_LED, reverbTypeFirstPress),
+  LED_ON(LIMIT_LED, limitSW),
+  LED_ON(MODERN_LED, modernSW),
+  LED_ON(OSC3_2_LED, osc3_2),
+  LED_ON(OSC3_4_LED, osc3_4),
+  LED_ON(OSC3_8_LED, osc3_8),
+  LED_ON(OSC3_16_LED, osc3_16),
+  LED_ON(ENSEMBLE_LED, ensembleSW),
+  LED_ON(LOW_LED, lowSW),
+  LED_ON(KEYBOARD_CONTROL_LED, keyboardControlSW),
+  LED_ON(OSC_SYNC_LED, oscSyncSW)
+};
+
+static inline void setFrameLED(uint8_t *frame, uint8_t led, bool state) {
+  if (state) frame[led >> 3] |= 1 << (led & 7);
+}
+
+//Build the complete LED frame from the current patch state
+void buildLEDFrame(PanelIO &io) {
+  uint8_t frame[PANEL_IO_BYTES] = {};
+  for (const LedBinding &b : ledBindings) {
+    setFrameLED(frame, b.led, (*b.value != 0) == b.lit);
+  }
+  //Multiple trigger only applies in mono mode
+  setFrameLED(frame, MULT_TRIG_LED, monoMode && multTrig);
+  //Chord mode blinks while it waits for the chord to be played
+  setFrameLED(frame, CHORD_MODE_LED, chordMode || chordMemoryWait);
+  io.setBlink(CHORD_MODE_LED, chordMemoryWait ? LED_BLINK : LED_STEADY);
+  //The mode LEDs flash until the HID menus have caught up with a recall
+  io.setBlink(MONO_LED, ledHidPending ? LED_BLINK_FAST : LED_STEADY);
+  io.setBlink(POLY_LED, ledHidPending ? LED_BLINK_FAST : LED_STEADY);
+  io.writeFrame(frame);
+}
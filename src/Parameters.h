@@ -11,15 +11,6 @@ const long interval = 250;
 const char* constantString = "        ";
 const char* constantString2 = "";
 
-static unsigned long LCD_timer = 0;
-static unsigned long learn_timer = 0;
-static unsigned long maxVoices_timer = 0;
-static unsigned long arpRange_timer = 0;
-static unsigned long arpMode_timer = 0;
-static unsigned long reverbType_timer = 0;
-static unsigned long poly_timer = 0;
-static unsigned long mono_timer = 0;
-
 int readresdivider = 32;
 int resolutionFrig = 1;
 boolean recallPatchFlag = false;
@@ -34,11 +25,10 @@ int CC_OFF = 127;
 int MIDIThru = midi::Thru::Off;//(EEPROM)
 String patchName = INITPATCHNAME;
 boolean encCW = true;//This is to set the encoder to increment when turned CW - Settings Option
-boolean updateParams = false;  //(EEPROM)
-boolean sendNotes = false;  //(EEPROM)
 
 // New parameters
 // Pots
+// The int32_t *str values are hundredths, straight from the MEMORYMODE tables
 
 int glide, glide100, glidePREV;
 int glidestr = 0;
@@ -56,11 +46,11 @@ int lfoFilterContour, lfoFilterContour100, lfoFilterContourPREV;
 int lfoFilterContourstr = 0;
 
 int arpSpeed, arpSpeed100, arpSpeedPREV;
-float arpSpeedstr = 0;
+int32_t arpSpeedstr = 0;
 int arpSpeedmap = 0;
-String arpSpeedstring = "";
+const char *arpSpeedstring = "";
 
-float phaserSpeedstr = 0;
+int32_t phaserSpeedstr = 0;
 int phaserSpeed, phaserSpeed100, phaserSpeedPREV;
 
 int phaserDepth, phaserDepth100, phaserDepthPREV;
@@ -74,121 +64,120 @@ int modWheelstr = 0;
 
 int lfoSpeed, lfoSpeed100, lfoSpeedPREV;
 int lfoSpeedmap = 0;
-float lfoSpeedstr = 0;
+int32_t lfoSpeedstr = 0;
 String lfoSpeedstring = "";
-String oldWhichParameter = "                    ";
 
 int osc2Frequency, osc2Frequency100, osc2FrequencyPREV;
-float osc2Frequencystr = 0;
+int32_t osc2Frequencystr = 0;
 
 int osc2PW, osc2PW100, osc2PWPREV;
-float osc2PWstr = 0;
+int32_t osc2PWstr = 0;
 
 int osc1PW, osc1PW100, osc1PWPREV;
-float osc1PWstr = 0;
+int32_t osc1PWstr = 0;
 
 int osc3Frequency, osc3Frequency100, osc3FrequencyPREV;
-float osc3Frequencystr = 0;
+int32_t osc3Frequencystr = 0;
 
 int osc3PW, osc3PW100, osc3PWPREV;
-float osc3PWstr = 0;
+int32_t osc3PWstr = 0;
 
 int ensembleRate, ensembleRate100, ensembleRatePREV;
-float ensembleRatestr = 0;
+int32_t ensembleRatestr = 0;
 
 int ensembleDepth, ensembleDepth100, ensembleDepthPREV;
-float ensembleDepthstr = 0;
+int32_t ensembleDepthstr = 0;
 
 int echoTime, echoTime100, echoTimePREV;
 int echoTimemap= 0;
-float echoTimestr = 0;
-String echoTimestring = "";
+int32_t echoTimestr = 0;
+const char *echoTimestring = "";
 
 int echoRegen, echoRegen100, echoRegenPREV;
-float echoRegenstr = 0;
+int32_t echoRegenstr = 0;
 
 int echoDamp, echoDamp100, echoDampPREV;
-float echoDampstr = 0;
+int32_t echoDampstr = 0;
 
 int echoLevel, echoLevel100, echoLevelPREV;
-float echoLevelstr = 0;
+int32_t echoLevelstr = 0;
 
 int reverbDecay, reverbDecay100, reverbDecayPREV;
-float reverbDecaystr = 0;
+int32_t reverbDecaystr = 0;
 
 int reverbDamp, reverbDamp100, reverbDampPREV;
-float reverbDampstr = 0;
+int32_t reverbDampstr = 0;
 
 int reverbLevel, reverbLevel100, reverbLevelPREV;
-float reverbLevelstr = 0;
+int32_t reverbLevelstr = 0;
 
 int masterTune, masterTune100, masterTunePREV;
 int masterTunemap = 0;
-float masterTunestr = 0;
+int32_t masterTunestr = 0;
 
 int masterVolume, masterVolume100, masterVolumePREV;
 int masterVolumemap = 0;
-float masterVolumestr = 0;
+int32_t masterVolumestr = 0;
 
 int echoSpread, echoSpread100, echoSpreadPREV;
-float echoSpreadstr = 0;
+int32_t echoSpreadstr = 0;
 
 int noise, noise100, noisePREV;
-float noisestr = 0;
+int32_t noisestr = 0;
 
 int osc1Level, osc1Level100, osc1LevelPREV;
-float osc1Levelstr = 0;
+int32_t osc1Levelstr = 0;
 
 int osc2Level, osc2Level100, osc2LevelPREV;
-float osc2Levelstr = 0;
+int32_t osc2Levelstr = 0;
 
 int osc3Level, osc3Level100, osc3LevelPREV;
-float osc3Levelstr = 0;
+int32_t osc3Levelstr = 0;
 
 int filterCutoff, filterCutoff100, filterCutoffPREV;
-float filterCutoffstr = 0;
+int32_t filterCutoffstr = 0;
 
 int emphasis, emphasis100, emphasisPREV;
-float emphasisstr = 0;
+int32_t emphasisstr = 0;
 
 int vcfAttack, vcfAttack100, vcfAttackPREV;
-float vcfAttackstr = 0;
+int32_t vcfAttackstr = 0;
 
 int vcfDecay, vcfDecay100, vcfDecayPREV;
-float vcfDecaystr = 0;
+int32_t vcfDecaystr = 0;
 
 int vcfSustain, vcfSustain100, vcfSustainPREV;
-float vcfSustainstr = 0;
+int32_t vcfSustainstr = 0;
 
 int vcfRelease, vcfRelease100, vcfReleasePREV;
-float vcfReleasestr = 0;
+int32_t vcfReleasestr = 0;
 
 int vcaAttack, vcaAttack100, vcaAttackPREV;
-float vcaAttackstr = 0;
+int32_t vcaAttackstr = 0;
 
 int vcaDecay, vcaDecay100, vcaDecayPREV;
-float vcaDecaystr = 0;
+int32_t vcaDecaystr = 0;
 
 int vcaSustain, vcaSustain100, vcaSustainPREV;
-float vcaSustainstr = 0;
+int32_t vcaSustainstr = 0;
 
 int vcaRelease, vcaRelease100, vcaReleasePREV;
-float vcaReleasestr = 0;
+int32_t vcaReleasestr = 0;
 
 int vcaVelocity, vcaVelocity100, vcaVelocityPREV;
-float vcaVelocitystr = 0;
+int32_t vcaVelocitystr = 0;
 
 int vcfVelocity, vcfVelocity100, vcfVelocityPREV;
-float vcfVelocitystr = 0;
+int32_t vcfVelocitystr = 0;
 
 int driftAmount, driftAmount100, driftAmountPREV;
-float driftAmountstr = 0;
+int32_t driftAmountstr = 0;
 
 int vcfContourAmount, vcfContourAmount100, vcfContourAmountPREV;
-float vcfContourAmountstr = 0;
+int32_t vcfContourAmountstr = 0;
 
 int kbTrack, kbTrack100, kbTrackPREV;
-float kbTrackstr = 0;
+int32_t kbTrackstr = 0;
 
 // Buttons
 
@@ -58,6 +58,7 @@ size_t readField(File *file, char *str, size_t size, const char *delim)
 
 void recallPatchData(File patchFile, String data[])
 {
+  PROFILE_SCOPE(PROF_SD);
   //Read patch data from file and set current patch parameters
   size_t n;     // Length of returned field with delimiter.
   char str[20]; // Must hold longest field with delimiter and zero byte.
@@ -139,6 +140,7 @@ void loadPatches()
 
 void savePatch(const char *patchNo, String patchData)
 {
+  PROFILE_SCOPE(PROF_SD);
   // Serial.print("savePatch Patch No:");
   //  Serial.println(patchNo);
   //Overwrite existing patch by deleting
@@ -174,6 +176,7 @@ void savePatch(const char *patchNo, String patchData[])
 
 void deletePatch(const char *patchNo)
 {
+  PROFILE_SCOPE(PROF_SD);
   if (SD.exists(patchNo)) SD.remove(patchNo);
 }
 
@@ -0,0 +1,131 @@
+// Velocity aware thinning of pot CCs
+//
+// A fast sweep of a pot produces a CC for nearly every step, and each one runs
+// the full update/display/MIDI out path. While a pot is moving faster than
+// POT_FAST_VELOCITY only values at least the parameter's sweep step away from
+// the last one sent go out, the rest are held as pending. As soon as the pot
+// has not changed for POT_SETTLE_MS the exact final value is sent.
+//
+// The sweep step is per CC, 1 turns thinning off for that parameter.
+
+#define POT_FAST_VELOCITY 16  //Steps per 100mS above which a pot is sweeping
+#define POT_SETTLE_MS 15      //No change for this long and the pot has settled
+#define POT_SWEEP_STEP 4      //Default sweep step
+#define POT_NO_VALUE 0xFF
+
+//Uncomment to count thinned messages and the settle latency of final values
+//#define POT_THINNING_STATS
+#define POT_STATS_INTERVAL 10000
+
+void myControlChange(byte channel, byte control, int value);
+
+static byte potSweepStep[128];
+static byte potLastSent[128];
+static byte potPending[128];
+static unsigned int potVelocity[128];  //Smoothed, steps per 100mS
+static unsigned long potLastChange[128];
+static uint32_t potPendingMask[4] = {};  //One bit per CC with a pending value
+
+#ifdef POT_THINNING_STATS
+static unsigned long potValuesIn = 0;
+static unsigned long potValuesSent = 0;
+static unsigned long potSettled = 0;
+static unsigned long potSettleTotal = 0;
+static unsigned long potSettleMax = 0;
+static unsigned long potStatsTimer = 0;
+#endif
+
+void setPotSweepStep(byte cc, byte step) {
+  potSweepStep[cc] = step < 1 ? 1 : step;
+}
+
+void setupPotThinning() {
+  for (int i = 0; i < 128; i++) {
+    potSweepStep[i] = POT_SWEEP_STEP;
+    potLastSent[i] = POT_NO_VALUE;
+    potPending[i] = POT_NO_VALUE;
+    potVelocity[i] = 0;
+    potLastChange[i] = 0;
+  }
+  //Pitch related pots are set by ear, every step counts
+  setPotSweepStep(CCmasterTune, 1);
+  setPotSweepStep(CCosc2Frequency, 1);
+  setPotSweepStep(CCosc3Frequency, 1);
+  //Volume jumps are audible
+  setPotSweepStep(CCmasterVolume, 2);
+  //Filter cutoff sweeps are the common case, let more through
+  setPotSweepStep(CCfilterCutoff, 3);
+}
+
+static void potSend(byte cc, byte value) {
+  potLastSent[cc] = value;
+  potPending[cc] = POT_NO_VALUE;
+  potPendingMask[cc >> 5] &= ~(1UL << (cc & 31));
+#ifdef POT_THINNING_STATS
+  potValuesSent++;
+#endif
+  myControlChange(midiChannel, cc, value);
+}
+
+//checkMux() calls this instead of myControlChange()
+void potControlChange(byte cc, byte value) {
+#ifdef LATENCY_BENCH
+  latencyBenchControl(cc);
+#endif
+  unsigned long now = millis();
+  unsigned long dt = now - potLastChange[cc];
+  byte previous = potPending[cc] != POT_NO_VALUE ? potPending[cc] : potLastSent[cc];
+  unsigned int step = previous == POT_NO_VALUE ? 0 : abs(value - previous);
+  potLastChange[cc] = now;
+#ifdef POT_THINNING_STATS
+  potValuesIn++;
+#endif
+
+  if (dt < 1) dt = 1;
+  if (dt > 100) {
+    potVelocity[cc] = 0;  //Starting from rest
+  } else {
+    potVelocity[cc] = (potVelocity[cc] + (step * 100) / dt) / 2;
+  }
+
+  if (potSweepStep[cc] > 1 && potVelocity[cc] > POT_FAST_VELOCITY && potLastSent[cc] != POT_NO_VALUE
+      && abs(value - potLastSent[cc]) < potSweepStep[cc]) {
+    potPending[cc] = value;
+    potPendingMask[cc >> 5] |= 1UL << (cc & 31);
+    return;
+  }
+  potSend(cc, value);
+}
+
+//Send the final value of pots that have stopped moving, run with the mux scan
+void flushPotThinning() {
+  unsigned long now = millis();
+  for (int w = 0; w < 4; w++) {
+    uint32_t bits = potPendingMask[w];
+    while (bits) {
+      byte cc = (w << 5) + __builtin_ctz(bits);
+      bits &= bits - 1;
+      unsigned long settle = now - potLastChange[cc];
+      if (settle >= POT_SETTLE_MS) {
+#ifdef POT_THINNING_STATS
+        potSettled++;
+        potSettleTotal += settle;
+        if (settle > potSettleMax) potSettleMax = settle;
+#endif
+        potVelocity[cc] = 0;
+        potSend(cc, potPending[cc]);
+      }
+    }
+  }
+}
+
+#ifdef POT_THINNING_STATS
+void checkPotThinningStats() {
+  if (millis() - potStatsTimer > POT_STATS_INTERVAL) {
+    potStatsTimer = millis();
+    Serial.printf("Pot thinning: in %lu sent %lu saved %lu | final values %lu settle avg %lu max %lu mS\n",
+                  potValuesIn, potValuesSent, potValuesIn - potValuesSent, potSettled,
+                  potSettled ? potSettleTotal / potSettled : 0, potSettleMax);
+  }
+}
+#endif
@@ -0,0 +1,108 @@
+// Per stage loop() profiler
+//
+// PROFILE_SCOPE(stage) at the top of a function or block times it until the
+// end of the scope with the DWT cycle counter and keeps count, min, max, total
+// and a log2 histogram per stage. Send 'p' on the USB serial port for a report,
+// 'r' clears the counters. Without LOOP_PROFILE the macro is empty, nothing is
+// compiled in.
+//
+// Built without the Teensy core (ARM_DWT_CYCCNT not defined) the ticks come
+// from std::chrono in nS, so the same report works in a host build.
+
+//Uncomment to profile the loop() stages
+//#define LOOP_PROFILE
+
+enum ProfileStage {
+  PROF_MUX,
+  PROF_SWITCHES,
+  PROF_MIDI_IN,
+  PROF_CC_OUT,
+  PROF_DISPLAY,
+  PROF_LCD,
+  PROF_LEDS,
+  PROF_SD,
+  PROF_STAGES
+};
+
+#ifdef LOOP_PROFILE
+
+#define PROFILE_BUCKETS 32
+
+#ifdef ARM_DWT_CYCCNT
+static inline uint32_t profileNow() {
+  return ARM_DWT_CYCCNT;
+}
+#define PROFILE_TICKS_PER_US (F_CPU_ACTUAL / 1000000)
+#else
+#include <chrono>
+static inline uint32_t profileNow() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#define PROFILE_TICKS_PER_US 1000
+#endif
+
+static const char *const profileNames[PROF_STAGES] = { "mux", "switches", "midi in", "cc out", "display", "lcd", "leds", "sd" };
+
+struct ProfileStats {
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint64_t total;
+  uint32_t hist[PROFILE_BUCKETS];  //Bucket n holds runs of 2^n to 2^(n+1) - 1 ticks
+};
+
+static ProfileStats profileStats[PROF_STAGES];
+
+void profileRecord(uint8_t stage, uint32_t ticks) {
+  ProfileStats &s = profileStats[stage];
+  if (s.count == 0 || ticks < s.min) s.min = ticks;
+  if (ticks > s.max) s.max = ticks;
+  s.count++;
+  s.total += ticks;
+  s.hist[ticks ? 31 - __builtin_clz(ticks) : 0]++;
+}
+
+struct ProfileScope {
+  uint8_t stage;
+  uint32_t start;
+  ProfileScope(uint8_t s)
+    : stage(s), start(profileNow()) {}
+  ~ProfileScope() {
+    profileRecord(stage, profileNow() - start);
+  }
+};
+
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+#define PROFILE_SCOPE(stage) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(stage)
+
+void profileReset() {
+  memset(profileStats, 0, sizeof(profileStats));
+}
+
+void printProfile() {
+  uint32_t perUs = PROFILE_TICKS_PER_US;
+  Serial.println("Profile: stage count min avg max uS | log2 histogram (2^n ticks, first..last used)");
+  for (int i = 0; i < PROF_STAGES; i++) {
+    ProfileStats &s = profileStats[i];
+    if (s.count == 0) continue;
+    Serial.printf("%-8s %8lu %6lu %6lu %6lu |", profileNames[i], s.count, s.min / perUs,
+                  (uint32_t)(s.total / s.count) / perUs, s.max / perUs);
+    int first = 0, last = PROFILE_BUCKETS - 1;
+    while (!s.hist[first]) first++;
+    while (!s.hist[last]) last--;
+    Serial.printf(" %d:", first);
+    for (int b = first; b <= last; b++) Serial.printf(" %lu", s.hist[b]);
+    Serial.println();
+  }
+}
+
+//Serial commands, from checkSerialCommands()
+void profileCommand(int c) {
+  if (c == 'p') printProfile();
+  if (c == 'r') profileReset();
+}
+
+#else
+#define PROFILE_SCOPE(stage)
+#endif
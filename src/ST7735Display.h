@@ -6,12 +6,22 @@
 #define dc 2   //but certain pairs must NOT be used: 2+10, 6+9, 20+23, 21+22
 #define rst 9  // RST can use any pin
 #define DISPLAYTIMEOUT 1500
+#define DISPLAY_FRAME_MS 33  //Displays are redrawn at most 30 times a second
+
+//Uncomment to print SPI bytes and time per TFT update, only the dirty area is sent
+//#define TFT_STATS
+#define TFT_STATS_INTERVAL 10000
+//Uncomment to print the time per patch list frame, render and update start
+//#define LIST_SCROLL_STATS
+//Uncomment to time page renders into the frame buffer with and without the glyph cache at startup
+//#define GLYPH_BENCH
+#define GLYPH_BENCH_RUNS 50
 
 #include <Adafruit_GFX.h>
 #include "ST7735_t3.h"  // Local copy from TD1.48 that works for 0.96" IPS 160x80 display
 
 // Section: Included library
-#include "HD44780_LCD_PCF8574.h"
+#include "LCDBuffer.h"
 #include <Fonts/Org_01.h>
 #include "Yeysk16pt7b.h"
 #include <Fonts/FreeSansBold18pt7b.h>
@@ -27,12 +37,11 @@
 #define AMP_ENV2 5
 
 ST7735_t3 tft = ST7735_t3(cs, dc, 11, 13, rst);
-HD44780LCD LCD(2, 20, 0x27, &Wire);  // instantiate an object
 
-String currentParameter = "";
-String prevcurrentParameter = "";
-String currentValue = "";
-String prevcurrentValue = "";
+TextBuffer<24> currentParameter;  //Being drawn, copied from the render request
+TextBuffer<24> currentValue;
+TextBuffer<24> uiParameter;  //Set by the UI, sent with the next render request
+TextBuffer<24> uiValue;
 float currentFloatValue = 0.0;
 String currentPgmNum = "";
 String currentPatchName = "";
@@ -47,6 +56,55 @@ boolean MIDIClkSignal = false;
 
 unsigned long timer = 0;
 
+//What the TFT frame buffer holds, so a page that has not changed is not redrawn
+#define TFT_PAGE_OTHER 0
+#define TFT_PAGE_PATCH 1
+#define TFT_PAGE_PARAMETER 2
+#define TFT_PAGE_RECALL 3
+#define TFT_PAGE_SAVE 4
+#define TFT_PAGE_DELETE 5
+static volatile int tftPage = TFT_PAGE_OTHER;
+
+//The patch list pages draw their title once, a scroll redraws the rows only,
+//each in its own rectangle. The middle row is highlighted, so a scroll moves
+//every row's text across a background change, there is nothing to keep.
+
+#ifdef LIST_SCROLL_STATS
+static uint32_t listStatFrames = 0;
+static uint32_t listStatRows = 0;
+static uint32_t listStatCycles = 0;
+static uint32_t listStatMax = 0;
+static unsigned long listStatTimer = 0;
+#endif
+static TextBuffer<24> tftParameter;  //Name and value on the parameter page
+static TextBuffer<24> tftValue;
+
+//Render requests, posted by the UI and drawn by the display thread. The thread
+//yields while the queue is empty and while the DMA is still sending the last
+//frame. It polls the queue and a flag the DMA completion interrupt sets, the
+//interrupt does not touch the thread scheduler.
+#define DISPLAY_QUEUE_SIZE 4
+#define DISPLAY_NO_PAGE 0xFF
+
+struct DisplayRequest {
+  unsigned int page;  //state to draw
+  TextBuffer<24> parameter;
+  TextBuffer<24> value;
+};
+
+static DisplayRequest displayQueue[DISPLAY_QUEUE_SIZE];
+static volatile uint8_t displayQueueHead = 0;  //Next free slot
+static volatile uint8_t displayQueueTail = 0;  //Next to draw
+static unsigned int displayPostedPage = DISPLAY_NO_PAGE;
+static bool displayTimeoutPending = false;
+static volatile bool displayFrameSent = true;  //Set by the DMA interrupt, the last frame is out
+
+void requestDisplay();
+
+#ifdef TFT_STATS
+static unsigned long tftStatsTimer = 0;
+#endif
+
 void startTimer() {
   if (state == PARAMETER) {
     timer = millis();
@@ -54,12 +112,9 @@ void startTimer() {
 }
 
 void renderBootUpPage() {
-  char testString1[] = "Memory Mode";
-  LCD.PCF8574_LCDGOTO(LCD.LCDLineNumberTwo, 5);
-  LCD.PCF8574_LCDSendString(testString1);
-  char testString2[] = "Editor V1.2";
-  LCD.PCF8574_LCDGOTO(LCD.LCDLineNumberOne, 5);
-  LCD.PCF8574_LCDSendString(testString2);
+  lcdPrint(1, 5, "Memory Mode");
+  lcdPrint(0, 5, "Editor V1.2");
+  lcdFlushAll();
   // LCD.PCF8574_LCDGOTO(LCD.LCDLineNumberOne, 12);
   // LCD.PCF8574_LCDSendString(VERSION);
 
@@ -113,15 +168,33 @@ void renderCurrentParameterPage() {
       tft.setCursor(0, 53);
       tft.setTextColor(ST7735_YELLOW);
       tft.setTextSize(1);
-      tft.println(currentParameter);
+      tft.println(currentParameter.c_str());
       tft.drawFastHLine(10, 62, tft.width() - 20, ST7735_RED);
       tft.setCursor(1, 90);
       tft.setTextColor(ST7735_WHITE);
-      tft.println(currentValue);
+      tft.println(currentValue.c_str());
+      tftPage = TFT_PAGE_PARAMETER;
+      tftParameter = currentParameter;
+      tftValue = currentValue;
       break;
   }
 }
 
+//Same parameter, new value: clear the old value text and draw the new one,
+//so only that field is dirty and sent to the display
+void renderCurrentParameterValue() {
+  int16_t x, y;
+  uint16_t w, h;
+  tft.setFont(&FreeSans12pt7b);
+  tft.setTextSize(1);
+  tft.getTextBounds(tftValue.c_str(), 1, 90, &x, &y, &w, &h);
+  tft.fillRect(x, y, w, h, ST7735_BLACK);
+  tft.setCursor(1, 90);
+  tft.setTextColor(ST7735_WHITE);
+  tft.print(currentValue.c_str());
+  tftValue = currentValue;
+}
+
 // void renderCurrentParameterPage() {
 //   LCD_timer = millis();
 //   switch (state) {
@@ -143,28 +216,42 @@ void renderCurrentParameterPage() {
 //   oldWhichParameter = "Trash";
 // }
 
-void renderDeletePatchPage() {
+//Start a list page, the title is drawn once
+static bool renderListPage(int page, const char *title) {
+  if (tftPage == page) return false;
   tft.fillScreen(ST7735_BLACK);
-  tft.setFont(&FreeSansBold18pt7b);
-  tft.setCursor(5, 53);
-  tft.setTextColor(ST7735_YELLOW);
-  tft.setTextSize(1);
-  tft.println("Delete?");
-  tft.drawFastHLine(10, 60, tft.width() - 20, ST7735_RED);
+  if (title) {
+    tft.setFont(&FreeSansBold18pt7b);
+    tft.setCursor(5, 53);
+    tft.setTextColor(ST7735_YELLOW);
+    tft.setTextSize(1);
+    tft.println(title);
+    tft.drawFastHLine(10, 60, tft.width() - 20, ST7735_RED);
+  }
+  tftPage = page;
+  return true;
+}
+
+//One patch list row in FreeSans9pt7b, top and height cover the text's ascent and descent
+static void renderListRow(int16_t top, int16_t height, int16_t baseline, uint16_t background, const PatchNoAndName &patch) {
+  tft.fillRect(0, top, tft.width(), height, background);
   tft.setFont(&FreeSans9pt7b);
-  tft.setCursor(0, 78);
-  tft.setTextColor(ST7735_YELLOW);
-  tft.println(patches.last().patchNo);
-  tft.setCursor(35, 78);
-  tft.setTextColor(ST7735_WHITE);
-  tft.println(patches.last().patchName);
-  tft.fillRect(0, 85, tft.width(), 23, ST77XX_DARKRED);
-  tft.setCursor(0, 98);
+  tft.setTextSize(1);
+  tft.setCursor(0, baseline);
   tft.setTextColor(ST7735_YELLOW);
-  tft.println(patches.first().patchNo);
-  tft.setCursor(35, 98);
+  tft.print(patch.patchNo);
+  tft.setCursor(35, baseline);
   tft.setTextColor(ST7735_WHITE);
-  tft.println(patches.first().patchName);
+  tft.print(patch.patchName);
+#ifdef LIST_SCROLL_STATS
+  listStatRows++;
+#endif
+}
+
+void renderDeletePatchPage() {
+  renderListPage(TFT_PAGE_DELETE, "Delete?");
+  renderListRow(63, 22, 78, ST7735_BLACK, patches.last());
+  renderListRow(85, 23, 98, ST77XX_DARKRED, patches.first());
 }
 
 void renderDeleteMessagePage() {
@@ -179,27 +266,9 @@ void renderDeleteMessagePage() {
 }
 
 void renderSavePage() {
-  tft.fillScreen(ST7735_BLACK);
-  tft.setFont(&FreeSansBold18pt7b);
-  tft.setCursor(5, 53);
-  tft.setTextColor(ST7735_YELLOW);
-  tft.setTextSize(1);
-  tft.println("Save?");
-  tft.drawFastHLine(10, 60, tft.width() - 20, ST7735_RED);
-  tft.setFont(&FreeSans9pt7b);
-  tft.setCursor(0, 78);
-  tft.setTextColor(ST7735_YELLOW);
-  tft.println(patches[patches.size() - 2].patchNo);
-  tft.setCursor(35, 78);
-  tft.setTextColor(ST7735_WHITE);
-  tft.println(patches[patches.size() - 2].patchName);
-  tft.fillRect(0, 85, tft.width(), 23, ST77XX_DARKRED);
-  tft.setCursor(0, 98);
-  tft.setTextColor(ST7735_YELLOW);
-  tft.println(patches.last().patchNo);
-  tft.setCursor(35, 98);
-  tft.setTextColor(ST7735_WHITE);
-  tft.println(patches.last().patchName);
+  renderListPage(TFT_PAGE_SAVE, "Save?");
+  renderListRow(63, 22, 78, ST7735_BLACK, patches[patches.size() - 2]);
+  renderListRow(85, 23, 98, ST77XX_DARKRED, patches.last());
 }
 
 void renderReinitialisePage() {
@@ -227,33 +296,15 @@ void renderPatchNamingPage() {
 }
 
 void renderRecallPage() {
-  tft.fillScreen(ST7735_BLACK);
-  tft.setFont(&FreeSans9pt7b);
-  tft.setCursor(0, 45);
-  tft.setTextColor(ST7735_YELLOW);
-  tft.println(patches.last().patchNo);
-  tft.setCursor(35, 45);
-  tft.setTextColor(ST7735_WHITE);
-  tft.println(patches.last().patchName);
-
-  tft.fillRect(0, 56, tft.width(), 23, 0xA000);
-  tft.setCursor(0, 72);
-  tft.setTextColor(ST7735_YELLOW);
-  tft.println(patches.first().patchNo);
-  tft.setCursor(35, 72);
-  tft.setTextColor(ST7735_WHITE);
-  tft.println(patches.first().patchName);
-
-  tft.setCursor(0, 98);
-  tft.setTextColor(ST7735_YELLOW);
-  patches.size() > 1 ? tft.println(patches[1].patchNo) : tft.println(patches.last().patchNo);
-  tft.setCursor(35, 98);
-  tft.setTextColor(ST7735_WHITE);
-  patches.size() > 1 ? tft.println(patches[1].patchName) : tft.println(patches.last().patchName);
+  renderListPage(TFT_PAGE_RECALL, NULL);
+  renderListRow(30, 26, 45, ST7735_BLACK, patches.last());
+  renderListRow(56, 23, 72, 0xA000, patches.first());
+  renderListRow(79, 27, 98, ST7735_BLACK, patches.size() > 1 ? patches[1] : patches.last());
 }
 
 void showRenamingPage(String newName) {
   newPatchName = newName;
+  requestDisplay();
 }
 
 void renderUpDown(uint16_t x, uint16_t y, uint16_t colour) {
@@ -278,57 +329,137 @@ void renderSettingsPage() {
   if (currentSettingsPart == SETTINGSVALUE) renderUpDown(140, 80, ST7735_WHITE);
 }
 
+//Queue the current state for drawing, a newer request for the same page
+//replaces the queued one and when full the newest request wins
+void requestDisplay() {
+  __disable_irq();
+  uint8_t last = (displayQueueHead + DISPLAY_QUEUE_SIZE - 1) % DISPLAY_QUEUE_SIZE;
+  DisplayRequest *request;
+  if (displayQueueHead != displayQueueTail
+      && (displayQueue[last].page == state || (displayQueueHead + 1) % DISPLAY_QUEUE_SIZE == displayQueueTail)) {
+    request = &displayQueue[last];
+  } else {
+    request = &displayQueue[displayQueueHead];
+    displayQueueHead = (displayQueueHead + 1) % DISPLAY_QUEUE_SIZE;
+  }
+  request->page = state;
+  request->parameter = uiParameter;
+  request->value = uiValue;
+  __enable_irq();
+  displayPostedPage = state;
+}
+
+//Called every loop pass, picks up pages changed by just setting state and
+//the parameter page going back to the patch page after DISPLAYTIMEOUT
+void checkDisplayRequests() {
+  if (state != displayPostedPage) {
+    requestDisplay();
+  } else if (displayTimeoutPending && state == PARAMETER && millis() - timer > DISPLAYTIMEOUT) {
+    displayTimeoutPending = false;
+    requestDisplay();
+  }
+}
+
 void showCurrentParameterPage(const char *param, float val, int pType) {
-  currentParameter = param;
-  currentValue = String(val);
+  uiParameter.clear();
+  uiParameter.add(param);
+  uiValue.clear();
+  uiValue.addFixed(val);
   currentFloatValue = val;
   paramType = pType;
   startTimer();
+  displayTimeoutPending = true;
+  requestDisplay();
 }
 
-void showCurrentParameterPage(const char *param, String val, int pType) {
+void showCurrentParameterPage(const char *param, const char *val, int pType) {
   if (state == SETTINGS || state == SETTINGSVALUE) state = PARAMETER;  //Exit settings page if showing
-  currentParameter = param;
-  currentValue = val;
+  uiParameter.clear();
+  uiParameter.add(param);
+  uiValue.clear();
+  uiValue.add(val);
   paramType = pType;
   startTimer();
+  displayTimeoutPending = true;
+  requestDisplay();
 }
 
-void showCurrentParameterPage(const char *param, String val) {
+void showCurrentParameterPage(const char *param, const char *val) {
   showCurrentParameterPage(param, val, PARAMETER);
 }
 
 void showPatchPage(String number, String patchName) {
   currentPgmNum = number;
   currentPatchName = patchName;
+  if (tftPage == TFT_PAGE_PATCH) tftPage = TFT_PAGE_OTHER;  //Redraw with the new patch
+  requestDisplay();
 }
 
 void showSettingsPage(const char *option, const char *value, int settingsPart) {
   currentSettingsOption = option;
   currentSettingsValue = value;
   currentSettingsPart = settingsPart;
+  requestDisplay();
+}
+
+//Runs in the DMA interrupt when a frame has gone out
+void displayUpdateDone() {
+  displayFrameSent = true;
+}
+
+//Give the rest of the time slice to loop() until ready is true
+static void displayYieldUntil(bool (*ready)()) {
+  while (!ready()) threads.yield();
+}
+
+static bool displayQueueReady() {
+  return displayQueueHead != displayQueueTail;
+}
+
+static bool displayDmaIdle() {
+  return displayFrameSent;
+}
+
+//Start sending what was drawn. Cleared first so a frame that goes out before
+//updateScreenAsync() returns is not missed, set again when nothing was sent.
+static void displaySend() {
+  displayFrameSent = false;
+  if (!tft.updateScreenAsync()) displayFrameSent = true;
+}
+
+//The last frame has to be out before the buffers swap
+static void displayUpdate() {
+  displayYieldUntil(displayDmaIdle);
+  displaySend();
 }
 
 void displayThread() {
   threads.delay(2000);  //Give bootup page chance to display
   while (1) {
-    switch (state) {
+    displayYieldUntil(displayQueueReady);
+    __disable_irq();
+    DisplayRequest &request = displayQueue[displayQueueTail];
+    unsigned int page = request.page;
+    currentParameter = request.parameter;
+    currentValue = request.value;
+    displayQueueTail = (displayQueueTail + 1) % DISPLAY_QUEUE_SIZE;
+    __enable_irq();
+
+    if (page != PARAMETER && page != RECALL && page != SAVE && page != DELETE) tftPage = TFT_PAGE_OTHER;
+#ifdef LIST_SCROLL_STATS
+    uint32_t frameStart = ARM_DWT_CYCCNT;
+#endif
+    switch (page) {
       case PARAMETER:
         if ((millis() - timer) > DISPLAYTIMEOUT) {
-          renderCurrentPatchPage();
-        } else {
-          if (pot) {
-          if (currentValue != prevcurrentValue) {
-            renderCurrentParameterPage();
-            prevcurrentValue = currentValue;
-          }
-          }
-          if (!pot) {
-            if (currentParameter != prevcurrentParameter) {
-              renderCurrentParameterPage();
-              prevcurrentParameter = currentParameter;
-            }
+          if (tftPage != TFT_PAGE_PATCH) {
+            renderCurrentPatchPage();
+            tftPage = TFT_PAGE_PATCH;
           }
+        } else if (tftPage == TFT_PAGE_PARAMETER && strcmp(currentParameter.c_str(), tftParameter.c_str()) == 0) {
+          if (strcmp(currentValue.c_str(), tftValue.c_str()) != 0) renderCurrentParameterValue();
+        } else {
+          renderCurrentParameterPage();
         }
         break;
       case RECALL:
@@ -339,9 +470,9 @@ void displayThread() {
         break;
       case REINITIALISE:
         renderReinitialisePage();
-        tft.updateScreen();  //update before delay
+        displayUpdate();  //update before delay
         threads.delay(1000);
-        state = PARAMETER;
+        state = PARAMETER;  //checkDisplayRequests() posts the page
         break;
       case PATCHNAMING:
         renderPatchNamingPage();
@@ -360,19 +491,96 @@ void displayThread() {
         renderSettingsPage();
         break;
     }
-    tft.updateScreen();
+    displayUpdate();
+#ifdef LIST_SCROLL_STATS
+    if (page == RECALL || page == SAVE || page == DELETE) {
+      uint32_t cycles = ARM_DWT_CYCCNT - frameStart;
+      listStatFrames++;
+      listStatCycles += cycles;
+      if (cycles > listStatMax) listStatMax = cycles;
+    }
+#endif
+  }
+}
+
+#ifdef TFT_STATS
+void checkTftStats() {
+  if (millis() - tftStatsTimer > TFT_STATS_INTERVAL) {
+    tftStatsTimer = millis();
+    uint32_t updates = tft.updateCount();
+    uint32_t perUs = F_CPU_ACTUAL / 1000000;
+    Serial.printf("TFT: %lu updates, avg %lu bytes (full frame %lu) %lu uS each\n", updates,
+                  updates ? tft.updateBytes() / updates : 0, (uint32_t)tft.width() * tft.height() * 2 + 11,
+                  updates ? tft.updateCycles() / updates / perUs : 0);
+    tft.resetUpdateStats();
+  }
+}
+#endif
+
+#ifdef GLYPH_BENCH
+//Nothing is sent to the display, the frame buffer is the stand in
+void glyphBench() {
+  void (*pages[])() = { renderCurrentParameterPage, renderCurrentPatchPage, renderSettingsPage };
+  const char *names[] = { "Parameter", "Patch", "Settings" };
+  currentParameter.add("Filter Cutoff");
+  currentValue.add("24000.00 Hz");
+  currentPgmNum = "127";
+  currentPatchName = "Initial Patch";
+  currentSettingsOption = "MIDI In Ch.";
+  currentSettingsValue = "All";
+  uint32_t perUs = F_CPU_ACTUAL / 1000000;
+  for (int p = 0; p < 3; p++) {
+    uint32_t cycles[2];
+    for (int cached = 0; cached < 2; cached++) {
+      tft.useGlyphCache(cached);
+      pages[p]();  //Builds the spans on the cached pass
+      uint32_t start = ARM_DWT_CYCCNT;
+      for (int i = 0; i < GLYPH_BENCH_RUNS; i++) pages[p]();
+      cycles[cached] = (ARM_DWT_CYCCNT - start) / GLYPH_BENCH_RUNS;
+    }
+    Serial.printf("Glyph bench %s page: %lu uS per render, %lu uS with the glyph cache\n",
+                  names[p], cycles[0] / perUs, cycles[1] / perUs);
+  }
+  Serial.printf("Glyph cache: %lu bytes used\n", tft.glyphCacheBytes());
+  tft.useGlyphCache(true);
+  currentParameter.clear();
+  currentValue.clear();
+  currentPgmNum = "";
+  currentPatchName = "";
+  currentSettingsOption = "";
+  currentSettingsValue = "";
+  tftPage = TFT_PAGE_OTHER;
+}
+#endif
+
+#ifdef LIST_SCROLL_STATS
+void checkListScrollStats() {
+  if (millis() - listStatTimer > TFT_STATS_INTERVAL) {
+    listStatTimer = millis();
+    uint32_t perUs = F_CPU_ACTUAL / 1000000;
+    Serial.printf("Patch list: %lu frames, avg %lu max %lu uS per frame, %lu rows redrawn\n", listStatFrames,
+                  listStatFrames ? listStatCycles / listStatFrames / perUs : 0, listStatMax / perUs, listStatRows);
+    listStatFrames = listStatRows = listStatCycles = listStatMax = 0;
   }
 }
+#endif
 
 void setupDisplay() {
   tft.useFrameBuffer(true);
+  tft.useDoubleBuffer(true);
+  tft.onUpdateComplete(displayUpdateDone);
   tft.initR(INITR_BLACKTAB);
   tft.setRotation(3);
   tft.invertDisplay(false);
 
   LCD.PCF8574_LCDInit(LCD.LCDCursorTypeOff);
   LCD.PCF8574_LCDClearScreen();
+  lcdResetGlass();
 
+#ifdef GLYPH_BENCH
+  glyphBench();
+#endif
   renderBootUpPage();
+  displaySend();
   threads.addThread(displayThread);
 }
@@ -23,6 +23,8 @@
 #include <SPI.h>
 
 #ifdef ENABLE_ST77XX_FRAMEBUFFER
+#include "GlyphSpans.h"
+
 //#define DEBUG_ASYNC_UPDATE
 //#define DEBUG_ASYNC_LEDS
 #ifdef DEBUG_ASYNC_LEDS
@@ -33,6 +35,9 @@
 
 volatile short _dma_dummy_rx;
 
+// CASET, RASET and RAMWR with their data, sent ahead of every update
+#define ST77XX_WINDOW_BYTES 11
+
 ST7735_t3 *ST7735_t3::_dmaActiveDisplay[3] = {0, 0, 0};
 
 #if defined(__IMXRT1062__)  // Teensy 4.x
@@ -52,7 +57,14 @@ ST7735_t3::ST7735_t3(uint8_t cs, uint8_t rs, uint8_t sid, uint8_t sclk, uint8_t
     _pfbtft = NULL; 
     _use_fbtft = 0;           // Are we in frame buffer mode?
   _we_allocated_buffer = NULL;
+  _we_allocated_buffer2 = NULL;
+  _pfbtft_other = NULL;
+  _pfbtft_dma = NULL;
+  _update_callback = NULL;
   _dma_state = 0;
+  clearDirty();
+  _update_count = _update_bytes = _update_cycles = 0;
+  _use_glyph_cache = 1;
     #endif
   _screenHeight = ST7735_TFTHEIGHT_160;
   _screenWidth = ST7735_TFTWIDTH; 
@@ -526,7 +538,7 @@ void ST7735_t3::drawPixel(int16_t x, int16_t y, uint16_t color)
   #ifdef ENABLE_ST77XX_FRAMEBUFFER
   if (_use_fbtft) {
     _pfbtft[y*_width + x] = color;
-
+    markDirty(x, y, 1, 1);
   } else 
   #endif
   {
@@ -546,6 +558,7 @@ void ST7735_t3::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
   if ((y+h-1) >= _height) h = _height-y;
   #ifdef ENABLE_ST77XX_FRAMEBUFFER
   if (_use_fbtft) {
+    markDirty(x, y, 1, h);
     uint16_t * pfbPixel = &_pfbtft[ y*_width + x];
     while (h--) {
       *pfbPixel = color;
@@ -574,6 +587,7 @@ void ST7735_t3::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
 
   #ifdef ENABLE_ST77XX_FRAMEBUFFER
   if (_use_fbtft) {
+    markDirty(x, y, w, 1);
     if ((x&1) || (w&1)) {
       uint16_t * pfbPixel = &_pfbtft[ y*_width + x];
       while (w--) {
@@ -620,6 +634,7 @@ void ST7735_t3::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t co
   if ((y + h - 1) >= _height) h = _height - y;
   #ifdef ENABLE_ST77XX_FRAMEBUFFER
   if (_use_fbtft) {
+    markDirty(x, y, w, h);
     if ((x&1) || (w&1)) {
       uint16_t * pfbPixel_row = &_pfbtft[ y*_width + x];
       for (;h>0; h--) {
@@ -721,6 +736,11 @@ void ST7735_t3::setRotation(uint8_t m)
     break;
   }
   _rot = rotation;  // remember the rotation... 
+  #ifdef ENABLE_ST77XX_FRAMEBUFFER
+  // Old dirty area is in the old orientation, send everything next time
+  clearDirty();
+  markAllDirty();
+  #endif
   //Serial.printf("SetRotation(%d) _xstart=%d _ystart=%d _width=%d, _height=%d\n", _rot, _xstart, _ystart, _width, _height);
   endSPITransaction();
 }
@@ -762,6 +782,18 @@ void ST7735_t3::sendCommand(uint8_t commandByte, const uint8_t *dataBytes, uint8
 
 void ST7735_t3::writeRect(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pcolors)
 {
+  #ifdef ENABLE_ST77XX_FRAMEBUFFER
+  if (_use_fbtft) {
+    markDirty(x, y, w, h);
+    for (int16_t row = 0; row < h; row++, pcolors += w) {
+      if ((y + row < 0) || (y + row >= _height)) continue;
+      for (int16_t col = 0; col < w; col++) {
+        if ((x + col >= 0) && (x + col < _width)) _pfbtft[(y + row)*_width + x + col] = pcolors[col];
+      }
+    }
+    return;
+  }
+  #endif
   beginSPITransaction();
   setAddr(x, y, x + w - 1, y + h - 1);
   writecommand(ST7735_RAMWR);
@@ -810,7 +842,7 @@ void ST7735_t3::process_dma_interrupt(void) {
   #if defined(DEBUG_ASYNC_UPDATE)
   Serial.print(".");
   #endif
-  if (_dma_sub_frame_count == _dma_cnt_sub_frames_per_frame) {
+  if (_dma_sub_frame_count == _dma_cnt_sub_frames_update) {
   #ifdef DEBUG_ASYNC_LEDS
     digitalWriteFast(DEBUG_PIN_3, HIGH);
   #endif
@@ -852,6 +884,8 @@ void ST7735_t3::process_dma_interrupt(void) {
       endSPITransaction();
       _dma_state &= ~(ST77XX_DMA_ACTIVE | ST77XX_DMA_FINISH);
       _dmaActiveDisplay[_spi_num] = 0;  // We don't have a display active any more... 
+      _update_cycles += ARM_DWT_CYCCNT - _update_start_cycles;
+      if (_update_callback) _update_callback();
 
       // Serial.println("After End transaction");
       #if defined(DEBUG_ASYNC_UPDATE)
@@ -866,7 +900,7 @@ void ST7735_t3::process_dma_interrupt(void) {
 
   if (still_more_dma) {
     // we are still in a sub-frame so we need to copy memory down...
-    if (_dma_sub_frame_count == (_dma_cnt_sub_frames_per_frame-2)) {
+    if (_dma_sub_frame_count == (_dma_cnt_sub_frames_update-2)) {
       if ((_dma_state & ST77XX_DMA_CONT) == 0) {
         if (_dma_sub_frame_count & 1) _dma_data[_spi_num]._dmasettings[0].disableOnCompletion();
         else _dma_data[_spi_num]._dmasettings[1].disableOnCompletion();
@@ -878,9 +912,9 @@ void ST7735_t3::process_dma_interrupt(void) {
       }
     }
     if (_dma_sub_frame_count & 1) {
-      memcpy(_dma_data[_spi_num]._dma_buffer1, &_pfbtft[_dma_pixel_index], _dma_buffer_size*2);
+      memcpy(_dma_data[_spi_num]._dma_buffer1, &_pfbtft_dma[_dma_pixel_index], _dma_buffer_size*2);
     } else {      
-      memcpy(_dma_data[_spi_num]._dma_buffer2, &_pfbtft[_dma_pixel_index], _dma_buffer_size*2);
+      memcpy(_dma_data[_spi_num]._dma_buffer2, &_pfbtft_dma[_dma_pixel_index], _dma_buffer_size*2);
     }
     _dma_pixel_index += _dma_buffer_size;
     if (_dma_pixel_index >= (_count_pixels))
@@ -921,14 +955,96 @@ uint8_t ST7735_t3::useFrameBuffer(boolean b)    // use the frame buffer?  First
       memset(_pfbtft, 0, _count_pixels*2);  
     }
     _use_fbtft = 1;
+    markAllDirty();
   } else 
     _use_fbtft = 0;
 
   return _use_fbtft;  
 }
 
+uint32_t ST7735_t3::glyphCacheBytes(void)
+{
+  return _glyph_bytes;
+}
+
+// Same cursor, wrap and newline handling as Adafruit_GFX::write() for custom
+// fonts at text size 1, everything else goes through Adafruit_GFX
+size_t ST7735_t3::write(uint8_t c)
+{
+  if (!_use_fbtft || !_use_glyph_cache || !gfxFont || (textsize_x != 1) || (textsize_y != 1)) {
+    return Adafruit_GFX::write(c);
+  }
+  if (c == '\n') {
+    cursor_x = 0;
+    cursor_y += gfxFont->yAdvance;
+  } else if (c != '\r') {
+    if ((c < gfxFont->first) || (c > gfxFont->last)) return 1;
+    const GFXglyph *glyph = &gfxFont->glyph[c - gfxFont->first];
+    if ((glyph->width > 0) && (glyph->height > 0)) {
+      if (wrap && ((cursor_x + glyph->xOffset + glyph->width) > _width)) {
+        cursor_x = 0;
+        cursor_y += gfxFont->yAdvance;
+      }
+      const uint8_t *record = glyphSpans(gfxFont, c);
+      if (!record) {
+        // No room in the cache, draw it the slow way
+        drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, 1);
+      } else {
+        uint16_t count = *(const uint16_t *)record;
+        const ST77XX_GlyphSpan *span = (const ST77XX_GlyphSpan *)(record + 2);
+        int16_t gx = cursor_x + glyph->xOffset;
+        int16_t gy = cursor_y + glyph->yOffset;
+        markDirty(gx, gy, glyph->width, glyph->height);
+        for (; count; count--, span++) {
+          int16_t y = gy + span->dy;
+          if ((y < 0) || (y >= _height)) continue;
+          int16_t x = gx + span->dx;
+          int16_t x_end = x + span->len;
+          if (x < 0) x = 0;
+          if (x_end > _width) x_end = _width;
+          uint16_t *pfbPixel = &_pfbtft[y*_width + x];
+          for (; x < x_end; x++) {
+            *pfbPixel++ = textcolor;
+          }
+        }
+      }
+    }
+    cursor_x += glyph->xAdvance;
+  }
+  return 1;
+}
+
+uint8_t ST7735_t3::useDoubleBuffer(boolean b)
+{
+  if (b) {
+    if (!_use_fbtft && !useFrameBuffer(true)) return 0;
+    if (_we_allocated_buffer2 == NULL) {
+      _count_pixels = _width * _height;
+      _we_allocated_buffer2 = (uint16_t *)malloc(_count_pixels*2+32);
+      if (_we_allocated_buffer2 == NULL)
+        return 0; // failed 
+      _pfbtft_other = (uint16_t*) (((uintptr_t)_we_allocated_buffer2 + 32) & ~ ((uintptr_t) (31)));
+      // Both buffers always hold the same picture after an update
+      memcpy(_pfbtft_other, _pfbtft, _count_pixels*2);
+    }
+    return 1;
+  }
+  waitUpdateAsyncComplete();
+  if (_we_allocated_buffer2) {
+    // Drawing may have swapped into the second buffer, move back to the first
+    if (_pfbtft == (uint16_t*) (((uintptr_t)_we_allocated_buffer2 + 32) & ~ ((uintptr_t) (31)))) {
+      _pfbtft = _pfbtft_other;
+    }
+    free(_we_allocated_buffer2);
+    _we_allocated_buffer2 = NULL;
+  }
+  _pfbtft_other = NULL;
+  return 0;
+}
+
 void ST7735_t3::freeFrameBuffer(void)           // explicit call to release the buffer
 {
+  useDoubleBuffer(false);
   if (_we_allocated_buffer) {
     free(_we_allocated_buffer);
     _pfbtft = NULL;
@@ -940,24 +1056,40 @@ void ST7735_t3::updateScreen(void)          // call to say update the screen now
 {
   // Not sure if better here to check flag or check existence of buffer.
   // Will go by buffer as maybe can do interesting things?
-  if (_use_fbtft) {
+  if (_use_fbtft && isDirty()) {
+    uint32_t start = ARM_DWT_CYCCNT;
+    int16_t x0 = _dirty_x0, y0 = _dirty_y0, x1 = _dirty_x1, y1 = _dirty_y1;
+    clearDirty();
     beginSPITransaction();
-    // Doing full window. 
-    setAddr(0, 0, _width-1, _height-1);
+    // Only the dirty rectangle
+    setAddr(x0, y0, x1, y1);
     writecommand(ST7735_RAMWR);
 
-    // BUGBUG doing as one shot.  Not sure if should or not or do like
-    // main code and break up into transactions...
-    uint16_t *pfbtft_end = &_pfbtft[(_count_pixels)-1]; // setup 
-    uint16_t *pftbft = _pfbtft;
+    uint16_t *pfbRow = &_pfbtft[y0*_width + x0];
+    uint16_t *pfbtft_end = &_pfbtft[y1*_width + x1];
+    uint16_t w = x1 - x0 + 1;
 
-    // Quick write out the data;
-    while (pftbft < pfbtft_end) {
-      writedata16(*pftbft++);
+    // Quick write out the data, row by row
+    while (pfbRow < pfbtft_end) {
+      uint16_t *pftbft = pfbRow;
+      uint16_t *pfbRow_end = (pfbRow + w < pfbtft_end) ? pfbRow + w : pfbtft_end;
+      while (pftbft < pfbRow_end) {
+        writedata16(*pftbft++);
+      }
+      pfbRow += _width;
     }
-    writedata16_last(*pftbft);
+    writedata16_last(*pfbtft_end);
 
     endSPITransaction();
+    if (_pfbtft_other) {
+      // Keep the other buffer the same, async updates swap to it
+      for (int16_t y = y0; y <= y1; y++) {
+        memcpy(&_pfbtft_other[y*_width + x0], &_pfbtft[y*_width + x0], w*2);
+      }
+    }
+    _update_count++;
+    _update_bytes += ST77XX_WINDOW_BYTES + (uint32_t)w*(y1 - y0 + 1)*2;
+    _update_cycles += ARM_DWT_CYCCNT - start;
   }
 }      
 
@@ -1060,14 +1192,48 @@ bool ST7735_t3::updateScreenAsync(bool update_cont)         // call to say updat
   // Init DMA settings. 
   initDMASettings();
 
-  // Don't start one if already active.
-  if (_dma_state & ST77XX_DMA_ACTIVE) {
+  // Don't start one if already active, or if there is nothing to send.
+  if ((_dma_state & ST77XX_DMA_ACTIVE) || (!update_cont && !isDirty())) {
   #ifdef DEBUG_ASYNC_LEDS
     digitalWriteFast(DEBUG_PIN_1, LOW);
   #endif
     return false;
   }
 
+  // The sub frames are fixed size chunks of the frame buffer, so send the
+  // full width band of rows holding the dirty rectangle, rounded out to where
+  // a row start and a sub frame start line up. Continuous mode sends it all.
+  uint16_t band_y0 = 0;
+  uint16_t band_y1 = _height-1;
+  _dma_cnt_sub_frames_update = _dma_cnt_sub_frames_per_frame;
+  if (!update_cont) {
+    uint16_t band_rows = 1;   // lcm(width, buffer) / width
+    while (((uint32_t)band_rows * _width) % _dma_buffer_size) band_rows++;
+    band_y0 = (_dirty_y0 / band_rows) * band_rows;
+    band_y1 = ((_dirty_y1 / band_rows) + 1) * band_rows - 1;
+    if (band_y1 >= _height) band_y1 = _height-1;
+    uint16_t sub_frames = ((band_y1 - band_y0 + 1) * _width) / _dma_buffer_size;
+    if (sub_frames >= 3) {  // the ISR needs at least three to stop cleanly
+      _dma_cnt_sub_frames_update = sub_frames;
+    } else {
+      band_y0 = 0;
+      band_y1 = _height-1;
+    }
+  }
+  clearDirty();
+  uint32_t band_pixel_index = band_y0 * _width;
+  // With a second buffer the DMA sends this one and drawing moves to the other,
+  // which gets the band copied in first so both hold the same picture again
+  _pfbtft_dma = _pfbtft;
+  if (_pfbtft_other && !update_cont) {
+    _pfbtft = _pfbtft_other;
+    _pfbtft_other = _pfbtft_dma;
+    memcpy(&_pfbtft[band_pixel_index], &_pfbtft_dma[band_pixel_index], (uint32_t)(band_y1 - band_y0 + 1)*_width*2);
+  }
+  _update_start_cycles = ARM_DWT_CYCCNT;
+  _update_count++;
+  _update_bytes += ST77XX_WINDOW_BYTES + (uint32_t)_dma_cnt_sub_frames_update*_dma_buffer_size*2;
+
 
     // Start off remove disable on completion from both...
   // it will be the ISR that disables it... 
@@ -1078,14 +1244,14 @@ bool ST7735_t3::updateScreenAsync(bool update_cont)         // call to say updat
   dumpDMASettings();
 #endif
   // Lets copy first parts of frame buffer into our two sub-frames
-  memcpy(_dma_data[_spi_num]._dma_buffer1, _pfbtft, _dma_buffer_size*2);
-  memcpy(_dma_data[_spi_num]._dma_buffer2, &_pfbtft[_dma_buffer_size], _dma_buffer_size*2);
-  _dma_pixel_index = _dma_buffer_size*2;
+  memcpy(_dma_data[_spi_num]._dma_buffer1, &_pfbtft_dma[band_pixel_index], _dma_buffer_size*2);
+  memcpy(_dma_data[_spi_num]._dma_buffer2, &_pfbtft_dma[band_pixel_index + _dma_buffer_size], _dma_buffer_size*2);
+  _dma_pixel_index = band_pixel_index + _dma_buffer_size*2;
   _dma_sub_frame_count = 0; // 
 
   beginSPITransaction();
-  // Doing full window. 
-  setAddr(0, 0, _width-1, _height-1);
+  // Doing the band window. 
+  setAddr(0, band_y0, _width-1, band_y1);
   writecommand_last(ST7735_RAMWR);
 
   // Update TCR to 16 bit mode. and output the first entry.
@@ -205,7 +205,9 @@ class ST7735_t3 : public Adafruit_GFX {
   // added support to use optional Frame buffer
   void  setFrameBuffer(uint16_t *frame_buffer);
   uint8_t useFrameBuffer(boolean b);    // use the frame buffer?  First call will allocate
+  uint8_t useDoubleBuffer(boolean b);   // second buffer, drawing goes on while the DMA sends the other
   void  freeFrameBuffer(void);      // explicit call to release the buffer
+  void  onUpdateComplete(void (*callback)(void)) {_update_callback = callback;}  // called from the DMA interrupt
   void  updateScreen(void);       // call to say update the screen now. 
   bool  updateScreenAsync(bool update_cont = false);  // call to say update the screen optinoally turn into continuous mode. 
   void  waitUpdateAsyncComplete(void);
@@ -215,10 +217,38 @@ class ST7735_t3 : public Adafruit_GFX {
   uint32_t frameCount() {return _dma_frame_count; }
   boolean asyncUpdateActive(void)  {return (_dma_state & ST77XX_DMA_ACTIVE);}
   void  initDMASettings(void);
+
+  // Dirty rectangle tracking, the updates only send what was drawn since the last one
+  void  markDirty(int16_t x, int16_t y, int16_t w, int16_t h) __attribute__((always_inline)) {
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > _width) w = _width - x;
+    if (y + h > _height) h = _height - y;
+    if ((w <= 0) || (h <= 0)) return;
+    if (x < _dirty_x0) _dirty_x0 = x;
+    if (y < _dirty_y0) _dirty_y0 = y;
+    if (x + w - 1 > _dirty_x1) _dirty_x1 = x + w - 1;
+    if (y + h - 1 > _dirty_y1) _dirty_y1 = y + h - 1;
+  }
+  void  markAllDirty(void) {markDirty(0, 0, _width, _height);}
+  boolean isDirty(void) {return _dirty_x0 <= _dirty_x1;}
+  // Totals since resetUpdateStats(), bytes include the address window commands
+  uint32_t updateCount(void) {return _update_count;}
+  uint32_t updateBytes(void) {return _update_bytes;}
+  uint32_t updateCycles(void) {return _update_cycles;}
+  void  resetUpdateStats(void) {_update_count = _update_bytes = _update_cycles = 0;}
+
+  // Custom font text goes through a glyph span cache straight into the frame buffer
+  virtual size_t write(uint8_t c);
+  using Adafruit_GFX::write;
+  void  useGlyphCache(boolean b) {_use_glyph_cache = b;}
+  uint32_t glyphCacheBytes(void);  // heap bytes of the fonts in the glyph cache
   #else
   // added support to use optional Frame buffer
   void  setFrameBuffer(uint16_t *frame_buffer) {return;}
   uint8_t useFrameBuffer(boolean b) {return 0;};    // use the frame buffer?  First call will allocate
+  uint8_t useDoubleBuffer(boolean b) {return 0;};
+  void  onUpdateComplete(void (*callback)(void)) {return;}
   void  freeFrameBuffer(void) {return;}      // explicit call to release the buffer
   void  updateScreen(void) {return;}       // call to say update the screen now. 
   bool  updateScreenAsync(bool update_cont = false) {return false;}  // call to say update the screen optinoally turn into continuous mode. 
@@ -229,6 +259,15 @@ class ST7735_t3 : public Adafruit_GFX {
   uint32_t frameCount() {return 0; }
   uint16_t *getFrameBuffer() {return NULL;}
   boolean asyncUpdateActive(void)  {return false;}
+  void  markDirty(int16_t x, int16_t y, int16_t w, int16_t h) {return;}
+  void  markAllDirty(void) {return;}
+  boolean isDirty(void) {return false;}
+  uint32_t updateCount(void) {return 0;}
+  uint32_t updateBytes(void) {return 0;}
+  uint32_t updateCycles(void) {return 0;}
+  void  resetUpdateStats(void) {return;}
+  void  useGlyphCache(boolean b) {return;}
+  uint32_t glyphCacheBytes(void) {return 0;}
   #endif
 
 
@@ -371,7 +410,17 @@ class ST7735_t3 : public Adafruit_GFX {
   uint16_t  *_pfbtft;           // Optional Frame buffer 
   uint8_t   _use_fbtft;         // Are we in frame buffer mode?
   uint16_t  *_we_allocated_buffer;      // We allocated the buffer; 
+  uint16_t  *_we_allocated_buffer2;     // and the second one for double buffering
+  uint16_t  *_pfbtft_other;     // Double buffering, the buffer not being drawn in
+  uint16_t  *_pfbtft_dma;       // The buffer the DMA is sending from
+  void      (*_update_callback)(void);
   uint32_t  _count_pixels;       // How big is the display in total pixels...
+  int16_t   _dirty_x0, _dirty_y0, _dirty_x1, _dirty_y1;  // x1 < x0 when clean
+  uint32_t  _update_count, _update_bytes;
+  volatile uint32_t _update_cycles;
+  uint32_t  _update_start_cycles;
+  uint8_t   _use_glyph_cache;
+  void clearDirty(void) {_dirty_x0 = _dirty_y0 = 0x7fff; _dirty_x1 = _dirty_y1 = -1;}
 
   // Add DMA support. 
   // Note: We have enough memory to have more than one, so could have multiple active devices (one per SPI BUS)
@@ -393,6 +442,7 @@ class ST7735_t3 : public Adafruit_GFX {
   volatile uint16_t _dma_sub_frame_count = 0; // Can return a frame count...
   uint16_t          _dma_buffer_size;   // the actual size we are using <= DMA_BUFFER_SIZE;
   uint16_t          _dma_cnt_sub_frames_per_frame;  
+  uint16_t          _dma_cnt_sub_frames_update;  // Sub frames in the band being sent
   uint32_t      _spi_fcr_save;    // save away previous FCR register value
 
   #elif defined(__MK64FX512__)
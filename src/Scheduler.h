@@ -0,0 +1,130 @@
+// Cooperative rate monotonic scheduler for loop()
+//
+// Each task has a period, a priority (0 is highest) and a deadline, by default
+// the period. schedulerRun() runs every task that is due, highest priority
+// first, and after each one goes back to the top of the list, so a slow LCD
+// write only holds up the tasks below it. Tasks added with SCHED_EVERY_PASS
+// (MIDI input) are polled again after every periodic task, their deadline is
+// the longest allowed gap between two polls.
+//
+// A periodic task that starts more than its deadline after its release counts
+// a miss. When it has fallen a whole period behind the missed releases are
+// dropped rather than run back to back.
+
+#define SCHED_MAX_TASKS 10
+#define SCHED_EVERY_PASS 0
+
+//Task periods for the scheduler, MIDI input is polled on every pass
+#define MIDI_IN_DEADLINE_US 1000  //Longest gap between two MIDI input polls
+#define POTS_PERIOD_US 500        //2kHz, one mux address per run
+#define CONTROLS_PERIOD_US 1000
+#define LEDS_PERIOD_US 5000       //200Hz
+#define DISPLAY_PERIOD_US 33333   //30Hz
+#define LCD_PERIOD_US 1000
+#define TIMEOUTS_PERIOD_US 100000  //10Hz
+
+//Uncomment to print runs, deadline misses, worst lateness and run time per task
+//#define SCHED_STATS
+#define SCHED_STATS_INTERVAL 10000
+
+typedef void (*SchedTaskFn)();
+
+struct SchedTask {
+  const char *name;
+  SchedTaskFn run;
+  uint32_t periodUs;
+  uint32_t deadlineUs;
+  uint8_t priority;
+  uint32_t release;  //micros() of the next release, of the last poll for every pass tasks
+  uint32_t pass;     //schedulerRun() pass it last ran in, periodic tasks run once per pass
+  uint32_t runs;
+  uint32_t misses;
+#ifdef SCHED_STATS
+  uint32_t maxLateUs;
+  uint32_t maxRunCycles;
+#endif
+};
+
+static SchedTask schedTasks[SCHED_MAX_TASKS];
+static uint8_t schedTaskCount = 0;
+static uint32_t schedPass = 0;
+
+#ifdef SCHED_STATS
+static unsigned long schedStatsTimer = 0;
+#endif
+
+//Kept sorted by priority, equal priorities run in the order they were added
+bool schedulerAdd(const char *name, SchedTaskFn run, uint32_t periodUs, uint8_t priority, uint32_t deadlineUs = 0) {
+  if (schedTaskCount >= SCHED_MAX_TASKS) return false;
+  int i = schedTaskCount++;
+  while (i > 0 && schedTasks[i - 1].priority > priority) {
+    schedTasks[i] = schedTasks[i - 1];
+    i--;
+  }
+  schedTasks[i] = SchedTask();
+  schedTasks[i].name = name;
+  schedTasks[i].run = run;
+  schedTasks[i].periodUs = periodUs;
+  schedTasks[i].deadlineUs = deadlineUs ? deadlineUs : periodUs;
+  schedTasks[i].priority = priority;
+  schedTasks[i].release = micros();
+  return true;
+}
+
+static void schedRunTask(SchedTask &t, uint32_t now) {
+  uint32_t late = now - t.release;
+  if (t.deadlineUs && late > t.deadlineUs) t.misses++;
+#ifdef SCHED_STATS
+  if (late > t.maxLateUs) t.maxLateUs = late;
+  uint32_t start = ARM_DWT_CYCCNT;
+#endif
+  if (t.periodUs == SCHED_EVERY_PASS) {
+    t.release = now;
+  } else {
+    t.release += t.periodUs;
+    if ((int32_t)(now - t.release) >= 0) t.release = now + t.periodUs;  //A period behind, drop the missed releases
+    t.pass = schedPass;
+  }
+  t.run();
+  t.runs++;
+#ifdef SCHED_STATS
+  uint32_t cycles = ARM_DWT_CYCCNT - start;
+  if (cycles > t.maxRunCycles) t.maxRunCycles = cycles;
+#endif
+}
+
+static void schedRunEveryPass() {
+  for (int i = 0; i < schedTaskCount; i++) {
+    if (schedTasks[i].periodUs == SCHED_EVERY_PASS) schedRunTask(schedTasks[i], micros());
+  }
+}
+
+//Called once per loop() pass
+void schedulerRun() {
+  schedPass++;
+  schedRunEveryPass();
+  for (int i = 0; i < schedTaskCount; i++) {
+    SchedTask &t = schedTasks[i];
+    if (t.periodUs == SCHED_EVERY_PASS || t.pass == schedPass) continue;
+    uint32_t now = micros();
+    if ((int32_t)(now - t.release) < 0) continue;
+    schedRunTask(t, now);
+    schedRunEveryPass();
+    i = -1;  //Anything of higher priority that became due goes first
+  }
+}
+
+#ifdef SCHED_STATS
+void checkSchedulerStats() {
+  if (millis() - schedStatsTimer > SCHED_STATS_INTERVAL) {
+    schedStatsTimer = millis();
+    uint32_t perUs = F_CPU_ACTUAL / 1000000;
+    Serial.println("Scheduler: task runs misses | max late uS | max run uS");
+    for (int i = 0; i < schedTaskCount; i++) {
+      SchedTask &t = schedTasks[i];
+      Serial.printf("%-9s %8lu %6lu | %8lu | %8lu\n", t.name, t.runs, t.misses, t.maxLateUs, t.maxRunCycles / perUs);
+      t.runs = t.misses = t.maxLateUs = t.maxRunCycles = 0;
+    }
+  }
+}
+#endif
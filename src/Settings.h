@@ -3,14 +3,12 @@
 void settingsMIDICh();
 void settingsMIDIOutCh();
 void settingsEncoderDir();
-void settingsUpdateParams();
-void settingsSendNotes();
+void settingsEchoWindow();
 
 int currentIndexMIDICh();
 int currentIndexMIDIOutCh();
 int currentIndexEncoderDir();
-int currentIndexUpdateParams();
-int currentIndexSendNotes();
+int currentIndexEchoWindow();
 
 void settingsMIDICh(int index, const char *value) {
   if (strcmp(value, "ALL") == 0) {
@@ -39,22 +37,15 @@ void settingsEncoderDir(int index, const char *value) {
   storeEncoderDir(encCW ? 1 : 0);
 }
 
-void settingsUpdateParams(int index, const char *value) {
-  if (strcmp(value, "Send Params") == 0) {
-    updateParams = true;
-  } else {
-    updateParams =  false;
-  }
-  storeUpdateParams(updateParams ? 1 : 0);
+//Route values are in destination mask order, "Off", "DIN", "USB", "DIN+USB"
+template<uint8_t source, uint8_t messageClass> void settingsRoute(int index, const char *value) {
+  setMidiRoute(source, messageClass, index);
+  storeMidiRoutes(midiRoutes);
 }
 
-void settingsSendNotes(int index, const char *value) {
-  if (strcmp(value, "Send Notes") == 0) {
-    sendNotes = true;
-  } else {
-    sendNotes =  false;
-  }
-  storeSendNotes(sendNotes ? 1 : 0);
+void settingsEchoWindow(int index, const char *value) {
+  routeEchoWindow = index;
+  storeEchoWindow(routeEchoWindow);
 }
 
 int currentIndexMIDICh() {
@@ -69,12 +60,12 @@ int currentIndexEncoderDir() {
   return getEncoderDir() ? 0 : 1;
 }
 
-int currentIndexUpdateParams() {
-  return getUpdateParams() ? 1 : 0;
+template<uint8_t source, uint8_t messageClass> int currentIndexRoute() {
+  return midiRoute(source, messageClass);
 }
 
-int currentIndexSendNotes() {
-  return getSendNotes() ? 1 : 0;
+int currentIndexEchoWindow() {
+  return getEchoWindow();
 }
 
 
@@ -83,6 +74,13 @@ void setUpSettings() {
   settings::append(settings::SettingsOption{"MIDI Ch.", {"All", "1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11", "12", "13", "14", "15", "16", "\0"}, settingsMIDICh, currentIndexMIDICh});
   settings::append(settings::SettingsOption{"MIDI Out Ch.", {"Off", "1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11", "12", "13", "14", "15", "16", "\0"}, settingsMIDIOutCh, currentIndexMIDIOutCh});
   settings::append(settings::SettingsOption{"Encoder", {"Type 1", "Type 2", "\0"}, settingsEncoderDir, currentIndexEncoderDir});
-  settings::append(settings::SettingsOption{"USB Params", {"Off", "Send Params", "\0"}, settingsUpdateParams, currentIndexUpdateParams});
-  settings::append(settings::SettingsOption{"USB Notes", {"Off", "Send Notes", "\0"}, settingsSendNotes, currentIndexSendNotes});
+  settings::append(settings::SettingsOption{"Panel CCs", {"Off", "DIN", "USB", "DIN+USB", "\0"}, settingsRoute<ROUTE_PANEL, ROUTE_CCS>, currentIndexRoute<ROUTE_PANEL, ROUTE_CCS>});
+  settings::append(settings::SettingsOption{"DIN In Notes", {"Off", "DIN", "USB", "DIN+USB", "\0"}, settingsRoute<MIDI_PORT_DIN, ROUTE_NOTES>, currentIndexRoute<MIDI_PORT_DIN, ROUTE_NOTES>});
+  settings::append(settings::SettingsOption{"DIN In CCs", {"Off", "DIN", "USB", "DIN+USB", "\0"}, settingsRoute<MIDI_PORT_DIN, ROUTE_CCS>, currentIndexRoute<MIDI_PORT_DIN, ROUTE_CCS>});
+  settings::append(settings::SettingsOption{"USB In Notes", {"Off", "DIN", "USB", "DIN+USB", "\0"}, settingsRoute<MIDI_PORT_USB_DEVICE, ROUTE_NOTES>, currentIndexRoute<MIDI_PORT_USB_DEVICE, ROUTE_NOTES>});
+  settings::append(settings::SettingsOption{"USB In CCs", {"Off", "DIN", "USB", "DIN+USB", "\0"}, settingsRoute<MIDI_PORT_USB_DEVICE, ROUTE_CCS>, currentIndexRoute<MIDI_PORT_USB_DEVICE, ROUTE_CCS>});
+  settings::append(settings::SettingsOption{"Host In Notes", {"Off", "DIN", "USB", "DIN+USB", "\0"}, settingsRoute<MIDI_PORT_USB_HOST, ROUTE_NOTES>, currentIndexRoute<MIDI_PORT_USB_HOST, ROUTE_NOTES>});
+  settings::append(settings::SettingsOption{"Host In CCs", {"Off", "DIN", "USB", "DIN+USB", "\0"}, settingsRoute<MIDI_PORT_USB_HOST, ROUTE_CCS>, currentIndexRoute<MIDI_PORT_USB_HOST, ROUTE_CCS>});
+  settings::append(settings::SettingsOption{"Echo Filter", {"Off", "10mS", "30mS", "100mS", "\0"}, settingsEchoWindow, currentIndexEchoWindow});
+  settings::append(settings::SettingsOption{TRAFFIC_SETTING, {trafficPageText[0], trafficPageText[1], trafficPageText[2], trafficPageText[3], trafficPageText[4], trafficPageText[5], trafficPageText[6], "\0"}, settingsTraffic, currentIndexTraffic});
 }
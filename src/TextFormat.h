@@ -0,0 +1,123 @@
+// Fixed buffer text formatting for the display path
+//
+// Integers and fixed point values to ASCII with zero padding and units,
+// straight into a char array. Nothing here touches the heap, unlike building
+// the same text with String on every pot event.
+//
+//   TextBuffer<8> number;
+//   number.addInt(value, 3);            // "007"
+//   TextBuffer<24> text;
+//   text.addFixed(2.5, 2).add(" Hz");   // "2.50 Hz"
+//   text.addCenti(250).add(" Hz");      // "2.50 Hz", no float at all
+
+//Uncomment to count heap operations, they should stay flat after setup()
+//#define HEAP_STATS
+//With HEAP_STATS, sweep the filter cutoff to exercise the display path
+//#define HEAP_SWEEP_TEST
+#define HEAP_STATS_INTERVAL 10000
+
+template<size_t N>
+class TextBuffer {
+public:
+  TextBuffer() {
+    clear();
+  }
+
+  void clear() {
+    _len = 0;
+    _text[0] = 0;
+  }
+
+  TextBuffer &add(const char *s) {
+    while (*s && _len < N - 1) _text[_len++] = *s++;
+    _text[_len] = 0;
+    return *this;
+  }
+
+  TextBuffer &add(char c) {
+    if (_len < N - 1) _text[_len++] = c;
+    _text[_len] = 0;
+    return *this;
+  }
+
+  //Zero padded to width digits
+  TextBuffer &addInt(long value, uint8_t width = 0) {
+    char digits[12];
+    uint8_t n = 0;
+    unsigned long v = value < 0 ? -(unsigned long)value : value;
+    do {
+      digits[n++] = '0' + v % 10;
+      v /= 10;
+    } while (v && n < sizeof(digits));
+    if (value < 0) add('-');
+    while (width > n) {
+      add('0');
+      width--;
+    }
+    while (n) add(digits[--n]);
+    return *this;
+  }
+
+  //Rounded to a fixed number of decimals, matches String(float, decimals)
+  TextBuffer &addFixed(float value, uint8_t decimals = 2) {
+    long scale = 1;
+    for (uint8_t i = 0; i < decimals; i++) scale *= 10;
+    long scaled = lroundf(value * scale);
+    if (scaled < 0) {
+      add('-');
+      scaled = -scaled;
+    }
+    addInt(scaled / scale);
+    if (decimals) {
+      add('.');
+      addInt(scaled % scale, decimals);
+    }
+    return *this;
+  }
+
+  //Hundredths as a fixed point value, 250 is "2.50"
+  TextBuffer &addCenti(long centi) {
+    if (centi < 0) {
+      add('-');
+      centi = -centi;
+    }
+    addInt(centi / 100);
+    add('.');
+    return addInt(centi % 100, 2);
+  }
+
+  const char *c_str() const {
+    return _text;
+  }
+
+  size_t length() const {
+    return _len;
+  }
+
+private:
+  char _text[N];
+  size_t _len;
+};
+
+#ifdef HEAP_STATS
+//newlib takes the malloc lock for every malloc, realloc and free
+static volatile uint32_t heapOps = 0;
+static uint32_t heapOpsReported = 0;
+static unsigned long heapStatsTimer = 0;
+
+extern "C" void __malloc_lock(struct _reent *) {
+  heapOps++;
+}
+
+extern "C" void __malloc_unlock(struct _reent *) {
+}
+
+void checkHeapStats() {
+  if (millis() - heapStatsTimer > HEAP_STATS_INTERVAL) {
+    heapStatsTimer = millis();
+    uint32_t ops = heapOps;
+    Serial.printf("Heap: %lu operations since boot, %lu in the last 10s\n", ops, ops - heapOpsReported);
+    heapOpsReported = ops;
+  }
+}
+#endif
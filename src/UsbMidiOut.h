@@ -0,0 +1,112 @@
+// Batched USB MIDI output
+//
+// loop() code queues its USB MIDI messages here rather than sending each one.
+// They are handed to the USB stack together and usbMIDI.send_now() sends them
+// as one transaction: at the end of each loop() pass, as soon as USB_MIDI_BATCH
+// messages (a full 64 byte packet) are waiting, or once the oldest has waited
+// USB_MIDI_DEADLINE_US. The MIDI poll interrupt checks the deadline too, so it
+// holds while loop() is blocked, e.g. in the delay()s of the HID sequence after
+// a recall. The passthrough sends its notes straight away with
+// usbMidiSendNow(), latency matters more there than full packets.
+
+#define USB_MIDI_BATCH 16  //4 byte USB MIDI events per 64 byte packet
+#define USB_MIDI_DEADLINE_US 4000
+
+//Uncomment to print USB MIDI messages per transaction, overall and for the last patch recall
+//#define USB_MIDI_STATS
+#define USB_MIDI_STATS_INTERVAL 10000
+
+static volatile uint8_t midiOutBusy = 0;
+
+//loop() code that sends on MIDI or usbMIDI holds one of these while it does,
+//the MIDI poll interrupt does not send while one is held
+struct MidiOutGuard {
+  MidiOutGuard() {
+    midiOutBusy++;
+    __sync_synchronize();  //Nothing guarded is moved ahead of taking the guard
+  }
+  ~MidiOutGuard() {
+    __sync_synchronize();  //Or after releasing it
+    midiOutBusy--;
+  }
+};
+
+struct UsbMidiMessage {
+  uint8_t type;
+  uint8_t data1;
+  uint8_t data2;
+  uint8_t channel;
+};
+
+static UsbMidiMessage usbMidiBatch[USB_MIDI_BATCH];
+static volatile uint8_t usbMidiCount = 0;  //Changed under MidiOutGuard, or by the poll interrupt when none is held
+static volatile uint32_t usbMidiOldest = 0;
+
+#ifdef USB_MIDI_STATS
+static uint32_t usbMidiMessages = 0;
+static uint32_t usbMidiTransactions = 0;
+static volatile uint32_t usbMidiImmediate = 0;  //Passthrough send_now() calls
+static uint32_t usbMidiRecallMessages = 0;
+static uint32_t usbMidiRecallTransactions = 0;
+static unsigned long usbMidiStatsTimer = 0;
+#endif
+
+//For the passthrough, the message has been written with usbMIDI.send*()
+void usbMidiSendNow() {
+  usbMIDI.send_now();
+#ifdef USB_MIDI_STATS
+  usbMidiImmediate++;
+#endif
+}
+
+void usbMidiFlush() {
+  if (!usbMidiCount) return;
+  MidiOutGuard guard;
+  for (int i = 0; i < usbMidiCount; i++) {
+    usbMIDI.send(usbMidiBatch[i].type, usbMidiBatch[i].data1, usbMidiBatch[i].data2, usbMidiBatch[i].channel, 0);
+  }
+  usbMIDI.send_now();
+#ifdef USB_MIDI_STATS
+  usbMidiMessages += usbMidiCount;
+  usbMidiTransactions++;
+#endif
+  usbMidiCount = 0;
+}
+
+//type is the status byte without the channel, 0x80 note off to 0xE0 pitch bend
+void usbMidiQueue(uint8_t type, uint8_t data1, uint8_t data2, uint8_t channel) {
+  MidiOutGuard guard;
+  if (usbMidiCount && micros() - usbMidiOldest > USB_MIDI_DEADLINE_US) usbMidiFlush();
+  if (!usbMidiCount) usbMidiOldest = micros();
+  usbMidiBatch[usbMidiCount++] = { type, data1, data2, channel };
+  midiTrafficMessage(TRAFFIC_USB_OUT, type, data1, data2);
+  if (usbMidiCount == USB_MIDI_BATCH) usbMidiFlush();
+}
+
+//From the MIDI poll interrupt
+void usbMidiPoll() {
+  if (!midiOutBusy && usbMidiCount && micros() - usbMidiOldest > USB_MIDI_DEADLINE_US) usbMidiFlush();
+}
+
+#ifdef USB_MIDI_STATS
+//Around recallPatch(), the counts of the last recall are kept
+void usbMidiRecallMark(bool start) {
+  usbMidiFlush();
+  if (start) {
+    usbMidiRecallMessages = usbMidiMessages;
+    usbMidiRecallTransactions = usbMidiTransactions;
+  } else {
+    usbMidiRecallMessages = usbMidiMessages - usbMidiRecallMessages;
+    usbMidiRecallTransactions = usbMidiTransactions - usbMidiRecallTransactions;
+  }
+}
+
+void checkUsbMidiStats() {
+  if (millis() - usbMidiStatsTimer > USB_MIDI_STATS_INTERVAL) {
+    usbMidiStatsTimer = millis();
+    Serial.printf("USB MIDI: %lu messages in %lu transactions | passthrough %lu | last recall %lu messages in %lu transactions\n",
+                  usbMidiMessages, usbMidiTransactions, usbMidiImmediate, usbMidiRecallMessages, usbMidiRecallTransactions);
+    usbMidiMessages = usbMidiTransactions = usbMidiImmediate = 0;
+  }
+}
+#endif